@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "grid.h"
+#include "searcher.h"
+#include "hierarchy.h"
+#include "landmarks.h"
+
+// runs one search on a worker thread against a snapshot of the grid, so long
+// searches and hierarchy or landmark builds never block the thread handling
+// the input. The cells changed by the search steps are published in batches
+// that the owner picks up at its own pace. Apart from the worker itself, all
+// methods must be called from the thread that owns the object
+class BackgroundSearch
+{
+public:
+    // cells that changed state during a run of search steps
+    struct StepBatch
+    {
+        std::vector<int> opened;
+        std::vector<int> closed;
+        std::vector<int> backward_opened;
+        std::vector<int> backward_closed;
+    };
+
+private:
+    enum { Steps_Per_Batch = 256 };
+
+    // the owner's grid as it was at the last Start
+    Grid snapshot;
+    Hierarchy hierarchy;
+    Landmarks landmarks;
+    Searcher searcher;
+    // grid version the hierarchy was built for, it is kept while the grid is
+    // not edited
+    std::uint64_t hierarchy_version = 0;
+
+    // what Start took from the owner's grid, applied to the snapshot by the
+    // worker so the masks and labels are rebuilt off the input thread. The
+    // whole occupancy and cost layers after a resize, a new grid or many
+    // edits, otherwise the cells of the regions edited since the last Start
+    struct CellEdit
+    {
+        int cell;
+        bool is_blocked;
+        unsigned char cost;
+    };
+    const Grid *source = nullptr;
+    std::uint64_t synced_version = 0;
+    bool is_full_copy = false;
+    int copy_width = 0;
+    int copy_height = 0;
+    std::vector<std::uint64_t> copy_blocked;
+    std::vector<unsigned char> copy_costs; // empty for uniform costs
+    std::vector<CellEdit> edits;
+    int copy_start = -1;
+    int copy_destination = -1;
+
+    std::thread worker;
+    std::atomic<bool> is_cancelled{false};
+    bool is_recording_steps = true;
+
+    std::mutex batches_mutex;
+    std::vector<StepBatch> published; // guarded by batches_mutex
+    bool is_finished = false;         // guarded by batches_mutex
+    bool is_active = false;
+
+    void CopyGrid(const Grid &grid);
+    void ApplyCopy();
+    void Run();
+    void Publish(StepBatch &batch);
+
+public:
+    BackgroundSearch();
+    ~BackgroundSearch();
+
+    // takes the grid's layers and searches from its start to its destination
+    // with the algorithm, open list and policies of `settings`, a running
+    // search is cancelled first. Only the edits since the last Start are
+    // copied, and their masks and labels are rebuilt on the worker. Without
+    // recording only the result is published. False if the start or the
+    // destination is not set
+    bool Start(const Grid &grid, const Searcher &settings, bool is_recording);
+    // hand-placed landmarks of the snapshot, see Landmarks::SetPlacedCells.
+    // A running search is cancelled first
+    void SetPlacedLandmarks(const std::vector<int> &landmark_cells);
+    // waits for the worker and drops everything not taken yet. A hierarchy
+    // or landmark build is not interrupted, the search steps are
+    void Cancel();
+    // from Start until TakeBatches hands over the result
+    bool IsActive() const;
+    // appends the batches published since the last call, returns true once
+    // the search has finished and all of its batches were taken. The result
+    // can be read from then on
+    bool TakeBatches(std::vector<StepBatch> &batches);
+
+    bool PathFound() const;
+    const std::vector<int>& Path() const;
+    int PathCost() const;
+    std::size_t ExpandedCount() const;
+};
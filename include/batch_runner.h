@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <cstddef>
+#include "grid.h"
+#include "searcher.h"
+#include "hierarchy.h"
+
+struct PathQuery
+{
+    int start;
+    int destination;
+};
+
+struct PathResult
+{
+    bool is_valid = false; // start and destination are free cells of the grid
+    bool found = false;
+    int cost = 0;
+    std::size_t path_cells = 0;
+    std::size_t expanded = 0;
+    double microseconds = 0.0;
+};
+
+// answers batches of queries against one grid on a fixed pool of threads.
+// The grid is shared read-only and must not be edited during Run(). Every
+// worker owns a Searcher whose arenas are allocated once and reused for all
+// of its queries. A batch is split into chunks dealt out to per-worker
+// queues, idle workers steal chunks from the back of the others' queues
+class BatchRunner
+{
+private:
+    struct Chunk
+    {
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    struct Worker
+    {
+        std::unique_ptr<Searcher> searcher;
+        std::deque<Chunk> chunks;
+        std::mutex chunks_mutex;
+    };
+
+    const Grid *grid;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    // current batch
+    const PathQuery *queries = nullptr;
+    PathResult *results = nullptr;
+    std::size_t pending_chunks = 0;
+    unsigned long batch_id = 0;
+    bool is_stopping = false;
+
+    std::mutex batch_mutex;
+    std::condition_variable batch_started;
+    std::condition_variable batch_finished;
+
+    void WorkerLoop(std::size_t worker_index);
+    bool TakeChunk(std::size_t worker_index, Chunk &chunk);
+    void RunQuery(Searcher &searcher, std::size_t query_index);
+
+public:
+    // threads_count == 0 uses one thread per hardware thread
+    // the hierarchy is only needed by Hierarchical_A_Star and is shared read-only too
+    BatchRunner(const Grid *searched_grid, unsigned int threads_count = 0,
+                Searcher::Algorithm algorithm = Searcher::A_Star, const Hierarchy *hierarchy = nullptr);
+    ~BatchRunner();
+
+    std::size_t ThreadsCount() const;
+    // shared by all workers, nullptr turns caching off
+    void SetPathCache(PathCache *cache);
+    void SetOpenList(OpenList::Kind kind);
+    void SetHeuristic(SearchPolicy::Heuristic heuristic);
+    void SetNeighbourhood(SearchPolicy::Neighbourhood neighbourhood);
+    // shared read-only like the hierarchy, must be built before Run
+    void SetLandmarks(const Landmarks *landmarks);
+    // blocks until all queries are answered, results must hold `count` elements
+    void Run(const PathQuery *batch_queries, std::size_t count, PathResult *batch_results);
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "grid.h"
+#include "searcher.h"
+#include "background_search.h"
+#include "flow_field.h"
+#include "trace_replay.h"
+#include "camera.h"
+#include "shader_program.h"
+
+// draws the whole board - free, blocked, searched, path, start and destination
+// cells and the grid lines - in a single fullscreen pass. Every cell keeps one
+// byte of state in an integer texture and only the changed cells are uploaded,
+// so the cost of a frame does not depend on how many cells are filled.
+// A second byte texture holds the terrain costs, free cells costing more
+// than 1 are drawn as a heat map scaled to the largest cost of the grid.
+// A third one holds the flow field when it is shown: the direction of every
+// reachable cell, drawn as an arrow, and its distance to the destination,
+// drawn as a gradient over the free cells
+class BoardRenderer
+{
+public:
+    // values of the state texture, the board shader decodes the same values
+    enum CellState : unsigned char
+    {
+        Free_State,
+        // search states, a later one is drawn over an earlier one
+        Opened_State,
+        Closed_State,
+        Backward_Opened_State,
+        Backward_Closed_State,
+        Blocked_State,
+        Start_State,
+        Destination_State,
+        // path cells store their position between start and destination
+        // in [Path_First_State, 255] to draw the gradient
+        Path_First_State,
+        Palette_Size = Path_First_State
+    };
+
+    // a flow texel is 0 for cells that cannot reach the destination,
+    // otherwise 1 + direction + 8 * distance level
+    enum { Flow_Levels = 31 };
+
+private:
+    // changed span of every row waiting for the upload
+    struct DirtyRows
+    {
+        std::vector<int> first_column; // -1 if the row is clean
+        std::vector<int> last_column;
+        std::vector<int> rows;
+        bool is_all = true;
+
+        void Reset(int height);
+        void Mark(int column, int row);
+        void Clear();
+    };
+
+    const Grid *grid;
+    const Searcher *searcher;
+    const Camera *camera;
+    const FlowField *flow_field = nullptr;
+
+    int width = 0;
+    int height = 0;
+    int start = -1;
+    int destination = -1;
+
+    unsigned int board_vao;
+    unsigned int states_texture;
+    unsigned int costs_texture;
+    unsigned int flows_texture;
+
+    std::vector<unsigned char> states;        // what is drawn, row-major
+    std::vector<unsigned char> search_states; // search and path layer
+    std::vector<int> touched_cells;           // cells with a search state
+    std::vector<int> path_cells;
+    std::vector<unsigned char> under_path;    // search states covered by the path
+    std::vector<unsigned char> flows;
+    int flow_max_distance = 1; // distance of the last level, set at full builds
+
+    DirtyRows dirty_states;
+    DirtyRows dirty_costs; // the costs are uploaded from the grid
+    DirtyRows dirty_flows;
+
+    float palette[Palette_Size * 3] =
+    {
+        0.972f, 0.913f, 0.898f, // free
+        0.96f, 0.631f, 0.631f,  // opened
+        0.709f, 0.411f, 0.65f,  // closed
+        0.631f, 0.827f, 0.96f,  // backward opened
+        0.411f, 0.584f, 0.709f, // backward closed
+        0.145f, 0.211f, 0.341f, // blocked
+        0.0f, 0.835f, 1.0f,     // start
+        0.0f, 1.0f, 0.333f      // destination
+    };
+    float line_color[3] = {0.2f, 0.2f, 0.2f};
+    // the cheapest terrain above 1 and the most expensive one
+    float heat_colors[2 * 3] =
+    {
+        0.96f, 0.86f, 0.55f,
+        0.55f, 0.2f, 0.05f
+    };
+    // at the destination and at the largest distance of the field
+    float flow_colors[2 * 3] =
+    {
+        0.8f, 0.95f, 0.85f,
+        0.2f, 0.35f, 0.55f
+    };
+    float arrow_color[3] = {0.1f, 0.1f, 0.1f};
+
+    // grid lines get too dense to be useful below this cell size
+    float min_grid_lines_cell_pixels = 4.0f;
+    // same for the flow arrows
+    float min_arrows_cell_pixels = 10.0f;
+
+    void AllocateStates();
+    unsigned char ComposeState(int cell) const;
+    unsigned char EncodeFlow(int cell) const;
+    void RefreshAllFlows();
+    void RefreshCell(int cell);
+    void SetSearchState(int cell, unsigned char state);
+    void AppendCells(const std::vector<int> &cells, unsigned char state);
+    void ClearPath();
+    void UploadChanges(unsigned int texture, const unsigned char *cells, DirtyRows &dirty);
+
+public:
+    BoardRenderer(const Grid *rendered_grid, const Searcher *rendered_searcher, const Camera *view_camera);
+    void Initialize();
+
+    // re-upload after the grid was edited
+    void UpdateCell(int cell);
+    void UpdateCost(int cell);
+    void UpdateMainCells();
+    // after ClearAll, SetOccupancy, SetCosts or Resize, a new size drops the drawn search
+    void UpdateAllCells();
+
+    // forgets the drawn search and path
+    void Reset();
+    void AppendStep();
+    void AppendBatch(const BackgroundSearch::StepBatch &batch);
+    void UpdatePath();
+    void UpdatePath(const std::vector<int> &path);
+    // draws the replayed search instead of the live one. A rebuilt replay is
+    // copied in one pass and uploaded whole, otherwise only its changed cells
+    // are drawn. The replay must belong to a grid of the drawn size
+    void ShowReplay(const TraceReplay &replay);
+
+    // nullptr hides the flow field
+    void SetFlowField(const FlowField *field);
+    // re-upload after FlowField::Update, a repair only re-uploads the cells it changed
+    void UpdateFlow();
+
+    // uploads the changed cells first
+    void Draw(const ShaderProgram &shader);
+};
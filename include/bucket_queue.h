@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// bucket queue (Dial's algorithm) of cell indices for small non-negative
+// integer costs, with the same interface as IndexedHeap. Every all_cost value
+// has a doubly linked list of items in a circular array of buckets covering
+// the queued costs, so put, decrease-key and remove are O(1) and get only
+// walks past the empty buckets in front of the smallest cost. A* with a
+// consistent heuristic never queues more than the largest move cost plus
+// the heuristic drop of a move above the smallest cost, the array doubles
+// if a wider spread shows up.
+// Items with the same all_cost are not fully ordered by d_cost: a new item
+// goes first if its d_cost is not larger than the d_cost of the current
+// first one and last otherwise
+class BucketQueue
+{
+private:
+    enum { Min_Buckets = 64 };
+
+    struct Entry
+    {
+        int all_cost; // -1 if the item is not queued
+        int d_cost;
+        int previous;
+        int next;
+    };
+
+    struct Bucket
+    {
+        int first;
+        int last;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<Bucket> buckets; // the size is a power of two
+    int lowest = 0;  // all_cost of the first item while the queue is not empty
+    int highest = 0; // no queued all_cost is larger
+    std::size_t count = 0;
+
+    Bucket& BucketOf(int all_cost);
+    void PushFront(int item);
+    void PushBack(int item);
+    void Unlink(int item);
+    void SkipEmptyBuckets();
+    void Grow(int spread);
+
+public:
+    BucketQueue(std::size_t capacity = 0);
+
+    // every item must be in [0, capacity)
+    void reserve(std::size_t capacity);
+    int get();
+    // all_cost of the item get() would return, the queue must not be empty
+    int top_cost() const;
+    int top_d_cost() const;
+    bool empty() const;
+    std::size_t size() const;
+    bool contains(int item) const;
+    void clear();
+    // inserts the item or updates its costs if it is already queued
+    void put(int item, int all_cost, int d_cost);
+    // does nothing if the item is not queued
+    void remove(int item);
+};
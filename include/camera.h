@@ -0,0 +1,26 @@
+#pragma once
+
+// maps world coordinates, where every cell is a 1x1 square and the cell
+// (column, row) spans [column, column + 1] x [row, row + 1], to the window
+class Camera
+{
+private:
+    float center_x = 0.0f; // world point in the middle of the window
+    float center_y = 0.0f;
+    float cell_pixels = 1.0f; // on-screen side of a single cell
+
+    float min_cell_pixels = 1.0f;
+    float max_cell_pixels = 1.0f;
+
+public:
+    // shows the whole grid and resets the zoom limits
+    void Fit(int width, int height);
+    // zooms keeping the world point under the screen position in place
+    void Zoom(float factor, double screen_x, double screen_y);
+    void Pan(double delta_x, double delta_y);
+
+    float CellPixels() const;
+    void ScreenToWorld(double screen_x, double screen_y, float &world_x, float &world_y) const;
+    // xy - scale, zw - translation of the world -> clip space transform
+    void View(float view[4]) const;
+};
@@ -1,16 +1,11 @@
 #pragma once
 
+// grid coordinates of a cell. Grid and Searcher address cells by their
+// row-major index (row * width + column), this is only a convenience pair
 struct Cell
 {
-    struct Point
-    {
-        float x;
-        float y;
-    } center;
-
     int grid_column;
     int grid_row;
-    bool is_free = true;
 
     bool operator==(const Cell &cell) const
     {
@@ -33,4 +28,4 @@ struct Cell
         return grid_row == cell.grid_row ? grid_column > cell.grid_column : 
                                            grid_row > cell.grid_row;
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+
+class Grid;
+
+// labels the connected areas of free cells, two free cells share a label iff
+// a path exists between them. Connectivity follows the neighbour masks of the
+// grid, so the corner cutting rule is respected. Edits relabel locally: a
+// freed cell merges the areas around it by relabelling all but the largest
+// one, a blocked cell can only cut the links between its own neighbours, and
+// when it does, searches grown from every cut-off side in turns stop as soon
+// as one side is left, so only the smaller sides are relabelled. A whole
+// new occupancy only invalidates the labels, the first query rebuilds them,
+// so loading a map does not pay for labels nothing asks for
+class ComponentLabels
+{
+private:
+    // queries can come from several threads at once, the first one after
+    // Invalidate rebuilds. Copies get a mutex of their own
+    struct StaleFlag
+    {
+        std::atomic<bool> is_stale{true};
+        std::mutex mutex;
+
+        StaleFlag() = default;
+        StaleFlag(const StaleFlag &other) : is_stale(other.is_stale.load()) {}
+        StaleFlag& operator=(const StaleFlag &other)
+        {
+            is_stale = other.is_stale.load();
+            return *this;
+        }
+    };
+    StaleFlag stale;
+
+    std::vector<int> labels; // -1 for blocked cells
+    std::vector<int> sizes;  // cells of every label, 0 for unused labels
+    std::vector<int> free_labels;
+
+    // scratch of the edits
+    std::vector<int> queue;
+    std::vector<int> side_cells[8];
+
+    // scratch of Rebuild: runs of free cells along the rows and their
+    // union-find parents, which turn into labels at the end
+    struct Run
+    {
+        int row;
+        int first_column;
+        int last_column;
+    };
+    std::vector<Run> runs;
+    std::vector<int> run_parents;
+
+    int FindRoot(int run);
+    int NewLabel();
+    void ReleaseLabel(int label);
+    // gives the cells labelled from and connected to seed the label to,
+    // returns how many there were
+    std::size_t Relabel(const Grid &grid, int seed, int from, int to);
+    void SplitAround(const Grid &grid, int cell, int label);
+
+public:
+    // labels every cell from scratch
+    void Rebuild(const Grid &grid);
+    // the next Update rebuilds, edits until then are ignored
+    void Invalidate();
+    // rebuilds if invalidated, call before reading labels
+    void Update(const Grid &grid);
+    // call after the neighbour masks around the edited cell were updated
+    void CellFreed(const Grid &grid, int cell);
+    void CellBlocked(const Grid &grid, int cell);
+
+    int Label(int cell) const;
+    // cells sharing the label
+    std::size_t Size(int label) const;
+};
@@ -3,10 +3,6 @@
 enum 
 {
     W_Side = 800,
-    G_Resolution_Side = 40
+    G_Default_Side = 40,
+    G_Max_Side = 4096
 };
-
-inline float Normalized(float value)
-{
-    return (value / float(W_Side)) * 2.0f - 1.0f;
-}
\ No newline at end of file
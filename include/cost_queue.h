@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+#include <tuple>
+#include "cell.h"
+
+// the original open list: linear lookup on every put and a full sort after
+// every expansion. Searcher uses OpenList now, this one is kept as
+// a baseline for queue_bench
+class CostQueue
+{
+private:
+    typedef std::tuple<int, int, Cell> CQElement;
+    std::vector<CQElement> elements;
+
+public:
+    Cell get();
+    bool empty() const;
+    void clear();
+    void put_unique(const Cell &item, int all_cost, int d_cost);
+    void sort();
+};
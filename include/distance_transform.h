@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "grid.h"
+
+// full-grid clearance map made of raster sweeps instead of a priority
+// queue. A forward sweep walks the rows from the top, every cell takes the
+// cheapest of its own distance and the three cells above plus a move, then
+// the row is scanned to the right. The backward sweep mirrors it. The row
+// above is done for many cells at once with SSE4.1 or AVX2, picked at
+// runtime, the scans are prefix minima, see the kernels in
+// distance_transform.cpp. Distances are fixed-point like the searches (12
+// straight, 17 diagonal) and ignore terrain costs. Distances to a goal
+// around walls need a sweep pair per turn of the path and lose to Dijkstra,
+// FlowField builds those
+class DistanceTransform
+{
+public:
+    enum Kernel
+    {
+        Scalar_Kernel = 0,
+        Sse_Kernel,  // SSE4.1, 4 cells at a time
+        Avx2_Kernel, // 8 cells at a time
+        Kernels_Count
+    };
+
+    enum { Infinity = 1 << 29 };
+
+private:
+    const Grid *grid;
+    Kernel kernel;
+
+    std::vector<int> distances; // row-major
+
+    void Sweep(bool is_forward);
+
+public:
+    // starts with the best kernel the cpu supports
+    DistanceTransform(const Grid *measured_grid);
+
+    // command line names: scalar, sse, avx2
+    static const char *KernelKey(Kernel kind);
+    static bool KernelFromKey(const std::string &key, Kernel &kind);
+    // compiled in and supported by this cpu
+    static bool IsSupported(Kernel kind);
+    static Kernel BestKernel();
+    // unsupported kernels fall back to the scalar one
+    void SetKernel(Kernel kind);
+    Kernel KernelKind() const;
+
+    // distance from every cell to the nearest blocked cell, through any
+    // cells. 0 for blocked cells, Infinity for all of them on an open grid.
+    // The grid border is not an obstacle. Two sweeps are always exact
+    void Clearance();
+
+    const std::vector<int>& Distances() const;
+    int Distance(int cell) const;
+};
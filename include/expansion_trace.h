@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "grid.h"
+
+// compact record of one search: the grid it ran on, the query, the cell
+// expanded by every search step, the cells that step opened or re-parented
+// (already queued cells it found a cheaper path to), and the result. The
+// parent of those cells is the cell expanded in the same step, so it is not
+// stored. Steps are packed as they are appended:
+//   varint  side (0 none, 1 forward, 2 backward) | has neighbours << 2
+//           | has re-parented << 3 | far cells count << 4
+//   varint  zigzag delta of the expanded cell from the last expanded one
+//   byte    mask of the opened neighbours, bit d for Grid direction d,
+//           only if a neighbour was opened
+//   varint  zigzag delta from the expanded cell of every opened cell that
+//           is not a neighbour (jump points)
+//   then only if cells were re-parented: a byte mask of the re-parented
+//   neighbours, a varint count of the others and their zigzag deltas
+// an A* step takes about 5.5 bytes. The order of the cells is not kept.
+// Files start with "ATRC" and a format version, see Save
+class ExpansionTrace
+{
+public:
+    enum { Format_Version = 2 };
+
+    struct Step
+    {
+        int expanded = -1; // -1 if the step expanded nothing
+        bool is_backward = false;
+        std::vector<int> opened;
+        std::vector<int> reparented;
+    };
+
+private:
+    int width = 0;
+    int height = 0;
+    int start = -1;
+    int destination = -1;
+    int algorithm = 0;
+    // copies of the grid's layers, taken without visiting the cells one by one
+    std::vector<std::uint64_t> blocked;
+    std::vector<unsigned char> costs;
+
+    std::vector<unsigned char> steps;
+    std::size_t steps_count = 0;
+    int last_expanded = 0;
+    bool is_recording = false;
+    std::vector<int> far_cells; // opened cells of a step that are not neighbours
+
+    bool path_found = false;
+    int path_cost = 0;
+    std::vector<int> path;
+
+    bool DecodeCells(std::size_t &offset, int expanded, unsigned char neighbours, std::uint64_t far_count,
+                     std::vector<int> &cells) const;
+    bool ReadFile(const std::vector<unsigned char> &bytes, const std::string &path);
+
+public:
+    // drops the last trace and records a search of the grid from start to
+    // destination. The algorithm is stored as a number, see Searcher::Algorithm
+    void Begin(const Grid &grid, int start_cell, int destination_cell, int algorithm_index);
+    // one search step, expanded is -1 if the step took no cell from the open
+    // list. Opened cells were not queued before the step, re-parented ones were
+    void AppendStep(int expanded, bool is_backward, const std::vector<int> &opened, const std::vector<int> &reparented);
+    // stops recording
+    void Finish(bool is_found, int cost, const std::vector<int> &found_path);
+    bool IsRecording() const;
+
+    bool Save(const std::string &file_path) const;
+    // the steps are checked while loading, a truncated or corrupt file is rejected
+    bool Load(const std::string &file_path);
+    // resizes the grid to the traced one and copies its cells, start and destination
+    void RestoreGrid(Grid &grid) const;
+
+    // decodes the step at offset and moves offset and previous_expanded past
+    // it, false at the end of the steps. Start with offset 0 and Start()
+    bool DecodeStep(std::size_t &offset, int &previous_expanded, Step &step) const;
+
+    int Width() const;
+    int Height() const;
+    int Start() const;
+    int Destination() const;
+    int AlgorithmIndex() const;
+    std::size_t StepsCount() const;
+    // encoded steps only, without the header and the grid
+    std::size_t StepsBytes() const;
+    bool PathFound() const;
+    int PathCost() const;
+    const std::vector<int>& Path() const;
+};
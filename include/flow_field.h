@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "grid.h"
+#include "indexed_heap.h"
+
+// a flow field towards one destination: a single reverse Dijkstra pass from
+// the destination gives every cell the direction of its next step on a
+// cheapest path, so any number of agents sharing the destination walk their
+// paths without searching. Directions take 3 bits per cell, 21 cells to a
+// 64-bit word. The distances are kept too, edits only re-settle the cells
+// whose distance depends on the edited cells instead of the whole grid.
+// Moves follow the grid's neighbour masks like the 8-connected A*
+class FlowField
+{
+public:
+    enum { Cells_Per_Word = 21, Infinity = 1 << 30 };
+
+private:
+    const Grid *grid;
+    int wanted_destination = -1; // -1 follows the grid's destination
+
+    int destination = -1;
+    std::vector<std::uint64_t> directions;
+    std::vector<int> distances;
+    int max_distance = 0;
+
+    bool is_built = false;
+    std::uint64_t built_version = 0;
+    std::size_t built_cells_count = 0;
+    std::vector<int> pending_cells; // edited since the last update
+
+    bool was_rebuilt = false;
+    std::vector<int> changed_cells;
+    std::size_t settled_count = 0;
+
+    // scratch of the builds and repairs
+    std::vector<std::vector<int>> buckets;
+    IndexedHeap queue;
+    std::vector<int> invalid_cells;
+
+    void SetDirection(int cell, int direction);
+    bool IsInside(int cell, int direction) const;
+    // whether the field was built for the grid's size and holds the cell
+    bool Fits(int cell) const;
+    // cheapest distance through a neighbour, Infinity if none is reached
+    int BestStep(int cell, int &direction) const;
+    void Build();
+    void Invalidate(int root);
+    void Repair();
+
+public:
+    FlowField(const Grid *flowed_grid);
+
+    // -1 (the default) takes grid->Destination() at every update
+    void SetDestination(int cell);
+    // destination of the current field, -1 if there is none
+    int DestinationCell() const;
+
+    // call once per edit that (un)blocked the cell or changed its cost.
+    // Edits the field was not told about make the next update a full build
+    void CellChanged(int cell);
+    // builds the field if the destination, the grid size or untold edits
+    // require it, otherwise repairs the edited cells
+    void Update();
+    bool IsBuilt() const;
+
+    // the queries below hold for the field of the last update. After the
+    // grid was resized they reach nothing until the next update
+    bool IsReachable(int cell) const;
+    // direction of the next step, only meaningful for reachable cells
+    // other than the destination, 0 if the field does not fit the grid
+    int Direction(int cell) const;
+    // -1 at the destination and for cells that cannot reach it
+    int NextCell(int cell) const;
+    // cost of the cheapest path to the destination, Infinity if there is none
+    int Distance(int cell) const;
+    int MaxDistance() const;
+    // walks the directions, the path excludes both ends like Searcher::Path().
+    // False if the cell cannot reach the destination
+    bool Path(int cell, std::vector<int> &path) const;
+
+    // true if the last update built the whole field, ChangedCells holds
+    // the cells whose direction or distance a repair changed otherwise
+    bool WasRebuilt() const;
+    const std::vector<int>& ChangedCells() const;
+    // cells settled by the last update
+    std::size_t SettledCount() const;
+    std::size_t MemoryBytes() const;
+};
@@ -2,66 +2,125 @@
 
 #include <vector>
 #include <cstddef>
+#include <cstdint>
 #include "constants.h"
 #include "cell.h"
+#include "component_labels.h"
 
+// cells are addressed by their row-major index: row * width + column.
+// occupancy is a bitset and every cell keeps a mask of the neighbours
+// it can step to, updated incrementally whenever a cell is (un)blocked.
+// every occupancy edit bumps the grid version, and each square region of
+// cells remembers the version it was last touched in.
+// every cell also has a terrain cost in [1, Max_Cost]: a move costs its
+// fixed-point length (Straight_Cost or Diagonal_Cost, 17/12 is close to
+// the square root of 2) times the cost of the cell it enters
 class Grid
 {
-private:
-    std::vector<std::vector<Cell>> cells;
-    float cell_size = W_Side / G_Resolution_Side;
-
-    unsigned int grid_vao;
+public:
+    enum { Directions_Count = 8, Region_Side = 16, Max_Cost = 255 };
+    enum { Straight_Cost = 12, Diagonal_Cost = 17 };
+    // direction d of the neighbour masks moves by (Direction_Columns[d], Direction_Rows[d])
+    static const int Direction_Columns[Directions_Count];
+    static const int Direction_Rows[Directions_Count];
 
-    Cell *start = nullptr;
-    Cell *destination = nullptr;
+private:
+    int width;
+    int height;
 
-    unsigned int start_vao;
-    unsigned int start_vbo;
-    unsigned int destination_vao;
-    unsigned int destination_vbo;
+    std::vector<std::uint64_t> blocked; // 1 bit per cell
+    std::vector<unsigned char> neighbour_masks;
+    int neighbour_offsets[Directions_Count];
 
-    float start_data[8]; // x & y for all 4 corners
-    float destination_data[8];
-    float start_color[3] = {0.0f, 0.835f, 1.0f};
-    float destination_color[3] = {0.0f, 1.0f, 0.333f};
+    std::vector<unsigned char> costs;
+    std::size_t cost_counts[Max_Cost + 1]; // cells of every cost
 
-    unsigned int blocked_cells_vao;
-    unsigned int blocked_cells_vbo;
+    int start = -1;
+    int destination = -1;
 
-    float blocked_cells_color[3] = {0.145f, 0.211f, 0.341f};
+    std::uint64_t version = 0;
+    int regions_columns;
+    int regions_rows;
+    std::vector<std::uint64_t> region_versions;
 
-    void UpdateMainCellDataStorage(const Cell *cell, float *data_storage);
-    void UpdateMainCellVbo(unsigned int &VBO, float *data, std::size_t data_size);
-    void UpdateBlockedCellsVbo(float *data, std::size_t data_size, std::size_t offset);
+    // built by the first query after the occupancy was replaced
+    mutable ComponentLabels components;
 
-    void RemoveStartCell();
-    void RemoveDestinationCell();
+    unsigned char ComputeNeighbourMask(int column, int row) const;
+    void TouchRegionsAround(int index);
+    void TouchAllRegions();
+    void UpdateNeighbourMasksAround(int index);
+    void RebuildNeighbourMasks();
     void RemoveAllBlockedCells();
+    void ResetCosts();
 
 public:
-    Grid();
-    void InitializeGrid();
-    void InitializeMainCells();
-    void InitializeBlockedCells();
-
-    const Cell *Start() const;
-    const Cell *Destination() const;
-    const float* StartColor() const;
-    const float* DestinationColor() const;
-
-    std::vector<Cell> ReachableFreeNeighbourCells(const Cell &cell) const;
-    Cell* FindCellAround(double position_x, double position_y);
-    float* NormalizedDefaultCellCoords(std::size_t &size) const;
+    Grid(int grid_width = G_Default_Side, int grid_height = G_Default_Side);
+    // drops all blocked cells, start and destination. blocked_bits, laid out
+    // like BlockedBits, gives the new occupancy without a second rebuild
+    void Resize(int grid_width, int grid_height, const std::uint64_t *blocked_bits = nullptr);
+
+    int Width() const;
+    int Height() const;
+    std::size_t CellsCount() const;
+    bool Contains(int column, int row) const;
+    int Index(int column, int row) const;
+    int Column(int index) const;
+    int Row(int index) const;
+    Cell CellOf(int index) const;
+
+    bool IsFree(int index) const;
+    bool IsFree(int column, int row) const;
+    // bit index & 63 of word index >> 6 is set for blocked cells
+    const std::vector<std::uint64_t>& BlockedBits() const;
+    // bit k is set if cell index + k is free, cells past the last one read
+    // as blocked
+    std::uint64_t FreeBits(std::size_t index) const;
+
+    // -1 if not set
+    int Start() const;
+    int Destination() const;
+
+    // bit d is set if the cell can step in direction d: the neighbour is
+    // inside the grid, free and, for diagonal moves, not cut off by
+    // both orthogonal neighbours being blocked
+    unsigned char NeighbourMask(int index) const;
+    int NeighbourOffset(int direction) const;
+
+    // label of the connected area of a free cell, -1 for blocked cells.
+    // After Resize or a whole new occupancy the first of these queries
+    // labels the grid, from any thread
+    int Component(int index) const;
+    // free cells in the connected area of a free cell
+    std::size_t ComponentSize(int index) const;
+    // whether a path exists between the two cells, O(1)
+    bool AreConnected(int a, int b) const;
+
+    int Cost(int index) const;
+    // row-major, one byte per cell
+    const std::vector<unsigned char>& Costs() const;
+    // true while every cell costs 1
+    bool HasUniformCosts() const;
+    int MaxCost() const;
     
-    void SetStartCell(Cell *cell);
-    void SetDestinationCell(Cell *cell);
-    void PlaceBlockedCell(Cell *cell);
-    void RemoveBlockedCell(Cell *cell);
+    void SetStartCell(int index);
+    void SetDestinationCell(int index);
+    void PlaceBlockedCell(int index);
+    void RemoveBlockedCell(int index);
+    // replaces the whole occupancy layer, blocked_flags holds one value per cell
+    void SetOccupancy(const std::vector<unsigned char> &blocked_flags);
+    // costs are clamped to [1, Max_Cost], blocked cells keep theirs too
+    void SetCost(int index, int cost);
+    // replaces the whole cost layer, one value per cell
+    void SetCosts(const std::vector<unsigned char> &cell_costs);
+    void SetCosts(const unsigned char *cell_costs, std::size_t count);
+    // drops the costs as well
     void ClearAll();
 
-    void DrawSetOfGridLines() const;
-    void DrawStart() const;
-    void DrawDestination() const;
-    void DrawBlockedCells() const;
-};
\ No newline at end of file
+    std::uint64_t Version() const;
+    int RegionsColumns() const;
+    int RegionsRows() const;
+    // version of the last edit that could change a move starting or ending
+    // in the region: an edited cell touches the regions of its 3x3 block
+    std::uint64_t RegionVersion(int region_column, int region_row) const;
+};
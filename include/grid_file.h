@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include "grid.h"
+
+// binary grid files, all numbers little-endian:
+//   "AGRD", u32 version, u32 width, u32 height, i32 start, i32 destination
+//   (-1 if not set), u32 layers count, u32 reserved
+//   a table entry per layer: u32 kind (1 occupancy, 2 costs), u32 encoding
+//   (0 raw, 1 runs), u64 offset from the file start, u64 size
+// the occupancy layer is stored raw as the grid's blocked bitset (64 cells
+// per u64) or as varint lengths of alternating free and blocked runs,
+// starting with free. The cost layer is optional: one byte per cell raw, or
+// (cost, varint run length) pairs. Layers start at 8-byte offsets so a
+// mapped raw layer is copied straight into the grid. Readers skip layer
+// kinds they don't know, files of a newer version are rejected
+enum { Grid_File_Version = 1 };
+
+// writes the smaller encoding of every layer, the cost layer only if some
+// cell costs more than 1
+bool SaveGridFile(const std::string &path, const Grid &grid);
+// memory maps the file where the platform allows it, reads it otherwise.
+// The grid is left as it was if the file is rejected
+bool LoadGridFile(const std::string &path, Grid &grid);
+// whether the file starts with the grid file magic
+bool IsGridFile(const std::string &path);
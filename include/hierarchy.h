@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "grid.h"
+#include "search_arena.h"
+
+// HPA*: the grid is cut into square clusters. Neighbouring clusters are linked
+// by transitions placed on the free runs of their shared border, the cells of
+// these transitions are the abstract nodes and every cluster stores the
+// distances between its nodes. A query runs A* over the abstract graph and
+// refines every abstract edge into cells with a search bound to one cluster.
+// Moves crossing a cluster corner diagonally are not part of the abstract
+// graph, so paths are near-optimal rather than optimal
+class Hierarchy
+{
+public:
+    enum { Default_Cluster_Side = 16 };
+
+private:
+    // free runs shorter than this get one transition in the middle,
+    // longer ones get a transition at each end
+    enum { Max_Single_Transition_Run = 6 };
+
+    struct Cluster
+    {
+        int first_column;
+        int first_row;
+        int width;
+        int height;
+        std::vector<int> nodes;     // node ids
+        // nodes.size() squared, row i holds the distances from node i,
+        // -1 if not connected inside the cluster
+        std::vector<int> distances;
+    };
+
+    // cells first_cell + i * along for i in [0, length) face the cells
+    // first_cell + i * along + across of the next cluster
+    struct Border
+    {
+        int first_cell;
+        int along;
+        int across;
+        int length;
+        int clusters[2];
+        std::vector<int> transitions; // pairs of facing cells
+    };
+
+    struct Node
+    {
+        int cell;    // -1 for unused ids
+        int cluster;
+        int slot;    // position in the cluster nodes
+    };
+
+    const Grid *grid;
+    int cluster_side;
+    int clusters_columns = 0;
+    int clusters_rows = 0;
+    int built_width = 0;
+    int built_height = 0;
+
+    std::vector<Cluster> clusters;
+    std::vector<Border> borders; // vertical borders first
+    std::vector<Node> nodes;
+    std::vector<int> free_nodes;
+
+    // scratch of ClusterDistances, one bucket per distance a move can add plus one
+    std::vector<int> local_distances;
+    std::vector<std::vector<int>> buckets;
+
+    int ClusterOf(int cell) const;
+    int FindNode(int cluster_index, int cell) const;
+    int VerticalBorder(int cluster_column, int cluster_row) const;
+    int HorizontalBorder(int cluster_column, int cluster_row) const;
+
+    void BuildBorder(Border &border);
+    void BuildCluster(int cluster_index);
+    // distances from source to every cell of the cluster in local_distances
+    // (-1 if unreachable without leaving the cluster)
+    void ClusterDistances(const Cluster &cluster, int source);
+    // A* bound to the cluster, explores the whole cluster if target is -1.
+    // A reversed search gets the distances to source instead of from it
+    void ClusterSearch(const Cluster &cluster, int source, int target, SearchArena &arena, bool is_reversed = false) const;
+    void AppendClusterPath(const Cluster &cluster, int from, int to, SearchArena &arena, std::vector<int> &cells) const;
+
+public:
+    Hierarchy(const Grid *abstracted_grid, int side = Default_Cluster_Side);
+
+    // (re)builds everything, needed after Resize, SetOccupancy, SetCosts or ClearAll
+    void Build();
+    bool IsBuilt() const;
+    // recomputes the cluster of an edited cell and, when the cell lies on a
+    // cluster border, the transitions of that border and the cluster behind it.
+    // does nothing until the hierarchy is built
+    void UpdateCell(int cell);
+
+    int ClusterSide() const;
+    std::size_t NodesCount() const;
+    // every abstract edge as a pair of cells
+    void AbstractEdges(std::vector<int> &cell_pairs) const;
+
+    // safe to call from several threads as long as every thread passes its
+    // own arenas, both are resized as needed: cell_arena to the cells of one
+    // cluster, node_arena to the abstract graph. path excludes start and destination like
+    // Searcher::Path(), expanded counts the abstract nodes taken from the open list
+    bool FindPath(int start, int destination, SearchArena &cell_arena, SearchArena &node_arena,
+                  std::vector<int> &path, int &path_cost, std::size_t &expanded) const;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include "grid.h"
+#include "hierarchy.h"
+#include "shader_program.h"
+
+// cluster borders and abstract edges of the HPA* hierarchy as lines
+class HierarchyRenderer
+{
+private:
+    const Grid *grid;
+    const Hierarchy *hierarchy;
+
+    unsigned int overlay_vao;
+    unsigned int overlay_vbo;
+    std::size_t border_vertices_count = 0; // borders go first in the vbo
+    std::size_t edge_vertices_count = 0;
+
+    float border_color[4] = {0.905f, 0.435f, 0.317f, 1.0f};
+    float edge_color[4] = {0.164f, 0.615f, 0.560f, 1.0f};
+
+public:
+    HierarchyRenderer(const Grid *rendered_grid, const Hierarchy *rendered_hierarchy);
+    void Initialize();
+    // re-upload after the hierarchy was built or updated
+    void Update();
+    void Draw(const ShaderProgram &shader) const;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "grid.h"
+#include "indexed_heap.h"
+
+// D* Lite: plans from the destination towards the start and keeps its g and
+// rhs values between queries. After cells get (un)blocked or the start moves
+// only the vertices whose distance changed are expanded again, so the cost of
+// a replan follows the size of the change rather than the size of the map
+class IncrementalPlanner
+{
+public:
+    enum { Infinity = 1 << 29 };
+
+private:
+    const Grid *grid;
+
+    std::vector<int> g_costs;
+    std::vector<int> rhs_costs; // one-step lookahead of the g-costs
+    // ordered by (min(g, rhs) + h + key_modifier, min(g, rhs))
+    IndexedHeap queue;
+
+    int start = -1;
+    int destination = -1;
+    int last_start = -1;
+    int key_modifier = 0; // sum of the heuristic drops caused by start moves
+
+    bool is_planned = false;
+    std::vector<int> path;
+    std::size_t expanded_count = 0;
+
+    int Heuristic(int cell) const;
+    int ComputeRhs(int cell) const;
+    void UpdateVertex(int cell);
+    void QueueIfInconsistent(int cell);
+    bool IsStartConsistent() const;
+    void BuildPath();
+
+public:
+    IncrementalPlanner(const Grid *planned_grid);
+
+    // forgets everything and queues the destination
+    void Start(int start_cell, int destination_cell);
+    bool IsStarted() const;
+    int StartCell() const;
+    int DestinationCell() const;
+
+    // call after the cell was (un)blocked or its cost changed, the plan must be started
+    void CellChanged(int cell);
+    // the agent moved, the new start does not have to be next to the old one
+    void MoveStart(int start_cell);
+
+    // expands one vertex and returns it, -1 once the plan is up to date
+    int Step();
+    void Plan();
+    bool IsPlanned() const;
+
+    // valid once IsPlanned(). The path walks down the g-costs from the start
+    // and excludes start and destination like Searcher::Path()
+    bool PathFound() const;
+    int PathCost() const;
+    const std::vector<int>& Path() const;
+    // vertices expanded since the last Start, CellChanged or MoveStart
+    std::size_t ExpandedCount() const;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// binary min-heap of cell indices ordered by (all_cost, d_cost, index).
+// position of every index inside the heap is kept in a flat array, so
+// lookup is O(1) and put/decrease-key/get are O(log n)
+class IndexedHeap
+{
+private:
+    struct HeapElement
+    {
+        int all_cost;
+        int d_cost;
+        int item;
+
+        bool operator<(const HeapElement &el) const
+        {
+            if (all_cost != el.all_cost)
+                return all_cost < el.all_cost;
+            if (d_cost != el.d_cost)
+                return d_cost < el.d_cost;
+            return item < el.item;
+        }
+    };
+
+    std::vector<HeapElement> elements;
+    std::vector<int> position; // -1 if the item is not in the heap
+
+    void SiftUp(std::size_t i);
+    void SiftDown(std::size_t i);
+    void Swap(std::size_t a, std::size_t b);
+
+public:
+    IndexedHeap(std::size_t capacity = 0);
+
+    // every item must be in [0, capacity)
+    void reserve(std::size_t capacity);
+    int get();
+    // all_cost of the item get() would return, the heap must not be empty
+    int top_cost() const;
+    int top_d_cost() const;
+    bool empty() const;
+    std::size_t size() const;
+    bool contains(int item) const;
+    void clear();
+    // inserts the item or updates its costs if it is already queued
+    void put(int item, int all_cost, int d_cost);
+    // does nothing if the item is not queued
+    void remove(int item);
+};
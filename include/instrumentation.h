@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// low-overhead counters and scoped timers. Every thread counts into a block of
+// its own, so hot loops of different threads never share a cache line, and
+// the blocks are summed on demand. Timers are only recorded while a trace is
+// running, the trace is written as Chrome trace_event JSON that loads in
+// chrome://tracing or Perfetto. Without ASTAR_INSTRUMENTATION defined the
+// ASTAR_COUNT and ASTAR_SCOPED_TIMER macros compile to nothing
+class Instrumentation
+{
+public:
+    enum Counter
+    {
+        Nodes_Expanded = 0,
+        Open_List_Pushes,
+        Decrease_Keys,
+        Neighbours_Generated,
+        Gl_Bytes_Uploaded,
+        Counters_Count
+    };
+
+    // registers itself on the first count of a thread and folds its values
+    // into the totals of exited threads when the thread ends
+    struct ThreadCounters
+    {
+        std::atomic<std::uint64_t> values[Counters_Count];
+
+        ThreadCounters();
+        ~ThreadCounters();
+    };
+
+private:
+    static ThreadCounters& LocalCounters();
+
+public:
+    static const char *CounterName(Counter counter);
+
+    static void Add(Counter counter, std::uint64_t amount)
+    {
+        // only the owning thread writes its block, so a relaxed load and
+        // store is enough and costs no more than a plain increment
+        std::atomic<std::uint64_t> &value = LocalCounters().values[counter];
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    // sums over all threads, the exited ones included
+    static void ReadCounters(std::uint64_t values[Counters_Count]);
+
+    static std::uint64_t NowMicroseconds();
+
+    static void StartTrace();
+    static bool IsTracing();
+    // complete event on the calling thread, ignored unless tracing
+    static void RecordEvent(const char *name, std::uint64_t begin_us, std::uint64_t end_us);
+    // current counter sums as a counter event, ignored unless tracing
+    static void RecordCounters();
+    // stops the trace and writes every recorded event
+    static bool WriteTrace(const std::string &path);
+};
+
+// records the time between its construction and destruction as a trace event
+class ScopedTimer
+{
+private:
+    const char *name;
+    bool is_recording;
+    std::uint64_t begin_us = 0;
+
+public:
+    explicit ScopedTimer(const char *event_name)
+        : name(event_name), is_recording(Instrumentation::IsTracing())
+    {
+        if (is_recording)
+            begin_us = Instrumentation::NowMicroseconds();
+    }
+
+    ~ScopedTimer()
+    {
+        if (is_recording)
+            Instrumentation::RecordEvent(name, begin_us, Instrumentation::NowMicroseconds());
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+#define ASTAR_CONCAT_NAME(a, b) a##b
+#define ASTAR_TIMER_NAME(line) ASTAR_CONCAT_NAME(scoped_timer_, line)
+
+#ifdef ASTAR_INSTRUMENTATION
+#define ASTAR_COUNT(counter, amount) Instrumentation::Add(Instrumentation::counter, amount)
+#define ASTAR_SCOPED_TIMER(name) ScopedTimer ASTAR_TIMER_NAME(__LINE__)(name)
+#else
+#define ASTAR_COUNT(counter, amount) ((void)0)
+#define ASTAR_SCOPED_TIMER(name) ((void)0)
+#endif
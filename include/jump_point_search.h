@@ -0,0 +1,45 @@
+#pragma once
+
+#include "grid.h"
+
+// neighbour pruning and jumping of Jump Point Search over the grid's
+// 8-connected moves. Pruning rules are not hard-coded: for every incoming
+// direction and every occupancy of the 3x3 block around a cell they are
+// derived once from local shortest paths under the grid's own movement
+// rule (a diagonal move is allowed unless both orthogonal cells are blocked)
+class JumpPointSearch
+{
+public:
+    // incoming "direction" of the start cell, it has no parent
+    enum { No_Direction = Grid::Directions_Count };
+
+private:
+    // successors[direction][free ring]: bit d is set if the neighbour in
+    // direction d has to be considered after entering a cell in `direction`
+    struct PruningTables
+    {
+        unsigned char successors[Grid::Directions_Count + 1][256];
+        unsigned char natural[Grid::Directions_Count + 1];
+    };
+
+    const Grid *grid;
+    // shared by every instance, built by the first one
+    const PruningTables *tables;
+
+    static PruningTables BuildTables();
+
+public:
+    JumpPointSearch(const Grid *searched_grid);
+
+    static bool IsDiagonal(int direction);
+    static int StepCost(int direction);
+    static int DirectionBetween(int from_column, int from_row, int to_column, int to_row);
+
+    // bit d is set if the neighbour in direction d is inside the grid and free
+    unsigned char FreeRing(int cell) const;
+    unsigned char Successors(int cell, int direction) const;
+    // walks from cell in direction until it meets the destination or a
+    // cell with forced neighbours. Returns that cell or -1 if it hits
+    // an obstacle, `steps` is set to the number of moves made
+    int Jump(int cell, int direction, int destination, int &steps) const;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "grid.h"
+
+// ALT heuristic: exact costs from a few landmark cells to every cell, so the
+// triangle inequality d(cell, target) >= d(landmark, target) - d(landmark, cell)
+// gives a lower bound that follows the walls of the map. With uniform costs the
+// costs are symmetric and the reversed difference is a bound too.
+// A table holds one uint16 per cell. Costs above 65534 are stored divided by
+// the scale of their table, 65535 marks cells the landmark cannot reach.
+// Landmarks are placed by hand or, by default, picked by farthest-point
+// selection over hop counts inside the largest connected area. The tables
+// follow the grid's own moves, so they also bound the 4-connected and the
+// no corner cutting moves, which can only cost more
+class Landmarks
+{
+public:
+    enum { Default_Count = 8, Unreachable = 65535 };
+
+private:
+    const Grid *grid;
+    int count = Default_Count;
+    std::vector<int> placed_cells; // empty to pick them
+
+    std::vector<int> cells;
+    std::vector<std::uint16_t> tables; // landmark-major: tables[i * cells_count + cell]
+    std::vector<int> scales;
+    bool is_symmetric = true;
+    bool is_built = false;
+    std::uint64_t built_version = 0;
+    std::size_t built_cells_count = 0;
+
+    void PickCells();
+    void BuildTable(int landmark, std::vector<int> &distances, std::vector<std::vector<int>> &buckets);
+
+public:
+    Landmarks(const Grid *measured_grid);
+
+    // landmarks picked at the next build
+    void SetCount(int landmarks_count);
+    int Count() const;
+    // hand-placed landmarks, blocked ones are skipped. An empty list picks them again
+    void SetPlacedCells(const std::vector<int> &landmark_cells);
+    const std::vector<int>& PlacedCells() const;
+
+    // true while the tables match the grid
+    bool IsBuilt() const;
+    // rebuilds the tables if the grid was edited since the last build, one
+    // table per thread at a time. threads_count == 0 uses every hardware thread
+    void Update(unsigned int threads_count = 0);
+    // the landmarks of the current tables
+    const std::vector<int>& Cells() const;
+    std::size_t MemoryBytes() const;
+
+    // lower bound on the cost of moving from cell to destination, 0 if no landmark helps
+    int Estimate(int cell, int destination) const;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "grid.h"
+
+// seeded procedural maps for stress workloads. The same kind, seed, density
+// and grid size always give the same map, whatever the number of threads:
+// the map is cut into fixed tiles that are generated in parallel, each with
+// its own random stream derived from the seed and the tile.
+//   random       every cell is blocked with the density as probability
+//   backtracker  perfect maze (one path between any two cells), long winding
+//   prim         perfect maze, short dead ends. Mazes are grown in tiles of
+//                64x64 maze cells, joined by one opening per edge of a
+//                spanning tree over the tiles, so the maze stays perfect
+//   rooms        one room per 32x32 sector, joined by L-shaped corridors
+//                along a spanning tree of the sectors and a few extra loops
+//   caves        fractal gradient noise, the lowest density share is blocked
+class MapGenerator
+{
+public:
+    enum Kind
+    {
+        Random = 0,
+        Backtracker_Maze,
+        Prim_Maze,
+        Rooms,
+        Caves,
+        Kinds_Count
+    };
+
+    static const char *KindName(Kind kind);
+    // command line name of the kind: random, backtracker, prim, rooms, caves
+    static const char *KindKey(Kind kind);
+    // false if no kind has that key
+    static bool KindFromKey(const std::string &key, Kind &kind);
+
+private:
+    Kind kind = Random;
+    std::uint64_t seed = 1;
+    double density = 0.25;
+    unsigned int threads_count = 0;
+
+    void GenerateRandom(int width, int height, std::vector<std::uint64_t> &blocked_bits) const;
+    void GenerateMaze(int width, int height, std::vector<unsigned char> &free_cells) const;
+    void GenerateRooms(int width, int height, std::vector<unsigned char> &free_cells) const;
+    void GenerateCaves(int width, int height, std::vector<unsigned char> &free_cells) const;
+
+public:
+    Kind GetKind() const;
+    void SetKind(Kind map_kind);
+    std::uint64_t Seed() const;
+    void SetSeed(std::uint64_t map_seed);
+    // share of blocked cells of the random and cave maps, clamped to [0, 1]
+    double Density() const;
+    void SetDensity(double blocked_share);
+    // 0 uses every hardware thread
+    void SetThreadsCount(unsigned int count);
+
+    // replaces the occupancy of the grid, keeping its size. Costs, start
+    // and destination are dropped
+    void Generate(Grid &grid) const;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "grid.h"
+
+// one query of a Moving AI scenario file
+struct Scenario
+{
+    int bucket;
+    std::string map_name;
+    int map_width;
+    int map_height;
+    int start_column;
+    int start_row;
+    int destination_column;
+    int destination_row;
+    // octile length (diagonal steps cost sqrt(2)) of the shortest path
+    // without cutting corners
+    double optimal_length;
+};
+
+// loads a plain text map: one line per grid row, '.' marks a free cell,
+// a digit from '1' to '9' a free cell of that terrain cost and '#', '@',
+// 'T' or 'O' a blocked cell
+bool LoadAsciiMap(const std::string &path, Grid &grid);
+
+// loads a Moving AI Lab .map file: "type", "height" and "width" header lines,
+// a "map" line and then the rows. '.', 'G' and 'S' are free, anything else
+// ('@', 'O', 'T', 'W') is blocked
+bool LoadMovingAiMap(const std::string &path, Grid &grid);
+
+// picks LoadGridFile for binary grid files (see grid_file.h) and
+// LoadMovingAiMap if the file starts with the "type" header line
+bool LoadMap(const std::string &path, Grid &grid);
+
+// loads a Moving AI Lab .scen file (version 1), appending to scenarios
+bool LoadMovingAiScenario(const std::string &path, std::vector<Scenario> &scenarios);
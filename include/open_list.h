@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include "indexed_heap.h"
+#include "bucket_queue.h"
+
+// open list of a search: an IndexedHeap or a BucketQueue, picked at runtime.
+// Both take the same calls, the bucket queue only suits integer costs whose
+// queued values stay close to each other, which all searches here have
+class OpenList
+{
+public:
+    enum Kind
+    {
+        Binary_Heap = 0,
+        Bucket_Queue,
+        Kinds_Count
+    };
+
+    // command line name of the kind: heap, buckets
+    static const char *KindKey(Kind kind);
+    // false if no kind has that key
+    static bool KindFromKey(const std::string &key, Kind &kind);
+
+private:
+    Kind kind = Binary_Heap;
+    std::size_t capacity = 0;
+    IndexedHeap heap;
+    BucketQueue buckets;
+
+public:
+    // only the queue of the kind is allocated
+    OpenList(std::size_t queue_capacity = 0, Kind queue_kind = Binary_Heap);
+
+    Kind GetKind() const;
+    // drops the queued items
+    void SetKind(Kind queue_kind);
+
+    void reserve(std::size_t capacity);
+    int get();
+    int top_cost() const;
+    int top_d_cost() const;
+    bool empty() const;
+    std::size_t size() const;
+    bool contains(int item) const;
+    void clear();
+    void put(int item, int all_cost, int d_cost);
+    void remove(int item);
+
+    // the queue of the current kind, for searches specialised on it
+    IndexedHeap& Heap();
+    BucketQueue& Buckets();
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include "grid.h"
+
+// bounded LRU cache of (start, destination) -> search result, shared by
+// several searchers (all members lock). A move takes at most 2 off the
+// manhattan distance for at least Grid::Diagonal_Cost, so a found path of
+// cost C only depends on the cells u with
+// manhattan(start, u) + manhattan(u, destination) <= 2 * C / Diagonal_Cost:
+// no cheaper path can use any other cell, and the path itself stays inside.
+// An entry stays valid while no region overlapping that area was touched
+// since the entry was stored. Results without a path depend on the whole grid
+class PathCache
+{
+public:
+    enum { Default_Capacity = 1024 };
+
+    struct Result
+    {
+        bool found;
+        int cost;
+        std::vector<int> path;
+    };
+
+private:
+    struct Entry
+    {
+        int start;
+        int destination;
+        int grid_width; // cell indices mean other cells after a resize
+        std::uint64_t version; // grid version the result was computed at
+        Result result;
+    };
+
+    const Grid *grid;
+    std::size_t capacity;
+
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index;
+    mutable std::mutex cache_mutex;
+
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t evictions = 0;     // dropped to make room
+    std::size_t invalidations = 0; // dropped because an edit touched their area
+
+    static std::uint64_t Key(int start, int destination);
+    bool IsValid(const Entry &entry) const;
+
+public:
+    PathCache(const Grid *cached_grid, std::size_t max_entries = Default_Capacity);
+
+    // copies the result and returns true on a hit
+    bool Find(int start, int destination, Result &result);
+    void Store(int start, int destination, const Result &result);
+    void Clear();
+
+    std::size_t Size() const;
+    std::size_t Capacity() const;
+    std::size_t Hits() const;
+    std::size_t Misses() const;
+    std::size_t Evictions() const;
+    std::size_t Invalidations() const;
+};
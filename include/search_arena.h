@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "open_list.h"
+
+// per-query search state kept in flat arrays indexed by row * width + column.
+// every node remembers the generation it was last written in, so Reset()
+// only bumps the generation instead of clearing the arrays
+class SearchArena
+{
+public:
+    enum NodeState : unsigned char
+    {
+        Unvisited = 0,
+        Opened,
+        Closed
+    };
+
+private:
+    struct Node
+    {
+        int parent;
+        int g_cost;
+        unsigned int generation;
+        NodeState state;
+    };
+
+    std::vector<Node> nodes;
+    unsigned int current_generation = 1;
+
+public:
+    OpenList opened;
+
+    SearchArena(std::size_t cells_count = 0);
+    void Resize(std::size_t cells_count);
+    std::size_t Size() const;
+    void Reset();
+
+    NodeState State(int index) const;
+    int Parent(int index) const;
+    int GCost(int index) const;
+
+    void Open(int index, int parent, int g_cost);
+    void Close(int index);
+};
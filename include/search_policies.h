@@ -0,0 +1,173 @@
+#pragma once
+
+#include <string>
+#include "grid.h"
+#include "open_list.h"
+#include "landmarks.h"
+
+// the pieces the A* core of Searcher is specialised on at compile time.
+// SearchPolicy holds the runtime names of every choice, the structs below
+// are the policies themselves and are meant to be inlined.
+// Heuristics return fixed-point costs, see Grid::Straight_Cost
+class SearchPolicy
+{
+public:
+    enum Heuristic
+    {
+        Manhattan = 0,
+        Octile,
+        Chebyshev,
+        Zero,
+        Landmarks, // ALT, needs built Landmarks and falls back to octile otherwise
+        Heuristics_Count
+    };
+
+    enum Neighbourhood
+    {
+        Four_Connected = 0,
+        Eight_Connected,   // a diagonal move needs one free orthogonal cell, as in the grid masks
+        No_Corner_Cutting, // a diagonal move needs both orthogonal cells free
+        Neighbourhoods_Count
+    };
+
+    // command line names: manhattan, octile, chebyshev, zero, alt
+    static const char *HeuristicKey(Heuristic heuristic);
+    static bool HeuristicFromKey(const std::string &key, Heuristic &heuristic);
+    // command line names: 4, 8, strict
+    static const char *NeighbourhoodKey(Neighbourhood neighbourhood);
+    static bool NeighbourhoodFromKey(const std::string &key, Neighbourhood &neighbourhood);
+};
+
+// bits of the neighbour masks that move along a row or a column
+enum { Orthogonal_Directions = 0x5A };
+
+// the A* core calls Bound(landmarks, cell, destination, columns, rows),
+// columns and rows being the distances from cell to destination. Geometric
+// heuristics only look at the distances and are consistent where they are
+// admissible, so closed cells are never opened again
+template <class Distance>
+struct GeometricHeuristic
+{
+    enum { Reopens_Closed = 0 };
+
+    static int Bound(const Landmarks *, int, int, int columns, int rows)
+    {
+        return Distance::Estimate(columns, rows);
+    }
+};
+
+// only admissible with 4-connected moves, overestimates diagonal ones
+struct ManhattanHeuristic : GeometricHeuristic<ManhattanHeuristic>
+{
+    static int Estimate(int columns, int rows)
+    {
+        return (columns + rows) * Grid::Straight_Cost;
+    }
+};
+
+// exact on an empty 8-connected grid of cost 1
+struct OctileHeuristic : GeometricHeuristic<OctileHeuristic>
+{
+    static int Estimate(int columns, int rows)
+    {
+        int low = columns < rows ? columns : rows;
+        int high = columns < rows ? rows : columns;
+        return high * Grid::Straight_Cost + low * (Grid::Diagonal_Cost - Grid::Straight_Cost);
+    }
+};
+
+// prices diagonal moves like straight ones, admissible but weaker than octile
+struct ChebyshevHeuristic : GeometricHeuristic<ChebyshevHeuristic>
+{
+    static int Estimate(int columns, int rows)
+    {
+        return (columns < rows ? rows : columns) * Grid::Straight_Cost;
+    }
+};
+
+// turns A* into Dijkstra's algorithm
+struct ZeroHeuristic : GeometricHeuristic<ZeroHeuristic>
+{
+    static int Estimate(int, int)
+    {
+        return 0;
+    }
+};
+
+// the better of the landmark bound and octile. Scaled tables round the
+// costs, the bound stays admissible but not consistent, so a closed cell
+// reached by a cheaper path is opened again
+struct LandmarkHeuristic
+{
+    enum { Reopens_Closed = 1 };
+
+    static int Bound(const Landmarks *landmarks, int cell, int destination, int columns, int rows)
+    {
+        int octile = OctileHeuristic::Estimate(columns, rows);
+        int bound = landmarks->Estimate(cell, destination);
+        return bound > octile ? bound : octile;
+    }
+};
+
+// neighbourhoods narrow the grid's neighbour mask down to their moves and
+// give the fixed-point cost of a move in a direction into a cell of cost 1
+struct FourNeighbours
+{
+    static unsigned char Moves(unsigned char mask)
+    {
+        return mask & Orthogonal_Directions;
+    }
+
+    static int StepCost(int)
+    {
+        return Grid::Straight_Cost;
+    }
+};
+
+struct EightNeighbours
+{
+    static unsigned char Moves(unsigned char mask)
+    {
+        return mask;
+    }
+
+    static int StepCost(int direction)
+    {
+        return (Orthogonal_Directions >> direction) & 1 ? Grid::Straight_Cost : Grid::Diagonal_Cost;
+    }
+};
+
+struct NoCornerCutting : EightNeighbours
+{
+    static unsigned char Moves(unsigned char mask)
+    {
+        // the grid masks only hold free cells, so an orthogonal bit tells
+        // whether that side of a diagonal is free. Diagonal 0 (-1, -1) lies
+        // between directions 1 and 3, 2 (-1, 1) between 1 and 4,
+        // 5 (1, -1) between 6 and 3 and 7 (1, 1) between 6 and 4
+        bool left = mask & 0x02;
+        bool up = mask & 0x08;
+        bool down = mask & 0x10;
+        bool right = mask & 0x40;
+        unsigned char diagonals = (left && up ? 0x01 : 0) | (left && down ? 0x04 : 0) |
+                                  (right && up ? 0x20 : 0) | (right && down ? 0x80 : 0);
+        return mask & (Orthogonal_Directions | diagonals);
+    }
+};
+
+// queues pick the concrete queue behind an OpenList, it has to be of their kind
+struct HeapQueue
+{
+    static IndexedHeap& Of(OpenList &list)
+    {
+        return list.Heap();
+    }
+};
+
+struct BucketsQueue
+{
+    static BucketQueue& Of(OpenList &list)
+    {
+        return list.Buckets();
+    }
+};
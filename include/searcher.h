@@ -1,86 +1,177 @@
 #pragma once
 
 #include <vector>
+#include <string>
 #include <cstddef>
-#include <unordered_map>
 #include "grid.h"
-#include "cell.h"
+#include "search_arena.h"
+#include "jump_point_search.h"
+#include "hierarchy.h"
+#include "incremental_planner.h"
+#include "path_cache.h"
+#include "search_policies.h"
+#include "expansion_trace.h"
 
 class Searcher
 {
-private:
-    struct cell_hash
-    {
-        std::size_t operator() (const Cell &cell) const
-        {
-            std::size_t h1 = std::hash<float>()(cell.center.x);
-            std::size_t h2 = std::hash<float>()(cell.center.y);
-
-            return h1 ^ h2;
-        }
-    };
-
-    struct CostQueue
+public:
+    enum Algorithm
     {
-    private:
-        typedef std::tuple<int, int, Cell> CQElement;
-        std::vector<CQElement> elements;
-
-    public:
-        Cell get();
-        const bool empty() const;
-        void clear();
-        void put_unique(const Cell &item, int all_cost, int d_cost);
-        void sort();
+        A_Star = 0,
+        Jump_Point_Search,
+        Bidirectional_A_Star,
+        Hierarchical_A_Star,
+        D_Star_Lite,
+        Algorithms_Count
     };
 
-    bool is_searching = false;
-
-    std::vector<Cell> path;
-    std::size_t path_cells_count = 0;
+    static const char *AlgorithmName(Algorithm algorithm);
+    // command line name of the algorithm: astar, jps, bidirectional, hpa, dstar
+    static const char *AlgorithmKey(Algorithm algorithm);
+    // false if no algorithm has that key
+    static bool AlgorithmFromKey(const std::string &key, Algorithm &algorithm);
 
-    const Cell *start;
-    const Cell *destination;
-    const Grid *grid;
-
-    std::unordered_map<Cell, std::pair<Cell, int>, cell_hash> came_from;
-    std::unordered_map<Cell, int, cell_hash> cost;
-
-    CostQueue opened;
-    std::vector<Cell> closed;
+private:
+    Algorithm algorithm = A_Star;
+    Algorithm running_algorithm = A_Star; // the one picked at StartSearch
+    OpenList::Kind open_list = OpenList::Binary_Heap;
+    SearchPolicy::Heuristic heuristic = SearchPolicy::Octile;
+    SearchPolicy::Neighbourhood neighbourhood = SearchPolicy::Eight_Connected;
 
-    unsigned int path_vao;
-    unsigned int opened_vao;
-    unsigned int closed_vao;
+    // A* runs through a step specialised on the policies, picked at StartSearch
+    typedef void (Searcher::*StepFunction)();
+    StepFunction a_star_step = nullptr;
 
-    unsigned int *opened_vbo;
-    unsigned int *closed_vbo;
-    std::size_t opened_vbo_size = 0;
-    std::size_t closed_vbo_size = 0;
-    std::size_t opened_cells_count = 0;
-    std::size_t closed_cells_count = 0;
+    bool is_searching = false;
+    bool path_found = false;
 
-    float opened_color[3] = {0.96f, 0.631f, 0.631f};
-    float closed_color[3] = {0.709f, 0.411f, 0.65f};
+    std::vector<int> path;
+    int path_cost = 0;
+    std::size_t expanded_count = 0;
 
-    void InitializeCellsVao(unsigned int& VAO, float *cells_color, std::size_t color_size);
-    void SetPathVbo(float *data, std::size_t data_size, unsigned int attrib_index, unsigned int components_count);
-    void AppendToOffsetsVbo(unsigned int &VAO, unsigned int **VBO, std::size_t &vbo_size, float *data, std::size_t data_size);
+    int start = -1;
+    int destination = -1;
+    int destination_column = 0;
+    int destination_row = 0;
+    const Grid *grid;
 
-    int Distance(const Cell &a, const Cell &b) const;
+    SearchArena arena;
+    JumpPointSearch jump_points;
+
+    // bidirectional search: the backward frontier grows from the destination,
+    // the g-ordered heaps give the smallest g-cost queued on every side
+    SearchArena backward_arena;
+    IndexedHeap forward_g_order;
+    IndexedHeap backward_g_order;
+    int meeting_cell = -1;
+    int best_meeting_cost;
+
+    // tables of the ALT heuristic
+    const Landmarks *landmarks = nullptr;
+
+    // HPA* answers the whole query inside StartSearch
+    const Hierarchy *hierarchy = nullptr;
+    SearchArena cluster_arena;
+    SearchArena abstract_arena;
+
+    // D* Lite keeps its plan after the search ends and repairs it on edits
+    IncrementalPlanner planner;
+
+    PathCache *path_cache = nullptr;
+    ExpansionTrace *trace = nullptr;
+
+    // cells that changed state during the last SearchStep
+    std::vector<int> step_opened;
+    std::vector<int> step_closed;
+    std::vector<int> step_backward_opened;
+    std::vector<int> step_backward_closed;
+    // queued cells of the expanded side whose g-cost dropped, kept for the trace
+    std::vector<int> step_reparented;
+
+    // octile, used by JPS and the bidirectional search
+    int Heuristic(int cell, int target) const;
+    bool OpenCell(SearchArena &side, int cell, int parent, int g_cost, int target, std::vector<int> &step_list);
+    template <class Estimate, class Moves, class Queue>
+    void AStarStep();
+    template <class Estimate, class Moves>
+    static StepFunction AStarStepFor(OpenList::Kind kind);
+    template <class Estimate>
+    static StepFunction AStarStepFor(SearchPolicy::Neighbourhood moves, OpenList::Kind kind);
+    static StepFunction AStarStepFor(SearchPolicy::Heuristic estimate, SearchPolicy::Neighbourhood moves, OpenList::Kind kind);
+    bool BeginSearch(int start_cell, int destination_cell);
+    void TakeStep();
+    void FinishSearch(bool is_found);
+    void JumpPointStep(int current);
+    void BidirectionalStep();
     void BuildPath();
+    void BuildBidirectionalPath();
+    void ResumeIncremental();
+    void StoreInCache();
 
 public:
     Searcher(const Grid *searched_grid);
     bool IsSearching() const;
-    void InitializePathCells();
-    void InitializeSearchCells();
+    bool PathFound() const;
+    Algorithm SelectedAlgorithm() const;
+    // takes effect from the next StartSearch. JPS needs uniform costs,
+    // A* runs in its place on grids with terrain costs
+    void SetAlgorithm(Algorithm searcher_algorithm);
+    OpenList::Kind OpenListKind() const;
+    // open list of the A* searches and of HPA*, drops the current search.
+    // D* Lite keeps its heap: its keys can go below the smallest queued one
+    void SetOpenList(OpenList::Kind kind);
+    // heuristic and moves of plain A*, take effect from the next StartSearch.
+    // The other algorithms keep the octile heuristic and the grid's moves.
+    // Manhattan overestimates diagonal moves, so with 8-connected moves its
+    // paths can be longer than the shortest one
+    SearchPolicy::Heuristic HeuristicKind() const;
+    void SetHeuristic(SearchPolicy::Heuristic estimate);
+    SearchPolicy::Neighbourhood NeighbourhoodKind() const;
+    void SetNeighbourhood(SearchPolicy::Neighbourhood moves);
+    // algorithm, open list and policies of another searcher
+    void CopySettings(const Searcher &other);
+    // used by Hierarchical_A_Star, must be built for the searched grid
+    // and must not change while a query runs
+    void SetHierarchy(const Hierarchy *grid_hierarchy);
+    // used by the Landmarks heuristic, A* runs with octile while they are
+    // not built for the searched grid. Same rules as the hierarchy
+    void SetLandmarks(const Landmarks *grid_landmarks);
+    // finished searches are stored in the cache and repeated queries are
+    // answered from it inside StartSearch. Results of different algorithms
+    // or policies must not share a cache
+    void SetPathCache(PathCache *cache);
+    // every search started from now on is recorded into the trace, nullptr
+    // stops recording. Repairs of D* Lite are not recorded
+    void SetTrace(ExpansionTrace *expansion_trace);
 
     void Reset();
-    void StartSearch();
+    // sizes the arenas of the selected algorithm to the grid, StartSearch
+    // does it lazily otherwise
+    void Preallocate();
+    bool StartSearch();
+    bool StartSearch(int start_cell, int destination_cell);
     void SearchStep();
-
-    void DrawPath() const;
-    void DrawClosedCells() const;
-    void DrawOpenedCells() const;
-};
\ No newline at end of file
+    void Search();
+
+    // true while the last search ran D* Lite and its plan can be repaired
+    bool IsRepairable() const;
+    // call after the cell was (un)blocked or its cost changed: a repairable
+    // search resumes and re-expands only what the edit changed, returns false
+    // if nothing resumed
+    bool CellChanged(int cell);
+    // the same after the start cell moved
+    bool MoveStart(int start_cell);
+
+    // cell indices from the first cell after the start to the last one
+    // before the destination
+    const std::vector<int>& Path() const;
+    // in fixed-point units, Grid::Straight_Cost per straight move on cost 1
+    int PathCost() const;
+    // cells taken from the open list, jump points in case of JPS
+    std::size_t ExpandedCount() const;
+    const std::vector<int>& StepOpened() const;
+    const std::vector<int>& StepClosed() const;
+    // backward frontier of the bidirectional search
+    const std::vector<int>& StepBackwardOpened() const;
+    const std::vector<int>& StepBackwardClosed() const;
+};
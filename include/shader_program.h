@@ -13,4 +13,11 @@ private:
 public:
     ShaderProgram(std::string vertex_shader_path, std::string fragment_shader_path);
     unsigned int ID() const;
+
+    // the program must be in use
+    void SetInt(const char *name, int value) const;
+    void SetFloat(const char *name, float value) const;
+    void SetVec2(const char *name, float x, float y) const;
+    void SetVec4(const char *name, const float *value) const;
+    void SetVec3Array(const char *name, const float *values, int count) const;
 };
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "instrumentation.h"
+#include "shader_program.h"
+
+// per-frame CPU and GPU time and the instrumentation counters as text in the
+// top left corner of the window. The text is drawn from a built-in 3x5 pixel
+// font with the overlay shader and rebuilt a few times per second only
+class StatsOverlay
+{
+private:
+    enum { Glyph_Width = 3, Glyph_Height = 5, Font_Scale = 2, Margin = 8 };
+
+    unsigned int text_vao;
+    unsigned int text_vbo;
+    std::size_t panel_vertices_count = 0; // the panel goes first in the vbo
+    std::size_t text_vertices_count = 0;
+
+    // GL_TIME_ELAPSED queries of the last two frames, a result is read one
+    // frame later so waiting for it never stalls the pipeline
+    unsigned int gpu_queries[2];
+    bool is_query_pending[2] = {false, false};
+    int query_index = 0;
+
+    std::uint64_t frame_begin_us = 0;
+    double cpu_us_sum = 0.0;
+    double gpu_us_sum = 0.0;
+    int cpu_frames = 0;
+    int gpu_frames = 0;
+
+    std::uint64_t last_update_us = 0;
+    std::uint64_t last_counters[Instrumentation::Counters_Count] = {};
+    std::uint64_t update_interval_us = 500000;
+
+    float panel_color[4] = {0.1f, 0.1f, 0.1f, 1.0f};
+    float text_color[4] = {0.95f, 0.95f, 0.95f, 1.0f};
+
+    void ReadGpuQuery(int index);
+    void UpdateText(std::uint64_t now_us);
+    void BuildText(const std::vector<std::string> &lines);
+
+public:
+    void Initialize();
+    // everything drawn between the two is measured
+    void BeginFrame();
+    void EndFrame();
+    void Draw(const ShaderProgram &shader) const;
+};
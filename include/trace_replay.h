@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "expansion_trace.h"
+
+// plays an expansion trace back at any speed. The state of every cell after
+// the applied steps is kept in one array, so a renderer can copy it in bulk
+// instead of replaying the steps one by one. Going forward decodes only the
+// new steps, going back rebuilds the states from the first step in one pass
+class TraceReplay
+{
+public:
+    // a later state is drawn over an earlier one, like in BoardRenderer
+    enum CellState : unsigned char
+    {
+        Unvisited = 0,
+        Opened,
+        Closed,
+        Backward_Opened,
+        Backward_Closed
+    };
+
+private:
+    const ExpansionTrace *trace;
+
+    std::vector<unsigned char> states;
+    std::vector<int> parents;
+    std::vector<int> changed_cells;
+    bool was_rebuilt = true;
+
+    std::size_t step = 0;
+    std::size_t offset = 0;
+    int previous_expanded = -1;
+    int last_expanded = -1;
+    ExpansionTrace::Step decoded;
+
+    void SetState(int cell, unsigned char state);
+
+public:
+    TraceReplay(const ExpansionTrace *replayed_trace);
+
+    // back to before the first step, call after the trace was recorded or loaded
+    void Rewind();
+    // applies steps until step_index of them are applied, past the end it
+    // stops at the last one
+    void Seek(std::size_t step_index);
+
+    // applied steps
+    std::size_t Step() const;
+    bool IsAtEnd() const;
+    // one per cell of the traced grid
+    const std::vector<unsigned char>& States() const;
+    // the cell expanded when the cell was last opened or re-parented, the
+    // parent the search held after the applied steps. -1 for the start, the
+    // destination of a bidirectional search, unvisited cells and D* Lite,
+    // which keeps no parents
+    int Parent(int cell) const;
+    // expanded by the last applied step, -1 if none
+    int LastExpanded() const;
+    // true if the last Rewind or Seek rebuilt the states, otherwise only
+    // ChangedCells differ from before it
+    bool WasRebuilt() const;
+    const std::vector<int>& ChangedCells() const;
+};
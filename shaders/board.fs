@@ -0,0 +1,91 @@
+#version 330 core
+
+// has to match BoardRenderer::CellState
+const int Blocked_State = 5;
+const int Start_State = 6;
+const int Destination_State = 7;
+const uint Path_First_State = 8u;
+// has to match BoardRenderer::Flow_Levels and Grid::Direction_Columns/Rows
+const float Flow_Levels = 31.0;
+const vec2 flow_directions[8] = vec2[8](vec2(-1.0, -1.0), vec2(-1.0, 0.0), vec2(-1.0, 1.0), vec2(0.0, -1.0),
+                                        vec2(0.0, 1.0), vec2(1.0, -1.0), vec2(1.0, 0.0), vec2(1.0, 1.0));
+
+uniform usampler2D states;
+uniform usampler2D costs;
+uniform usampler2D flows; // 0 or 1 + direction + 8 * distance level
+uniform vec3 palette[8];
+uniform vec3 heat_colors[2]; // lowest and highest terrain cost
+uniform float max_cost;
+uniform vec3 line_color;
+uniform vec2 grid_size;
+uniform float cell_pixels;
+uniform float show_lines;
+uniform vec3 flow_colors[2]; // destination and largest distance
+uniform vec3 arrow_color;
+uniform float show_flow;
+uniform float show_arrows;
+
+in vec2 world;
+out vec4 color;
+
+float SegmentDistance(vec2 point, vec2 a, vec2 b)
+{
+    vec2 ab = b - a;
+    float t = clamp(dot(point - a, ab) / dot(ab, ab), 0.0, 1.0);
+    return length(point - a - ab * t);
+}
+
+// distance from a point of the cell, centred on 0, to an arrow across it
+float ArrowDistance(vec2 point, vec2 direction)
+{
+    vec2 tip = direction * 0.35;
+    vec2 side = vec2(-direction.y, direction.x) * 0.15;
+    vec2 back = tip - direction * 0.2;
+    float shaft = SegmentDistance(point, -tip, tip);
+    return min(shaft, min(SegmentDistance(point, tip, back + side), SegmentDistance(point, tip, back - side)));
+}
+
+void main()
+{
+    vec3 cell_color = palette[0];
+    if (all(greaterThanEqual(world, vec2(0.0))) && all(lessThan(world, grid_size)))
+    {
+        ivec2 texel = ivec2(floor(world));
+        uint state = texelFetch(states, texel, 0).r;
+        uint cost = texelFetch(costs, texel, 0).r;
+        uint flow = show_flow > 0.5 ? texelFetch(flows, texel, 0).r : 0u;
+        if (state >= Path_First_State)
+        {
+            float delta = float(state - Path_First_State) / float(255u - Path_First_State);
+            cell_color = mix(palette[Start_State], palette[Destination_State], delta);
+        }
+        else if (state == 0u && flow > 0u)
+        {
+            float delta = float((flow - 1u) / 8u) / (Flow_Levels - 1.0);
+            cell_color = mix(flow_colors[0], flow_colors[1], delta);
+        }
+        else if (state == 0u && cost > 1u)
+        {
+            float delta = (float(cost) - 2.0) / max(max_cost - 2.0, 1.0);
+            cell_color = mix(heat_colors[0], heat_colors[1], delta);
+        }
+        else
+            cell_color = palette[int(state)];
+
+        if (show_arrows > 0.5 && flow > 0u && state < uint(Blocked_State))
+        {
+            vec2 direction = normalize(flow_directions[(flow - 1u) % 8u]);
+            if (ArrowDistance(fract(world) - 0.5, direction) < 0.05)
+                cell_color = arrow_color;
+        }
+    }
+
+    // one pixel wide lines on the cell borders, the outer ones included
+    float half_pixel = 0.5 / cell_pixels;
+    bool is_near_grid = all(greaterThan(world, vec2(-half_pixel))) && all(lessThan(world, grid_size + half_pixel));
+    vec2 to_line = abs(world - round(world));
+    if (show_lines > 0.5 && is_near_grid && min(to_line.x, to_line.y) < half_pixel)
+        cell_color = line_color;
+
+    color = vec4(cell_color, 1.0);
+}
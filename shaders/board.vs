@@ -0,0 +1,13 @@
+#version 330 core
+
+uniform vec4 view;
+
+out vec2 world;
+
+void main()
+{
+    // one triangle covering the whole window, made from the vertex id
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+    gl_Position = vec4(position, 0.0, 1.0);
+    world = (position - view.zw) / view.xy;
+}
@@ -1,9 +0,0 @@
-#version 330 core
-
-in vec3 v_color;
-out vec4 color;
-
-void main()
-{
-    color = vec4(v_color, 1.0);
-}
\ No newline at end of file
@@ -1,8 +0,0 @@
-#version 330 core
-
-out vec4 color;
-
-void main()
-{
-    color = vec4(0.2f, 0.2f, 0.2f, 1.0f);
-}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#version 330 core
+
+layout (location = 0) in vec2 position;
+
+uniform vec4 view;
+
+void main()
+{
+    gl_Position = vec4(position * view.xy + view.zw, 0.0, 1.0);
+}
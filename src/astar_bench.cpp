@@ -0,0 +1,293 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <cstdlib>
+#include <limits>
+
+#include "grid.h"
+#include "searcher.h"
+#include "hierarchy.h"
+#include "map_loader.h"
+
+// replays Moving AI scenario files and reports throughput, latency and how far
+// the paths are from the reference lengths of the scenarios. The references
+// are octile lengths without corner cutting, while the searcher prices a
+// diagonal step at 17/12 and by default may squeeze past one blocked corner,
+// so the error is measured on the octile length of the found path and can be
+// negative. --moves strict matches the rule of the scenarios.
+// With --costs the maps get random terrain costs, the error then only shows
+// how much longer the cheapest paths are
+
+struct BenchOptions
+{
+    Searcher::Algorithm algorithm = Searcher::A_Star;
+    OpenList::Kind open_list = OpenList::Binary_Heap;
+    SearchPolicy::Heuristic heuristic = SearchPolicy::Octile;
+    SearchPolicy::Neighbourhood neighbourhood = SearchPolicy::Eight_Connected;
+    int landmarks_count = Landmarks::Default_Count;
+    int max_cost = 1;
+    std::string maps_dir;
+};
+
+struct ScenarioStats
+{
+    std::size_t queries = 0;
+    std::size_t unsolved = 0;
+    std::size_t expanded = 0;
+    double seconds = 0.0;
+    std::vector<double> latencies_us;
+    // errors are negative for paths shorter than the reference
+    double error_sum = 0.0;
+    double min_error = std::numeric_limits<double>::infinity();
+    double max_error = -std::numeric_limits<double>::infinity();
+    std::size_t errors_count = 0;
+};
+
+// tries the map next to the scenario file first, as the scenario only holds the name
+std::string FindMap(const std::string &scenario_path, const std::string &maps_dir, const std::string &map_name)
+{
+    std::string base_name = map_name.substr(map_name.find_last_of("/\\") + 1);
+    std::string scenario_dir;
+    std::size_t slash = scenario_path.find_last_of("/\\");
+    if (slash != std::string::npos)
+        scenario_dir = scenario_path.substr(0, slash + 1);
+
+    std::vector<std::string> candidates;
+    if (!maps_dir.empty())
+        candidates.push_back(maps_dir + "/" + base_name);
+    candidates.push_back(scenario_dir + map_name);
+    candidates.push_back(scenario_dir + base_name);
+    candidates.push_back(map_name);
+
+    for (const std::string &candidate : candidates)
+    {
+        if (std::ifstream(candidate).good())
+            return candidate;
+    }
+    return candidates.front();
+}
+
+double OctileLength(const Grid &grid, int start, const std::vector<int> &path, int destination)
+{
+    double length = 0.0;
+    int previous = start;
+    for (std::size_t i = 0; i <= path.size(); i++)
+    {
+        int cell = i < path.size() ? path[i] : destination;
+        bool is_diagonal = grid.Column(cell) != grid.Column(previous) && grid.Row(cell) != grid.Row(previous);
+        length += is_diagonal ? std::sqrt(2.0) : 1.0;
+        previous = cell;
+    }
+    return start == destination ? 0.0 : length;
+}
+
+// same costs for every run of a map
+void PaintCosts(Grid &grid, int max_cost)
+{
+    std::vector<unsigned char> costs(grid.CellsCount());
+    std::mt19937 generator(grid.Width() * 7919 + grid.Height());
+    std::uniform_int_distribution<int> cost_distribution(1, max_cost);
+    for (unsigned char &cost : costs)
+        cost = cost_distribution(generator);
+    grid.SetCosts(costs);
+}
+
+bool RunScenario(const std::string &path, const BenchOptions &options, ScenarioStats &stats)
+{
+    std::vector<Scenario> scenarios;
+    if (!LoadMovingAiScenario(path, scenarios))
+        return false;
+
+    Grid grid;
+    Hierarchy hierarchy(&grid);
+    Landmarks landmarks(&grid);
+    landmarks.SetCount(options.landmarks_count);
+    Searcher searcher(&grid);
+    searcher.SetAlgorithm(options.algorithm);
+    searcher.SetOpenList(options.open_list);
+    searcher.SetHeuristic(options.heuristic);
+    searcher.SetNeighbourhood(options.neighbourhood);
+    searcher.SetHierarchy(&hierarchy);
+    searcher.SetLandmarks(&landmarks);
+
+    std::string loaded_map;
+    for (const Scenario &scenario : scenarios)
+    {
+        if (scenario.map_name != loaded_map)
+        {
+            if (!LoadMap(FindMap(path, options.maps_dir, scenario.map_name), grid))
+                return false;
+            if (options.max_cost > 1)
+                PaintCosts(grid, options.max_cost);
+            if (options.algorithm == Searcher::Hierarchical_A_Star)
+                hierarchy.Build();
+            if (options.heuristic == SearchPolicy::Landmarks)
+                landmarks.Update();
+            searcher.Preallocate();
+            loaded_map = scenario.map_name;
+        }
+
+        if (!grid.Contains(scenario.start_column, scenario.start_row) ||
+            !grid.Contains(scenario.destination_column, scenario.destination_row))
+        {
+            std::cout << "ERROR: SCENARIO OUTSIDE OF MAP " << scenario.map_name << std::endl;
+            return false;
+        }
+
+        int start = grid.Index(scenario.start_column, scenario.start_row);
+        int destination = grid.Index(scenario.destination_column, scenario.destination_row);
+
+        auto begin = std::chrono::steady_clock::now();
+        searcher.StartSearch(start, destination);
+        searcher.Search();
+        auto end = std::chrono::steady_clock::now();
+
+        double seconds = std::chrono::duration<double>(end - begin).count();
+        stats.queries++;
+        stats.seconds += seconds;
+        stats.expanded += searcher.ExpandedCount();
+        stats.latencies_us.push_back(seconds * 1e6);
+
+        if (!searcher.PathFound())
+        {
+            stats.unsolved++;
+            continue;
+        }
+
+        if (scenario.optimal_length > 0.0)
+        {
+            double length = OctileLength(grid, start, searcher.Path(), destination);
+            double error = (length - scenario.optimal_length) / scenario.optimal_length;
+            stats.error_sum += error;
+            stats.min_error = std::min(stats.min_error, error);
+            stats.max_error = std::max(stats.max_error, error);
+            stats.errors_count++;
+        }
+    }
+
+    return true;
+}
+
+void PrintStats(const std::string &name, ScenarioStats &stats)
+{
+    std::sort(stats.latencies_us.begin(), stats.latencies_us.end());
+    double mean_us = stats.queries > 0 ? stats.seconds * 1e6 / stats.queries : 0.0;
+    double p99_us = 0.0;
+    if (!stats.latencies_us.empty())
+        p99_us = stats.latencies_us[std::min(stats.latencies_us.size() - 1, stats.latencies_us.size() * 99 / 100)];
+
+    std::cout << std::left << std::setw(32) << name << std::right
+              << std::setw(9) << stats.queries
+              << std::setw(10) << stats.unsolved
+              << std::setw(14) << std::fixed << std::setprecision(0)
+              << (stats.seconds > 0.0 ? stats.expanded / stats.seconds : 0.0)
+              << std::setw(12) << std::setprecision(1) << mean_us
+              << std::setw(12) << p99_us
+              << std::setw(12) << std::setprecision(3)
+              << (stats.errors_count > 0 ? 100.0 * stats.error_sum / stats.errors_count : 0.0)
+              << std::setw(12) << (stats.errors_count > 0 ? 100.0 * stats.min_error : 0.0)
+              << std::setw(12) << (stats.errors_count > 0 ? 100.0 * stats.max_error : 0.0)
+              << std::endl;
+}
+
+// usage: astar_bench [--algorithm astar|jps|bidirectional|hpa|dstar] [--queue heap|buckets]
+//                    [--heuristic manhattan|octile|chebyshev|zero|alt] [--landmarks k] [--moves 4|8|strict]
+//                    [--costs max] [--maps dir] <scenario file>...
+// --costs paints every free cell with a terrain cost in [1, max], the landmark
+// tables are built once per map and not timed
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    std::vector<std::string> scenario_files;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--algorithm" && i + 1 < argc)
+        {
+            if (!Searcher::AlgorithmFromKey(argv[++i], options.algorithm))
+            {
+                std::cout << "ERROR: UNKNOWN ALGORITHM: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--queue" && i + 1 < argc)
+        {
+            if (!OpenList::KindFromKey(argv[++i], options.open_list))
+            {
+                std::cout << "ERROR: UNKNOWN QUEUE: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--heuristic" && i + 1 < argc)
+        {
+            if (!SearchPolicy::HeuristicFromKey(argv[++i], options.heuristic))
+            {
+                std::cout << "ERROR: UNKNOWN HEURISTIC: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--landmarks" && i + 1 < argc)
+            options.landmarks_count = std::max(std::atoi(argv[++i]), 1);
+        else if (arg == "--moves" && i + 1 < argc)
+        {
+            if (!SearchPolicy::NeighbourhoodFromKey(argv[++i], options.neighbourhood))
+            {
+                std::cout << "ERROR: UNKNOWN MOVES: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--costs" && i + 1 < argc)
+            options.max_cost = std::min(std::max(std::atoi(argv[++i]), 1), int(Grid::Max_Cost));
+        else if (arg == "--maps" && i + 1 < argc)
+            options.maps_dir = argv[++i];
+        else
+            scenario_files.push_back(arg);
+    }
+
+    if (scenario_files.empty())
+    {
+        std::cout << "USAGE: " << argv[0] << " [--algorithm astar|jps|bidirectional|hpa|dstar] [--queue heap|buckets] [--heuristic manhattan|octile|chebyshev|zero|alt] [--landmarks k] [--moves 4|8|strict] [--costs max] [--maps dir] <scenario file>..." << std::endl;
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(32) << "scenario" << std::right
+              << std::setw(9) << "queries"
+              << std::setw(10) << "unsolved"
+              << std::setw(14) << "expanded/s"
+              << std::setw(12) << "mean_us"
+              << std::setw(12) << "p99_us"
+              << std::setw(12) << "error_%"
+              << std::setw(12) << "min_err_%"
+              << std::setw(12) << "max_err_%" << std::endl;
+
+    ScenarioStats total;
+    for (const std::string &file : scenario_files)
+    {
+        ScenarioStats stats;
+        if (!RunScenario(file, options, stats))
+            return 1;
+
+        total.queries += stats.queries;
+        total.unsolved += stats.unsolved;
+        total.expanded += stats.expanded;
+        total.seconds += stats.seconds;
+        total.latencies_us.insert(total.latencies_us.end(), stats.latencies_us.begin(), stats.latencies_us.end());
+        total.error_sum += stats.error_sum;
+        total.min_error = std::min(total.min_error, stats.min_error);
+        total.max_error = std::max(total.max_error, stats.max_error);
+        total.errors_count += stats.errors_count;
+
+        PrintStats(file.substr(file.find_last_of("/\\") + 1), stats);
+    }
+
+    if (scenario_files.size() > 1)
+        PrintStats("total", total);
+
+    return 0;
+}
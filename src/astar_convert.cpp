@@ -0,0 +1,63 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <fstream>
+#include <chrono>
+
+#include "grid.h"
+#include "map_loader.h"
+#include "grid_file.h"
+
+// converts any map LoadMap reads into a binary grid file, then loads both
+// back and reports how long each load takes and whether they agree
+
+double Milliseconds(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// usage: astar_convert <map file> <grid file>
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        std::cout << "USAGE: " << argv[0] << " <map file> <grid file>" << std::endl;
+        return 1;
+    }
+
+    Grid grid;
+    auto begin = std::chrono::steady_clock::now();
+    if (!LoadMap(argv[1], grid))
+        return 1;
+    double map_ms = Milliseconds(begin);
+    if (!SaveGridFile(argv[2], grid))
+        return 1;
+
+    // into a grid of another size, as at startup, and again into one of the same size
+    Grid loaded;
+    begin = std::chrono::steady_clock::now();
+    if (!LoadGridFile(argv[2], loaded))
+        return 1;
+    double first_ms = Milliseconds(begin);
+    begin = std::chrono::steady_clock::now();
+    LoadGridFile(argv[2], loaded);
+    double reload_ms = Milliseconds(begin);
+    // the connected areas are labelled by the first query, not by the load
+    begin = std::chrono::steady_clock::now();
+    loaded.Component(0);
+    double labels_ms = Milliseconds(begin);
+
+    bool is_same = loaded.Width() == grid.Width() && loaded.Height() == grid.Height() &&
+                   loaded.BlockedBits() == grid.BlockedBits() && loaded.Costs() == grid.Costs() &&
+                   loaded.Start() == grid.Start() && loaded.Destination() == grid.Destination();
+    std::ifstream file(argv[2], std::ios::binary | std::ios::ate);
+    std::cout << grid.Width() << "x" << grid.Height() << ", " << file.tellg() << " bytes" << std::endl;
+    std::cout << std::fixed << std::setprecision(1) << "map load: " << map_ms << " ms, grid file load: " << first_ms
+              << " ms, reload: " << reload_ms << " ms, first area query: " << labels_ms << " ms" << std::endl;
+    if (!is_same)
+    {
+        std::cout << "ERROR: GRID FILE DOES NOT MATCH THE MAP" << std::endl;
+        return 1;
+    }
+    return 0;
+}
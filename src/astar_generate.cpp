@@ -0,0 +1,85 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+
+#include "grid.h"
+#include "grid_file.h"
+#include "map_generator.h"
+
+// writes a seeded procedural map as a grid file, which every tool and the
+// viewer open as a map. The same flags always give the same file
+
+double Milliseconds(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// usage: astar_generate [--kind random|backtracker|prim|rooms|caves] [--seed n] [--density d] [--threads n]
+//                       <width> <height> <grid file>
+int main(int argc, char **argv)
+{
+    MapGenerator generator;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--kind" && i + 1 < argc)
+        {
+            MapGenerator::Kind kind;
+            if (!MapGenerator::KindFromKey(argv[++i], kind))
+            {
+                std::cout << "ERROR: UNKNOWN MAP KIND: " << argv[i] << std::endl;
+                return 1;
+            }
+            generator.SetKind(kind);
+        }
+        else if (arg == "--seed" && i + 1 < argc)
+            generator.SetSeed(std::strtoull(argv[++i], nullptr, 10));
+        else if (arg == "--density" && i + 1 < argc)
+            generator.SetDensity(std::atof(argv[++i]));
+        else if (arg == "--threads" && i + 1 < argc)
+            generator.SetThreadsCount(std::max(std::atoi(argv[++i]), 0));
+        else
+            args.push_back(arg);
+    }
+
+    if (args.size() != 3)
+    {
+        std::cout << "USAGE: " << argv[0] << " [--kind random|backtracker|prim|rooms|caves] [--seed n] [--density d] [--threads n] <width> <height> <grid file>" << std::endl;
+        return 1;
+    }
+
+    int width = std::atoi(args[0].c_str());
+    int height = std::atoi(args[1].c_str());
+    if (width < 1 || height < 1 || width > G_Max_Side || height > G_Max_Side)
+    {
+        std::cout << "ERROR: GRID SIDES MUST BE IN [1, " << G_Max_Side << "]" << std::endl;
+        return 1;
+    }
+
+    Grid grid(width, height);
+    auto begin = std::chrono::steady_clock::now();
+    generator.Generate(grid);
+    double generate_ms = Milliseconds(begin);
+    if (!SaveGridFile(args[2], grid))
+        return 1;
+
+    std::size_t free_count = 0;
+    std::size_t largest_area = 0;
+    for (std::size_t cell = 0; cell < grid.CellsCount(); cell++)
+    {
+        if (!grid.IsFree(int(cell)))
+            continue;
+        free_count++;
+        largest_area = std::max(largest_area, grid.ComponentSize(int(cell)));
+    }
+    std::cout << MapGenerator::KindName(generator.GetKind()) << " " << width << "x" << height << ", seed " << generator.Seed()
+              << std::fixed << std::setprecision(1) << ": " << 100.0 * (grid.CellsCount() - free_count) / grid.CellsCount()
+              << "% blocked, largest area " << 100.0 * largest_area / std::max<std::size_t>(free_count, 1) << "% of free cells"
+              << ", generated in " << generate_ms << " ms" << std::endl;
+    return 0;
+}
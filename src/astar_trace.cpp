@@ -0,0 +1,191 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+#include "grid.h"
+#include "searcher.h"
+#include "map_loader.h"
+#include "expansion_trace.h"
+#include "trace_replay.h"
+
+// records one search into an expansion trace file, or reads a trace back:
+// its query and result, how compact it is and how fast it replays. Trace
+// files carry their grid, so a slow search can be shared as a single file
+
+// a trace without packing: every expanded cell and every opened or
+// re-parented cell with its parent as 4-byte integers
+std::size_t UnpackedBytes(const ExpansionTrace &trace)
+{
+    std::size_t bytes = 0;
+    std::size_t offset = 0;
+    int previous_expanded = trace.Start();
+    ExpansionTrace::Step step;
+    while (trace.DecodeStep(offset, previous_expanded, step))
+        bytes += 4 + (step.opened.size() + step.reparented.size()) * 8;
+    return bytes;
+}
+
+double Milliseconds(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int Record(const std::vector<std::string> &args, Searcher::Algorithm algorithm, SearchPolicy::Heuristic heuristic,
+           SearchPolicy::Neighbourhood neighbourhood)
+{
+    Grid grid;
+    if (!LoadMap(args[0], grid))
+        return 1;
+
+    int cells[4];
+    for (int i = 0; i < 4; i++)
+        cells[i] = std::atoi(args[i + 1].c_str());
+    if (!grid.Contains(cells[0], cells[1]) || !grid.Contains(cells[2], cells[3]))
+    {
+        std::cout << "ERROR: START OR DESTINATION OUTSIDE OF THE GRID" << std::endl;
+        return 1;
+    }
+    int start = grid.Index(cells[0], cells[1]);
+    int destination = grid.Index(cells[2], cells[3]);
+    // such a search has nothing worth replaying
+    if (!grid.IsFree(start) || !grid.IsFree(destination))
+    {
+        std::cout << "ERROR: START OR DESTINATION IS BLOCKED" << std::endl;
+        return 1;
+    }
+    if (!grid.AreConnected(start, destination))
+    {
+        std::cout << "ERROR: START AND DESTINATION ARE NOT CONNECTED" << std::endl;
+        return 1;
+    }
+
+    Hierarchy hierarchy(&grid);
+    if (algorithm == Searcher::Hierarchical_A_Star)
+        hierarchy.Build();
+    Landmarks landmarks(&grid);
+    if (heuristic == SearchPolicy::Landmarks)
+        landmarks.Update();
+
+    ExpansionTrace trace;
+    Searcher searcher(&grid);
+    searcher.SetAlgorithm(algorithm);
+    searcher.SetHeuristic(heuristic);
+    searcher.SetNeighbourhood(neighbourhood);
+    searcher.SetHierarchy(&hierarchy);
+    searcher.SetLandmarks(&landmarks);
+    searcher.SetTrace(&trace);
+
+    auto begin = std::chrono::steady_clock::now();
+    searcher.StartSearch(start, destination);
+    searcher.Search();
+    double search_ms = Milliseconds(begin);
+    if (!trace.Save(args[5]))
+        return 1;
+
+    std::cout << "steps: " << trace.StepsCount() << ", " << trace.StepsBytes() << " bytes ("
+              << std::fixed << std::setprecision(2) << double(trace.StepsBytes()) / std::max<std::size_t>(trace.StepsCount(), 1)
+              << " per step, " << UnpackedBytes(trace) << " unpacked), search with recording " << search_ms << " ms" << std::endl;
+    return 0;
+}
+
+int Inspect(const std::string &path, long long step)
+{
+    ExpansionTrace trace;
+    if (!trace.Load(path))
+        return 1;
+
+    std::cout << "grid: " << trace.Width() << "x" << trace.Height() << ", algorithm: "
+              << Searcher::AlgorithmKey(Searcher::Algorithm(trace.AlgorithmIndex())) << std::endl;
+    std::cout << "query: " << trace.Start() % trace.Width() << "," << trace.Start() / trace.Width() << " -> "
+              << trace.Destination() % trace.Width() << "," << trace.Destination() / trace.Width() << std::endl;
+    if (trace.PathFound())
+        std::cout << "path cost: " << double(trace.PathCost()) / Grid::Straight_Cost << ", path cells: " << trace.Path().size() << std::endl;
+    else
+        std::cout << "no path" << std::endl;
+    std::cout << "steps: " << trace.StepsCount() << ", " << trace.StepsBytes() << " bytes, "
+              << UnpackedBytes(trace) << " unpacked" << std::endl;
+
+    // the whole trace from the start, then back to the asked step, which rebuilds from the start again
+    TraceReplay replay(&trace);
+    auto begin = std::chrono::steady_clock::now();
+    replay.Seek(trace.StepsCount());
+    double end_ms = Milliseconds(begin);
+    std::size_t target = step >= 0 ? std::size_t(step) : trace.StepsCount() / 2;
+    begin = std::chrono::steady_clock::now();
+    replay.Seek(target);
+    double seek_ms = Milliseconds(begin);
+    std::cout << std::fixed << std::setprecision(3) << "replay to the end: " << end_ms << " ms, seek back to step "
+              << replay.Step() << ": " << seek_ms << " ms" << std::endl;
+
+    std::size_t counts[5] = {};
+    for (unsigned char state : replay.States())
+        counts[state]++;
+    std::cout << "at step " << replay.Step() << ": " << counts[TraceReplay::Opened] << " opened, "
+              << counts[TraceReplay::Closed] << " closed, " << counts[TraceReplay::Backward_Opened] << " backward opened, "
+              << counts[TraceReplay::Backward_Closed] << " backward closed";
+    int expanded = replay.LastExpanded();
+    if (expanded != -1)
+    {
+        std::cout << ", last expanded " << expanded % trace.Width() << "," << expanded / trace.Width();
+        int parent = replay.Parent(expanded);
+        if (parent != -1)
+            std::cout << " from " << parent % trace.Width() << "," << parent / trace.Width();
+    }
+    std::cout << std::endl;
+    return 0;
+}
+
+// usage: astar_trace record [--algorithm astar|jps|bidirectional|hpa|dstar]
+//                           [--heuristic manhattan|octile|chebyshev|zero|alt] [--moves 4|8|strict]
+//                           <map file> <start_column> <start_row> <destination_column> <destination_row> <trace file>
+//        astar_trace info <trace file> [step]
+// info replays to the step, the middle one by default
+int main(int argc, char **argv)
+{
+    Searcher::Algorithm algorithm = Searcher::A_Star;
+    SearchPolicy::Heuristic heuristic = SearchPolicy::Octile;
+    SearchPolicy::Neighbourhood neighbourhood = SearchPolicy::Eight_Connected;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--algorithm" && i + 1 < argc)
+        {
+            if (!Searcher::AlgorithmFromKey(argv[++i], algorithm))
+            {
+                std::cout << "ERROR: UNKNOWN ALGORITHM: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--heuristic" && i + 1 < argc)
+        {
+            if (!SearchPolicy::HeuristicFromKey(argv[++i], heuristic))
+            {
+                std::cout << "ERROR: UNKNOWN HEURISTIC: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--moves" && i + 1 < argc)
+        {
+            if (!SearchPolicy::NeighbourhoodFromKey(argv[++i], neighbourhood))
+            {
+                std::cout << "ERROR: UNKNOWN MOVES: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else
+            args.push_back(arg);
+    }
+
+    if (args.size() == 7 && args[0] == "record")
+        return Record(std::vector<std::string>(args.begin() + 1, args.end()), algorithm, heuristic, neighbourhood);
+    if ((args.size() == 2 || args.size() == 3) && args[0] == "info")
+        return Inspect(args[1], args.size() == 3 ? std::atoll(args[2].c_str()) : -1);
+
+    std::cout << "USAGE: " << argv[0] << " record [--algorithm astar|jps|bidirectional|hpa|dstar] [--heuristic manhattan|octile|chebyshev|zero|alt] [--moves 4|8|strict] <map file> <start_column> <start_row> <destination_column> <destination_row> <trace file>" << std::endl;
+    std::cout << "       " << argv[0] << " info <trace file> [step]" << std::endl;
+    return 1;
+}
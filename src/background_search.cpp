@@ -0,0 +1,231 @@
+#include "background_search.h"
+#include <algorithm>
+
+BackgroundSearch::BackgroundSearch()
+    : hierarchy(&snapshot), landmarks(&snapshot), searcher(&snapshot)
+{
+    searcher.SetHierarchy(&hierarchy);
+    searcher.SetLandmarks(&landmarks);
+}
+
+BackgroundSearch::~BackgroundSearch()
+{
+    Cancel();
+}
+
+bool BackgroundSearch::Start(const Grid &grid, const Searcher &settings, bool is_recording)
+{
+    Cancel();
+    if (grid.Start() == -1 || grid.Destination() == -1)
+        return false;
+
+    // the copy is made here, so the caller can keep editing its grid
+    CopyGrid(grid);
+    searcher.CopySettings(settings);
+    is_recording_steps = is_recording;
+    is_finished = false;
+    is_active = true;
+
+    worker = std::thread(&BackgroundSearch::Run, this);
+    return true;
+}
+
+void BackgroundSearch::CopyGrid(const Grid &grid)
+{
+    // the worker is joined, so the snapshot can be read here
+    copy_start = grid.Start();
+    copy_destination = grid.Destination();
+    edits.clear();
+    is_full_copy = &grid != source || grid.Width() != snapshot.Width() || grid.Height() != snapshot.Height();
+
+    // a cell differs from the snapshot only in a region edited since the
+    // last copy. Past a sixteenth of the grid one rebuild is cheaper than
+    // updating cell by cell
+    std::size_t edited_regions = 0;
+    for (int j = 0; j < grid.RegionsRows() && !is_full_copy && grid.Version() != synced_version; j++)
+        for (int i = 0; i < grid.RegionsColumns(); i++)
+            edited_regions += grid.RegionVersion(i, j) > synced_version;
+    is_full_copy = is_full_copy || edited_regions * Grid::Region_Side * Grid::Region_Side > grid.CellsCount() / 16;
+
+    for (int j = 0; j < grid.RegionsRows() && !is_full_copy && edited_regions > 0; j++)
+    {
+        for (int i = 0; i < grid.RegionsColumns(); i++)
+        {
+            if (grid.RegionVersion(i, j) <= synced_version)
+                continue;
+
+            int last_column = std::min((i + 1) * Grid::Region_Side, grid.Width());
+            int last_row = std::min((j + 1) * Grid::Region_Side, grid.Height());
+            for (int row = j * Grid::Region_Side; row < last_row; row++)
+            {
+                for (int column = i * Grid::Region_Side; column < last_column; column++)
+                {
+                    int cell = grid.Index(column, row);
+                    if (grid.IsFree(cell) != snapshot.IsFree(cell) || grid.Cost(cell) != snapshot.Cost(cell))
+                        edits.push_back({cell, !grid.IsFree(cell), (unsigned char)grid.Cost(cell)});
+                }
+            }
+        }
+    }
+
+    if (is_full_copy)
+    {
+        edits.clear();
+        copy_width = grid.Width();
+        copy_height = grid.Height();
+        copy_blocked = grid.BlockedBits();
+        if (grid.HasUniformCosts())
+            copy_costs.clear();
+        else
+            copy_costs = grid.Costs();
+    }
+    source = &grid;
+    synced_version = grid.Version();
+}
+
+void BackgroundSearch::ApplyCopy()
+{
+    if (is_full_copy)
+    {
+        snapshot.Resize(copy_width, copy_height, copy_blocked.data());
+        if (!copy_costs.empty())
+            snapshot.SetCosts(copy_costs);
+        is_full_copy = false;
+    }
+
+    for (const CellEdit &edit : edits)
+    {
+        if (edit.is_blocked)
+            snapshot.PlaceBlockedCell(edit.cell);
+        else
+            snapshot.RemoveBlockedCell(edit.cell);
+        snapshot.SetCost(edit.cell, edit.cost);
+    }
+    edits.clear();
+
+    snapshot.SetStartCell(copy_start);
+    snapshot.SetDestinationCell(copy_destination);
+}
+
+void BackgroundSearch::SetPlacedLandmarks(const std::vector<int> &landmark_cells)
+{
+    Cancel();
+    // the tables are only dropped when the cells change
+    if (landmark_cells != landmarks.PlacedCells())
+        landmarks.SetPlacedCells(landmark_cells);
+}
+
+void BackgroundSearch::Cancel()
+{
+    if (worker.joinable())
+    {
+        is_cancelled = true;
+        worker.join();
+        is_cancelled = false;
+    }
+
+    published.clear();
+    is_finished = false;
+    is_active = false;
+}
+
+bool BackgroundSearch::IsActive() const
+{
+    return is_active;
+}
+
+void BackgroundSearch::Publish(StepBatch &batch)
+{
+    std::lock_guard<std::mutex> lock(batches_mutex);
+    published.push_back(std::move(batch));
+    batch = StepBatch();
+}
+
+void BackgroundSearch::Run()
+{
+    // applied even if cancelled, the next copy only holds the later edits
+    ApplyCopy();
+
+    // the hierarchy of the snapshot is built on the worker as well
+    if (searcher.SelectedAlgorithm() == Searcher::Hierarchical_A_Star &&
+        (!hierarchy.IsBuilt() || hierarchy_version != snapshot.Version()))
+    {
+        hierarchy.Build();
+        hierarchy_version = snapshot.Version();
+    }
+    // the landmarks keep track of the grid version themselves
+    if (searcher.HeuristicKind() == SearchPolicy::Landmarks)
+        landmarks.Update();
+
+    StepBatch batch;
+    std::size_t batch_steps = 0;
+    if (!is_cancelled)
+        searcher.StartSearch(snapshot.Start(), snapshot.Destination());
+
+    while (searcher.IsSearching() && !is_cancelled)
+    {
+        searcher.SearchStep();
+        if (!is_recording_steps)
+            continue;
+
+        batch.opened.insert(batch.opened.end(), searcher.StepOpened().begin(), searcher.StepOpened().end());
+        batch.closed.insert(batch.closed.end(), searcher.StepClosed().begin(), searcher.StepClosed().end());
+        batch.backward_opened.insert(batch.backward_opened.end(),
+                                     searcher.StepBackwardOpened().begin(), searcher.StepBackwardOpened().end());
+        batch.backward_closed.insert(batch.backward_closed.end(),
+                                     searcher.StepBackwardClosed().begin(), searcher.StepBackwardClosed().end());
+
+        if (++batch_steps == Steps_Per_Batch)
+        {
+            Publish(batch);
+            batch_steps = 0;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(batches_mutex);
+    if (batch_steps > 0)
+        published.push_back(std::move(batch));
+    is_finished = true;
+}
+
+bool BackgroundSearch::TakeBatches(std::vector<StepBatch> &batches)
+{
+    if (!is_active)
+        return false;
+
+    bool is_done;
+    {
+        std::lock_guard<std::mutex> lock(batches_mutex);
+        for (StepBatch &batch : published)
+            batches.push_back(std::move(batch));
+        published.clear();
+        is_done = is_finished;
+    }
+
+    if (!is_done)
+        return false;
+
+    worker.join();
+    is_active = false;
+    return true;
+}
+
+bool BackgroundSearch::PathFound() const
+{
+    return searcher.PathFound();
+}
+
+const std::vector<int>& BackgroundSearch::Path() const
+{
+    return searcher.Path();
+}
+
+int BackgroundSearch::PathCost() const
+{
+    return searcher.PathCost();
+}
+
+std::size_t BackgroundSearch::ExpandedCount() const
+{
+    return searcher.ExpandedCount();
+}
@@ -0,0 +1,232 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+#include "grid.h"
+#include "searcher.h"
+#include "batch_runner.h"
+#include "hierarchy.h"
+#include "map_loader.h"
+#include "flow_field.h"
+#include "instrumentation.h"
+
+bool ParseAlgorithm(const std::string &name, Searcher::Algorithm &algorithm)
+{
+    if (Searcher::AlgorithmFromKey(name, algorithm))
+        return true;
+
+    std::cout << "ERROR: UNKNOWN ALGORITHM: " << name << std::endl;
+    return false;
+}
+
+// builds one flow field per distinct destination and walks it from every start of
+// that destination. The build is counted in the first query of the destination
+void AnswerWithFlowFields(const Grid &grid, const std::vector<PathQuery> &queries, std::vector<PathResult> &results)
+{
+    std::vector<std::size_t> order(queries.size());
+    for (std::size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&queries](std::size_t a, std::size_t b)
+    {
+        return queries[a].destination < queries[b].destination;
+    });
+
+    FlowField field(&grid);
+    std::vector<int> path;
+    int destination = -1;
+    for (std::size_t query : order)
+    {
+        const PathQuery &q = queries[query];
+        PathResult &result = results[query];
+        if (q.start < 0 || q.destination < 0 || !grid.IsFree(q.start) || !grid.IsFree(q.destination))
+            continue;
+
+        auto begin = std::chrono::steady_clock::now();
+        bool is_new_destination = q.destination != destination;
+        if (is_new_destination)
+        {
+            destination = q.destination;
+            field.SetDestination(destination);
+            field.Update();
+        }
+        result.found = field.Path(q.start, path);
+        auto end = std::chrono::steady_clock::now();
+
+        result.is_valid = true;
+        result.cost = result.found ? field.Distance(q.start) : 0;
+        result.path_cells = path.size();
+        result.expanded = is_new_destination ? field.SettledCount() : 0;
+        result.microseconds = std::chrono::duration<double, std::micro>(end - begin).count();
+    }
+}
+
+// usage: astar_batch [--algorithm astar|jps|bidirectional|hpa|dstar] [--queue heap|buckets]
+//                    [--heuristic manhattan|octile|chebyshev|zero|alt] [--landmarks k] [--moves 4|8|strict]
+//                    [--threads n] [--cache n] [--flow] [--trace file] <map file> <queries file>
+// every line of the queries file holds "start_column start_row destination_column destination_row",
+// --queue picks the open list, --heuristic and --moves the policies of plain A*,
+// --landmarks the number of landmarks of alt,
+// --threads 0 (the default) uses every hardware thread,
+// --cache n keeps the last n results, --flow answers the queries from one flow field per
+// destination on this thread instead of searching (8-connected moves),
+// --trace writes the queries of every worker as Chrome trace events
+int main(int argc, char **argv)
+{
+    Searcher::Algorithm algorithm = Searcher::A_Star;
+    OpenList::Kind open_list = OpenList::Binary_Heap;
+    SearchPolicy::Heuristic heuristic = SearchPolicy::Octile;
+    SearchPolicy::Neighbourhood neighbourhood = SearchPolicy::Eight_Connected;
+    int landmarks_count = Landmarks::Default_Count;
+    unsigned int threads_count = 0;
+    std::size_t cache_capacity = 0;
+    bool is_flow = false;
+    std::string trace_path;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--algorithm" && i + 1 < argc)
+        {
+            if (!ParseAlgorithm(argv[++i], algorithm))
+                return 1;
+        }
+        else if (arg == "--queue" && i + 1 < argc)
+        {
+            if (!OpenList::KindFromKey(argv[++i], open_list))
+            {
+                std::cout << "ERROR: UNKNOWN QUEUE: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--heuristic" && i + 1 < argc)
+        {
+            if (!SearchPolicy::HeuristicFromKey(argv[++i], heuristic))
+            {
+                std::cout << "ERROR: UNKNOWN HEURISTIC: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--landmarks" && i + 1 < argc)
+            landmarks_count = std::stoi(argv[++i]);
+        else if (arg == "--moves" && i + 1 < argc)
+        {
+            if (!SearchPolicy::NeighbourhoodFromKey(argv[++i], neighbourhood))
+            {
+                std::cout << "ERROR: UNKNOWN MOVES: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+            threads_count = std::stoul(argv[++i]);
+        else if (arg == "--cache" && i + 1 < argc)
+            cache_capacity = std::stoul(argv[++i]);
+        else if (arg == "--flow")
+            is_flow = true;
+        else if (arg == "--trace" && i + 1 < argc)
+            trace_path = argv[++i];
+        else
+            files.push_back(arg);
+    }
+
+    if (files.size() != 2)
+    {
+        std::cout << "USAGE: " << argv[0] << " [--algorithm astar|jps|bidirectional|hpa|dstar] [--queue heap|buckets] [--heuristic manhattan|octile|chebyshev|zero|alt] [--landmarks k] [--moves 4|8|strict] [--threads n] [--cache n] [--flow] [--trace file] <map file> <queries file>" << std::endl;
+        return 1;
+    }
+
+    if (!trace_path.empty())
+        Instrumentation::StartTrace();
+
+    Grid grid;
+    if (!LoadMap(files[0], grid))
+        return 1;
+
+    std::ifstream queries_file(files[1]);
+    if (!queries_file.is_open())
+    {
+        std::cout << "ERROR: FAILED TO OPEN QUERIES FILE: " << files[1] << std::endl;
+        return 1;
+    }
+
+    struct QueryLine
+    {
+        int sx, sy, dx, dy;
+    };
+    std::vector<QueryLine> lines;
+    std::vector<PathQuery> queries;
+
+    QueryLine line;
+    while (queries_file >> line.sx >> line.sy >> line.dx >> line.dy)
+    {
+        lines.push_back(line);
+        // out of bounds cells are passed as -1 and come back invalid
+        queries.push_back({grid.Contains(line.sx, line.sy) ? grid.Index(line.sx, line.sy) : -1,
+                           grid.Contains(line.dx, line.dy) ? grid.Index(line.dx, line.dy) : -1});
+    }
+
+    Hierarchy hierarchy(&grid);
+    if (algorithm == Searcher::Hierarchical_A_Star)
+        hierarchy.Build();
+
+    Landmarks landmarks(&grid);
+    if (heuristic == SearchPolicy::Landmarks)
+    {
+        landmarks.SetCount(landmarks_count);
+        landmarks.Update(threads_count);
+    }
+
+    std::vector<PathResult> results(queries.size());
+    PathCache cache(&grid, cache_capacity);
+    if (is_flow)
+        AnswerWithFlowFields(grid, queries, results);
+    else
+    {
+        BatchRunner runner(&grid, threads_count, algorithm, &hierarchy);
+        runner.SetOpenList(open_list);
+        runner.SetHeuristic(heuristic);
+        runner.SetNeighbourhood(neighbourhood);
+        runner.SetLandmarks(&landmarks);
+        if (cache_capacity > 0)
+            runner.SetPathCache(&cache);
+        runner.Run(queries.data(), queries.size(), results.data());
+    }
+
+    std::cout << "query\tstart\tdestination\tfound\tpath_cost\tpath_cells\texpanded\ttime_us" << std::endl;
+
+    for (std::size_t query = 0; query < results.size(); query++)
+    {
+        const QueryLine &q = lines[query];
+        const PathResult &result = results[query];
+        std::cout << query << '\t' << q.sx << ',' << q.sy << '\t' << q.dx << ',' << q.dy << '\t';
+
+        if (!result.is_valid)
+        {
+            std::cout << "invalid" << std::endl;
+            continue;
+        }
+
+        std::cout << (result.found ? "yes" : "no") << '\t'
+                  << result.cost << '\t'
+                  << result.path_cells << '\t'
+                  << result.expanded << '\t'
+                  << (long long)result.microseconds
+                  << std::endl;
+    }
+
+    // on stderr, so the table stays easy to parse
+    if (cache_capacity > 0)
+        std::cerr << "cache: " << cache.Hits() << " hits, " << cache.Misses() << " misses, "
+                  << cache.Evictions() << " evictions" << std::endl;
+
+    if (!trace_path.empty())
+    {
+        Instrumentation::RecordCounters();
+        if (!Instrumentation::WriteTrace(trace_path))
+            return 1;
+    }
+
+    return 0;
+}
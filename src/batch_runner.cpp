@@ -0,0 +1,183 @@
+#include "batch_runner.h"
+#include <algorithm>
+#include <chrono>
+#include "instrumentation.h"
+
+BatchRunner::BatchRunner(const Grid *searched_grid, unsigned int threads_count, Searcher::Algorithm algorithm,
+                         const Hierarchy *hierarchy)
+{
+    grid = searched_grid;
+
+    if (threads_count == 0)
+        threads_count = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned int i = 0; i < threads_count; i++)
+    {
+        workers.push_back(std::make_unique<Worker>());
+        workers.back()->searcher = std::make_unique<Searcher>(grid);
+        workers.back()->searcher->SetAlgorithm(algorithm);
+        workers.back()->searcher->SetHierarchy(hierarchy);
+        workers.back()->searcher->Preallocate();
+    }
+
+    for (unsigned int i = 0; i < threads_count; i++)
+        threads.emplace_back(&BatchRunner::WorkerLoop, this, i);
+}
+
+BatchRunner::~BatchRunner()
+{
+    {
+        std::lock_guard<std::mutex> lock(batch_mutex);
+        is_stopping = true;
+    }
+    batch_started.notify_all();
+
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+std::size_t BatchRunner::ThreadsCount() const
+{
+    return threads.size();
+}
+
+void BatchRunner::SetPathCache(PathCache *cache)
+{
+    for (std::unique_ptr<Worker> &worker : workers)
+        worker->searcher->SetPathCache(cache);
+}
+
+void BatchRunner::SetOpenList(OpenList::Kind kind)
+{
+    for (std::unique_ptr<Worker> &worker : workers)
+        worker->searcher->SetOpenList(kind);
+}
+
+void BatchRunner::SetHeuristic(SearchPolicy::Heuristic heuristic)
+{
+    for (std::unique_ptr<Worker> &worker : workers)
+        worker->searcher->SetHeuristic(heuristic);
+}
+
+void BatchRunner::SetNeighbourhood(SearchPolicy::Neighbourhood neighbourhood)
+{
+    for (std::unique_ptr<Worker> &worker : workers)
+        worker->searcher->SetNeighbourhood(neighbourhood);
+}
+
+void BatchRunner::SetLandmarks(const Landmarks *landmarks)
+{
+    for (std::unique_ptr<Worker> &worker : workers)
+        worker->searcher->SetLandmarks(landmarks);
+}
+
+void BatchRunner::Run(const PathQuery *batch_queries, std::size_t count, PathResult *batch_results)
+{
+    if (count == 0)
+        return;
+
+    // several chunks per worker, so there is something left to steal when
+    // some queries turn out much more expensive than others
+    std::size_t chunk_size = std::max<std::size_t>(1, count / (workers.size() * 8));
+
+    std::unique_lock<std::mutex> lock(batch_mutex);
+    queries = batch_queries;
+    results = batch_results;
+    pending_chunks = 0;
+
+    std::size_t worker_index = 0;
+    for (std::size_t begin = 0; begin < count; begin += chunk_size)
+    {
+        Worker &worker = *workers[worker_index];
+        std::lock_guard<std::mutex> chunks_lock(worker.chunks_mutex);
+        worker.chunks.push_back({begin, std::min(count, begin + chunk_size)});
+
+        pending_chunks++;
+        worker_index = (worker_index + 1) % workers.size();
+    }
+
+    batch_id++;
+    batch_started.notify_all();
+    batch_finished.wait(lock, [this] { return pending_chunks == 0; });
+}
+
+bool BatchRunner::TakeChunk(std::size_t worker_index, Chunk &chunk)
+{
+    {
+        Worker &own = *workers[worker_index];
+        std::lock_guard<std::mutex> lock(own.chunks_mutex);
+        if (!own.chunks.empty())
+        {
+            chunk = own.chunks.front();
+            own.chunks.pop_front();
+            return true;
+        }
+    }
+
+    for (std::size_t i = 1; i < workers.size(); i++)
+    {
+        Worker &victim = *workers[(worker_index + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.chunks_mutex);
+        if (!victim.chunks.empty())
+        {
+            chunk = victim.chunks.back();
+            victim.chunks.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void BatchRunner::RunQuery(Searcher &searcher, std::size_t query_index)
+{
+    ASTAR_SCOPED_TIMER("query");
+    const PathQuery &query = queries[query_index];
+    PathResult &result = results[query_index];
+    result = PathResult();
+
+    if (query.start < 0 || query.destination < 0 ||
+        std::size_t(query.start) >= grid->CellsCount() || std::size_t(query.destination) >= grid->CellsCount() ||
+        !grid->IsFree(query.start) || !grid->IsFree(query.destination))
+        return;
+
+    auto begin = std::chrono::steady_clock::now();
+    searcher.StartSearch(query.start, query.destination);
+    searcher.Search();
+    auto end = std::chrono::steady_clock::now();
+
+    result.is_valid = true;
+    result.found = searcher.PathFound();
+    result.cost = searcher.PathCost();
+    result.path_cells = searcher.Path().size();
+    result.expanded = searcher.ExpandedCount();
+    result.microseconds = std::chrono::duration<double, std::micro>(end - begin).count();
+}
+
+void BatchRunner::WorkerLoop(std::size_t worker_index)
+{
+    Searcher &searcher = *workers[worker_index]->searcher;
+    unsigned long seen_batch = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(batch_mutex);
+            batch_started.wait(lock, [this, seen_batch] { return is_stopping || batch_id != seen_batch; });
+            if (is_stopping)
+                return;
+            seen_batch = batch_id;
+        }
+
+        Chunk chunk;
+        while (TakeChunk(worker_index, chunk))
+        {
+            for (std::size_t i = chunk.begin; i < chunk.end; i++)
+                RunQuery(searcher, i);
+
+            std::lock_guard<std::mutex> lock(batch_mutex);
+            if (--pending_chunks == 0)
+                batch_finished.notify_all();
+        }
+    }
+}
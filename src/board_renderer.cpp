@@ -0,0 +1,382 @@
+#include "board_renderer.h"
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+#include "glad/glad.h"
+#include "instrumentation.h"
+
+void BoardRenderer::DirtyRows::Reset(int height)
+{
+    first_column.assign(height, -1);
+    last_column.assign(height, -1);
+    rows.clear();
+    is_all = true;
+}
+
+void BoardRenderer::DirtyRows::Mark(int column, int row)
+{
+    if (is_all)
+        return;
+
+    if (first_column[row] == -1)
+    {
+        rows.push_back(row);
+        first_column[row] = last_column[row] = column;
+    }
+    else if (column < first_column[row])
+        first_column[row] = column;
+    else if (column > last_column[row])
+        last_column[row] = column;
+}
+
+void BoardRenderer::DirtyRows::Clear()
+{
+    for (int row : rows)
+        first_column[row] = last_column[row] = -1;
+    rows.clear();
+    is_all = false;
+}
+
+BoardRenderer::BoardRenderer(const Grid *rendered_grid, const Searcher *rendered_searcher, const Camera *view_camera)
+{
+    grid = rendered_grid;
+    searcher = rendered_searcher;
+    camera = view_camera;
+}
+
+void BoardRenderer::Initialize()
+{
+    int max_texture_side;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_side);
+    if (grid->Width() > max_texture_side || grid->Height() > max_texture_side)
+        std::cout << "ERROR: GRID IS LARGER THAN THE MAX TEXTURE SIDE " << max_texture_side << std::endl;
+
+    // the fullscreen triangle is made from gl_VertexID,
+    // the core profile still needs a bound vao to draw
+    glGenVertexArrays(1, &board_vao);
+
+    for (unsigned int *texture : {&states_texture, &costs_texture, &flows_texture})
+    {
+        glGenTextures(1, texture);
+        glBindTexture(GL_TEXTURE_2D, *texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    AllocateStates();
+    UpdateAllCells();
+}
+
+void BoardRenderer::AllocateStates()
+{
+    width = grid->Width();
+    height = grid->Height();
+    std::size_t cells_count = std::size_t(width) * height;
+
+    states.assign(cells_count, Free_State);
+    search_states.assign(cells_count, Free_State);
+    touched_cells.clear();
+    path_cells.clear();
+    under_path.clear();
+
+    dirty_states.Reset(height);
+    dirty_costs.Reset(height);
+    dirty_flows.Reset(height);
+    RefreshAllFlows();
+
+    for (unsigned int texture : {states_texture, costs_texture, flows_texture})
+    {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, width, height, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, NULL);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+unsigned char BoardRenderer::ComposeState(int cell) const
+{
+    // same order as the cells used to be drawn in: search cells,
+    // blocked cells over them, start and destination on top
+    if (cell == start)
+        return Start_State;
+    if (cell == destination)
+        return Destination_State;
+    if (!grid->IsFree(cell))
+        return Blocked_State;
+    return search_states[cell];
+}
+
+unsigned char BoardRenderer::EncodeFlow(int cell) const
+{
+    if (flow_field == nullptr || !flow_field->IsReachable(cell))
+        return 0;
+
+    // repairs can go past the distance of the last level
+    long long level = (long long)flow_field->Distance(cell) * (Flow_Levels - 1) / flow_max_distance;
+    level = std::min<long long>(level, Flow_Levels - 1);
+    return (unsigned char)(1 + flow_field->Direction(cell) + 8 * level);
+}
+
+void BoardRenderer::RefreshAllFlows()
+{
+    flow_max_distance = flow_field != nullptr ? std::max(flow_field->MaxDistance(), 1) : 1;
+    flows.resize(std::size_t(width) * height);
+    for (std::size_t i = 0; i < flows.size(); i++)
+        flows[i] = EncodeFlow(i);
+    dirty_flows.is_all = true;
+}
+
+void BoardRenderer::RefreshCell(int cell)
+{
+    unsigned char state = ComposeState(cell);
+    if (states[cell] == state)
+        return;
+    states[cell] = state;
+    dirty_states.Mark(cell % width, cell / width);
+}
+
+void BoardRenderer::SetSearchState(int cell, unsigned char state)
+{
+    if (search_states[cell] == Free_State)
+        touched_cells.push_back(cell);
+    search_states[cell] = state;
+    RefreshCell(cell);
+}
+
+void BoardRenderer::AppendCells(const std::vector<int> &cells, unsigned char state)
+{
+    for (int cell : cells)
+    {
+        if (search_states[cell] < state)
+            SetSearchState(cell, state);
+    }
+}
+
+void BoardRenderer::ClearPath()
+{
+    for (std::size_t i = 0; i < path_cells.size(); i++)
+    {
+        search_states[path_cells[i]] = under_path[i];
+        RefreshCell(path_cells[i]);
+    }
+    path_cells.clear();
+    under_path.clear();
+}
+
+void BoardRenderer::UploadChanges(unsigned int texture, const unsigned char *cells, DirtyRows &dirty)
+{
+    if (!dirty.is_all && dirty.rows.empty())
+        return;
+
+    ASTAR_SCOPED_TIMER("upload_cells");
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // past half of the rows a single upload is cheaper than many small ones
+    if (dirty.is_all || dirty.rows.size() * 2 > std::size_t(height))
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED_INTEGER, GL_UNSIGNED_BYTE, cells);
+        ASTAR_COUNT(Gl_Bytes_Uploaded, std::size_t(width) * height);
+    }
+    else
+    {
+        for (int row : dirty.rows)
+        {
+            int first = dirty.first_column[row];
+            int length = dirty.last_column[row] - first + 1;
+            glTexSubImage2D(GL_TEXTURE_2D, 0, first, row, length, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE,
+                            cells + std::size_t(row) * width + first);
+            ASTAR_COUNT(Gl_Bytes_Uploaded, length);
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    dirty.Clear();
+}
+
+void BoardRenderer::UpdateCell(int cell)
+{
+    RefreshCell(cell);
+}
+
+void BoardRenderer::UpdateCost(int cell)
+{
+    dirty_costs.Mark(cell % width, cell / width);
+}
+
+void BoardRenderer::UpdateMainCells()
+{
+    int old_start = start;
+    int old_destination = destination;
+    start = grid->Start();
+    destination = grid->Destination();
+
+    if (old_start != -1)
+        RefreshCell(old_start);
+    if (old_destination != -1)
+        RefreshCell(old_destination);
+    if (start != -1)
+        RefreshCell(start);
+    if (destination != -1)
+        RefreshCell(destination);
+}
+
+void BoardRenderer::UpdateAllCells()
+{
+    if (grid->Width() != width || grid->Height() != height)
+        AllocateStates();
+
+    start = grid->Start();
+    destination = grid->Destination();
+    for (std::size_t i = 0; i < states.size(); i++)
+        states[i] = ComposeState(i);
+    dirty_states.is_all = true;
+    dirty_costs.is_all = true;
+}
+
+void BoardRenderer::Reset()
+{
+    // only the cells the search has drawn are visited
+    for (int cell : touched_cells)
+    {
+        search_states[cell] = Free_State;
+        RefreshCell(cell);
+    }
+    touched_cells.clear();
+    path_cells.clear();
+    under_path.clear();
+}
+
+void BoardRenderer::AppendStep()
+{
+    AppendCells(searcher->StepOpened(), Opened_State);
+    AppendCells(searcher->StepClosed(), Closed_State);
+    AppendCells(searcher->StepBackwardOpened(), Backward_Opened_State);
+    AppendCells(searcher->StepBackwardClosed(), Backward_Closed_State);
+}
+
+void BoardRenderer::AppendBatch(const BackgroundSearch::StepBatch &batch)
+{
+    AppendCells(batch.opened, Opened_State);
+    AppendCells(batch.closed, Closed_State);
+    AppendCells(batch.backward_opened, Backward_Opened_State);
+    AppendCells(batch.backward_closed, Backward_Closed_State);
+}
+
+void BoardRenderer::UpdatePath()
+{
+    UpdatePath(searcher->Path());
+}
+
+void BoardRenderer::UpdatePath(const std::vector<int> &path)
+{
+    ClearPath();
+
+    const int gradient_steps = 255 - Path_First_State;
+    for (std::size_t i = 0; i < path.size(); i++)
+    {
+        float delta = (i + 1) / float(path.size() + 1);
+        path_cells.push_back(path[i]);
+        under_path.push_back(search_states[path[i]]);
+        SetSearchState(path[i], Path_First_State + (unsigned char)std::lround(delta * gradient_steps));
+    }
+}
+
+void BoardRenderer::ShowReplay(const TraceReplay &replay)
+{
+    static const unsigned char Replay_States[] =
+    {
+        Free_State, Opened_State, Closed_State, Backward_Opened_State, Backward_Closed_State
+    };
+
+    const std::vector<unsigned char> &replay_states = replay.States();
+    if (replay_states.size() != search_states.size())
+        return;
+
+    if (!replay.WasRebuilt())
+    {
+        for (int cell : replay.ChangedCells())
+            SetSearchState(cell, Replay_States[replay_states[cell]]);
+        return;
+    }
+
+    ASTAR_SCOPED_TIMER("replay_rebuild");
+    touched_cells.clear();
+    path_cells.clear();
+    under_path.clear();
+    for (std::size_t cell = 0; cell < search_states.size(); cell++)
+    {
+        search_states[cell] = Replay_States[replay_states[cell]];
+        if (search_states[cell] != Free_State)
+            touched_cells.push_back(cell);
+        states[cell] = ComposeState(cell);
+    }
+    dirty_states.is_all = true;
+}
+
+void BoardRenderer::SetFlowField(const FlowField *field)
+{
+    flow_field = field;
+    RefreshAllFlows();
+}
+
+void BoardRenderer::UpdateFlow()
+{
+    // the field may belong to a resized grid until UpdateAllCells was called
+    if (flow_field == nullptr || flow_field->WasRebuilt() || flows.size() != grid->CellsCount())
+    {
+        RefreshAllFlows();
+        return;
+    }
+
+    for (int cell : flow_field->ChangedCells())
+    {
+        unsigned char flow = EncodeFlow(cell);
+        if (flows[cell] == flow)
+            continue;
+        flows[cell] = flow;
+        dirty_flows.Mark(cell % width, cell / width);
+    }
+}
+
+void BoardRenderer::Draw(const ShaderProgram &shader)
+{
+    UploadChanges(states_texture, states.data(), dirty_states);
+    UploadChanges(costs_texture, grid->Costs().data(), dirty_costs);
+    UploadChanges(flows_texture, flows.data(), dirty_flows);
+
+    float cell_pixels = camera->CellPixels();
+    shader.SetInt("states", 0);
+    shader.SetInt("costs", 1);
+    shader.SetInt("flows", 2);
+    shader.SetVec3Array("palette", palette, Palette_Size);
+    shader.SetVec3Array("heat_colors", heat_colors, 2);
+    shader.SetFloat("max_cost", grid->MaxCost());
+    shader.SetVec3Array("line_color", line_color, 1);
+    shader.SetVec2("grid_size", width, height);
+    shader.SetFloat("cell_pixels", cell_pixels);
+    shader.SetFloat("show_lines", cell_pixels >= min_grid_lines_cell_pixels ? 1.0f : 0.0f);
+    shader.SetVec3Array("flow_colors", flow_colors, 2);
+    shader.SetVec3Array("arrow_color", arrow_color, 1);
+    shader.SetFloat("show_flow", flow_field != nullptr ? 1.0f : 0.0f);
+    shader.SetFloat("show_arrows", cell_pixels >= min_arrows_cell_pixels ? 1.0f : 0.0f);
+
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, flows_texture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, costs_texture);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, states_texture);
+    glBindVertexArray(board_vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
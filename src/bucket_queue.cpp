@@ -0,0 +1,185 @@
+#include "bucket_queue.h"
+#include <algorithm>
+
+BucketQueue::BucketQueue(std::size_t capacity)
+{
+    buckets.assign(Min_Buckets, {-1, -1});
+    reserve(capacity);
+}
+
+void BucketQueue::reserve(std::size_t capacity)
+{
+    if (entries.size() < capacity)
+        entries.resize(capacity, {-1, 0, -1, -1});
+}
+
+BucketQueue::Bucket& BucketQueue::BucketOf(int all_cost)
+{
+    return buckets[all_cost & (buckets.size() - 1)];
+}
+
+void BucketQueue::PushFront(int item)
+{
+    Entry &entry = entries[item];
+    Bucket &bucket = BucketOf(entry.all_cost);
+    entry.previous = -1;
+    entry.next = bucket.first;
+    if (bucket.first != -1)
+        entries[bucket.first].previous = item;
+    else
+        bucket.last = item;
+    bucket.first = item;
+}
+
+void BucketQueue::PushBack(int item)
+{
+    Entry &entry = entries[item];
+    Bucket &bucket = BucketOf(entry.all_cost);
+    entry.previous = bucket.last;
+    entry.next = -1;
+    if (bucket.last != -1)
+        entries[bucket.last].next = item;
+    else
+        bucket.first = item;
+    bucket.last = item;
+}
+
+void BucketQueue::Unlink(int item)
+{
+    Entry &entry = entries[item];
+    Bucket &bucket = BucketOf(entry.all_cost);
+    if (entry.previous != -1)
+        entries[entry.previous].next = entry.next;
+    else
+        bucket.first = entry.next;
+    if (entry.next != -1)
+        entries[entry.next].previous = entry.previous;
+    else
+        bucket.last = entry.previous;
+
+    entry.all_cost = -1;
+    count--;
+}
+
+void BucketQueue::SkipEmptyBuckets()
+{
+    if (count == 0)
+        return;
+    while (BucketOf(lowest).first == -1)
+        lowest++;
+}
+
+void BucketQueue::Grow(int spread)
+{
+    // relinks the queued items in order, the buckets of the queued costs
+    // are visited from the lowest one
+    std::vector<int> items;
+    items.reserve(count);
+    for (int cost = lowest; cost <= highest; cost++)
+    {
+        Bucket &bucket = BucketOf(cost);
+        for (int item = bucket.first; item != -1; item = entries[item].next)
+            items.push_back(item);
+        bucket = {-1, -1};
+    }
+
+    std::size_t buckets_count = buckets.size();
+    while (buckets_count < std::size_t(spread) * 2)
+        buckets_count *= 2;
+    buckets.assign(buckets_count, {-1, -1});
+
+    for (int item : items)
+        PushBack(item);
+}
+
+int BucketQueue::get()
+{
+    int item = BucketOf(lowest).first;
+    Unlink(item);
+    SkipEmptyBuckets();
+    return item;
+}
+
+int BucketQueue::top_cost() const
+{
+    return lowest;
+}
+
+int BucketQueue::top_d_cost() const
+{
+    return entries[buckets[lowest & (buckets.size() - 1)].first].d_cost;
+}
+
+bool BucketQueue::empty() const
+{
+    return count == 0;
+}
+
+std::size_t BucketQueue::size() const
+{
+    return count;
+}
+
+bool BucketQueue::contains(int item) const
+{
+    return entries[item].all_cost != -1;
+}
+
+void BucketQueue::clear()
+{
+    for (int cost = lowest; count > 0 && cost <= highest; cost++)
+    {
+        Bucket &bucket = BucketOf(cost);
+        for (int item = bucket.first; item != -1; item = entries[item].next)
+        {
+            entries[item].all_cost = -1;
+            count--;
+        }
+        bucket = {-1, -1};
+    }
+}
+
+void BucketQueue::put(int item, int all_cost, int d_cost)
+{
+    Entry &entry = entries[item];
+    if (entry.all_cost == all_cost)
+    {
+        entry.d_cost = d_cost;
+        return;
+    }
+    remove(item);
+
+    if (count == 0)
+    {
+        lowest = highest = all_cost;
+    }
+    else
+    {
+        int new_lowest = std::min(lowest, all_cost);
+        int new_highest = std::max(highest, all_cost);
+        if (new_highest - new_lowest >= int(buckets.size()))
+            Grow(new_highest - new_lowest + 1);
+        lowest = new_lowest;
+        highest = new_highest;
+    }
+
+    entry.all_cost = all_cost;
+    entry.d_cost = d_cost;
+    Bucket &bucket = BucketOf(all_cost);
+    if (bucket.first == -1 || d_cost <= entries[bucket.first].d_cost)
+        PushFront(item);
+    else
+        PushBack(item);
+    count++;
+}
+
+void BucketQueue::remove(int item)
+{
+    if (entries[item].all_cost == -1)
+        return;
+
+    bool was_lowest = entries[item].all_cost == lowest;
+    Unlink(item);
+    if (was_lowest)
+        SkipEmptyBuckets();
+}
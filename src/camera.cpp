@@ -0,0 +1,52 @@
+#include "camera.h"
+#include <algorithm>
+
+#include "constants.h"
+
+void Camera::Fit(int width, int height)
+{
+    center_x = width / 2.0f;
+    center_y = height / 2.0f;
+    cell_pixels = float(W_Side) / std::max(width, height);
+
+    min_cell_pixels = cell_pixels / 2.0f;
+    max_cell_pixels = std::max(cell_pixels, float(W_Side) / 4.0f);
+}
+
+void Camera::Zoom(float factor, double screen_x, double screen_y)
+{
+    float before_x, before_y;
+    ScreenToWorld(screen_x, screen_y, before_x, before_y);
+
+    cell_pixels = std::clamp(cell_pixels * factor, min_cell_pixels, max_cell_pixels);
+
+    float after_x, after_y;
+    ScreenToWorld(screen_x, screen_y, after_x, after_y);
+    center_x += before_x - after_x;
+    center_y += before_y - after_y;
+}
+
+void Camera::Pan(double delta_x, double delta_y)
+{
+    center_x -= delta_x / cell_pixels;
+    center_y -= delta_y / cell_pixels;
+}
+
+float Camera::CellPixels() const
+{
+    return cell_pixels;
+}
+
+void Camera::ScreenToWorld(double screen_x, double screen_y, float &world_x, float &world_y) const
+{
+    world_x = center_x + (screen_x - W_Side / 2.0) / cell_pixels;
+    world_y = center_y + (screen_y - W_Side / 2.0) / cell_pixels;
+}
+
+void Camera::View(float view[4]) const
+{
+    float scale = 2.0f * cell_pixels / W_Side;
+    view[0] = view[1] = scale;
+    view[2] = -center_x * scale;
+    view[3] = -center_y * scale;
+}
@@ -0,0 +1,401 @@
+#include "component_labels.h"
+#include "grid.h"
+#include <algorithm>
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+bool CanStep(const Grid &grid, int from, int to)
+{
+    int column_step = grid.Column(to) - grid.Column(from);
+    int row_step = grid.Row(to) - grid.Row(from);
+    for (int d = 0; d < Grid::Directions_Count; d++)
+    {
+        if (Grid::Direction_Columns[d] == column_step && Grid::Direction_Rows[d] == row_step)
+            return grid.NeighbourMask(from) & (1 << d);
+    }
+    return false;
+}
+
+int ComponentLabels::NewLabel()
+{
+    if (!free_labels.empty())
+    {
+        int label = free_labels.back();
+        free_labels.pop_back();
+        return label;
+    }
+
+    sizes.push_back(0);
+    return int(sizes.size()) - 1;
+}
+
+void ComponentLabels::ReleaseLabel(int label)
+{
+    sizes[label] = 0;
+    free_labels.push_back(label);
+}
+
+std::size_t ComponentLabels::Relabel(const Grid &grid, int seed, int from, int to)
+{
+    // masks of free cells only lead to free cells
+    queue.resize(0);
+    labels[seed] = to;
+    queue.push_back(seed);
+    for (std::size_t i = 0; i < queue.size(); i++)
+    {
+        int cell = queue[i];
+        unsigned char neighbours = grid.NeighbourMask(cell);
+        for (int d = 0; d < Grid::Directions_Count; d++)
+        {
+            if (!(neighbours & (1 << d)))
+                continue;
+
+            int next = cell + grid.NeighbourOffset(d);
+            if (labels[next] == from)
+            {
+                labels[next] = to;
+                queue.push_back(next);
+            }
+        }
+    }
+    return queue.size();
+}
+
+static int LowestSetBit(std::uint64_t word)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return int(index);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+int ComponentLabels::FindRoot(int run)
+{
+    // path halving, every visited run skips its parent
+    while (run_parents[run] != run)
+    {
+        run_parents[run] = run_parents[run_parents[run]];
+        run = run_parents[run];
+    }
+    return run;
+}
+
+void ComponentLabels::Rebuild(const Grid &grid)
+{
+    // every cell is written once at the end
+    labels.resize(grid.CellsCount());
+    sizes.clear();
+    free_labels.clear();
+    runs.clear();
+    run_parents.clear();
+
+    // free cells side by side always link, so every row is cut into runs of
+    // free cells. Runs of neighbouring rows link iff their columns overlap:
+    // a diagonal move is allowed when a cell beside it is free, and that
+    // cell already makes the runs overlap
+    int width = grid.Width();
+    auto add_run = [this](int row, int first_column, int last_column)
+    {
+        runs.push_back({row, first_column, last_column});
+        run_parents.push_back(int(runs.size()) - 1);
+    };
+
+    std::size_t previous_row = 0;
+    for (int row = 0; row < grid.Height(); row++)
+    {
+        // 64 cells at a time, every set bit of edges starts or ends a run
+        std::size_t row_runs = runs.size();
+        std::size_t row_first = std::size_t(row) * width;
+        std::uint64_t was_free = 0;
+        bool is_open = false;
+        int run_first = 0;
+        for (int column = 0; column < width; column += 64)
+        {
+            std::uint64_t free = grid.FreeBits(row_first + column);
+            if (width - column < 64)
+                free &= (std::uint64_t(1) << (width - column)) - 1;
+            std::uint64_t edges = free ^ (free << 1 | was_free);
+            was_free = free >> 63;
+            for (; edges != 0; edges &= edges - 1)
+            {
+                int edge = column + LowestSetBit(edges);
+                if (is_open)
+                    add_run(row, run_first, edge - 1);
+                run_first = edge;
+                is_open = !is_open;
+            }
+        }
+        if (is_open)
+            add_run(row, run_first, width - 1);
+
+        // both rows are sorted, the parent is always the earlier run
+        std::size_t above = previous_row;
+        for (std::size_t run = row_runs; run < runs.size() && above < row_runs;)
+        {
+            if (runs[above].last_column >= runs[run].first_column && runs[run].last_column >= runs[above].first_column)
+            {
+                int root = FindRoot(int(above));
+                int own_root = FindRoot(int(run));
+                if (root < own_root)
+                    run_parents[own_root] = root;
+                else if (own_root < root)
+                    run_parents[root] = own_root;
+            }
+
+            if (runs[above].last_column < runs[run].last_column)
+                above++;
+            else
+                run++;
+        }
+        previous_row = row_runs;
+    }
+
+    // in the same order every parent already holds the label of its area,
+    // the blocked cells between the runs get -1
+    std::size_t next_cell = 0;
+    for (std::size_t run = 0; run < runs.size(); run++)
+    {
+        int parent = run_parents[run];
+        int label = parent == int(run) ? NewLabel() : run_parents[parent];
+        run_parents[run] = label;
+
+        std::size_t first = std::size_t(runs[run].row) * width + runs[run].first_column;
+        std::size_t end = std::size_t(runs[run].row) * width + runs[run].last_column + 1;
+        int *cell_labels = labels.data();
+        for (std::size_t cell = next_cell; cell < first; cell++)
+            cell_labels[cell] = -1;
+        for (std::size_t cell = first; cell < end; cell++)
+            cell_labels[cell] = label;
+        sizes[label] += int(end - first);
+        next_cell = end;
+    }
+    std::fill(labels.begin() + next_cell, labels.end(), -1);
+    stale.is_stale.store(false, std::memory_order_release);
+}
+
+void ComponentLabels::Invalidate()
+{
+    stale.is_stale = true;
+}
+
+void ComponentLabels::Update(const Grid &grid)
+{
+    if (!stale.is_stale.load(std::memory_order_acquire))
+        return;
+    std::lock_guard<std::mutex> lock(stale.mutex);
+    if (stale.is_stale.load(std::memory_order_relaxed))
+        Rebuild(grid);
+}
+
+void ComponentLabels::CellFreed(const Grid &grid, int cell)
+{
+    if (stale.is_stale.load(std::memory_order_relaxed))
+        return;
+
+    // the freed cell links every area it can step into, the largest one keeps its label
+    unsigned char neighbours = grid.NeighbourMask(cell);
+    int label = -1;
+    for (int d = 0; d < Grid::Directions_Count; d++)
+    {
+        if (!(neighbours & (1 << d)))
+            continue;
+
+        int neighbour_label = labels[cell + grid.NeighbourOffset(d)];
+        if (label == -1 || sizes[neighbour_label] > sizes[label])
+            label = neighbour_label;
+    }
+
+    if (label == -1)
+        label = NewLabel();
+    labels[cell] = label;
+    sizes[label]++;
+
+    for (int d = 0; d < Grid::Directions_Count; d++)
+    {
+        if (!(neighbours & (1 << d)))
+            continue;
+
+        int next = cell + grid.NeighbourOffset(d);
+        int neighbour_label = labels[next];
+        if (neighbour_label != label)
+        {
+            sizes[label] += Relabel(grid, next, neighbour_label, label);
+            ReleaseLabel(neighbour_label);
+        }
+    }
+}
+
+void ComponentLabels::CellBlocked(const Grid &grid, int cell)
+{
+    if (stale.is_stale.load(std::memory_order_relaxed))
+        return;
+
+    int label = labels[cell];
+    labels[cell] = -1;
+    if (--sizes[label] == 0)
+        ReleaseLabel(label);
+    else
+        SplitAround(grid, cell, label);
+}
+
+void ComponentLabels::SplitAround(const Grid &grid, int cell, int label)
+{
+    // the free neighbours the cell used to link, a blocked cell keeps its mask.
+    // Every other cell of the area is connected to one of them
+    int ring[Grid::Directions_Count];
+    int groups[Grid::Directions_Count];
+    int ring_count = 0;
+    unsigned char neighbours = grid.NeighbourMask(cell);
+    for (int d = 0; d < Grid::Directions_Count; d++)
+    {
+        if (neighbours & (1 << d))
+        {
+            ring[ring_count] = cell + grid.NeighbourOffset(d);
+            groups[ring_count] = ring_count;
+            ring_count++;
+        }
+    }
+
+    // neighbours still linked by a move between them stay together,
+    // usually there is a single group and nothing changes
+    for (int i = 0; i < ring_count; i++)
+    {
+        for (int j = i + 1; j < ring_count; j++)
+        {
+            if (groups[i] == groups[j] || !CanStep(grid, ring[i], ring[j]))
+                continue;
+
+            int merged = groups[j];
+            for (int k = 0; k < ring_count; k++)
+                if (groups[k] == merged)
+                    groups[k] = groups[i];
+        }
+    }
+
+    int sides_count = 0;
+    for (int i = 0; i < ring_count; i++)
+        if (groups[i] == i)
+            sides_count++;
+    if (sides_count <= 1)
+        return;
+
+    sides_count = 0;
+    int side_labels[Grid::Directions_Count];
+    int side_sets[Grid::Directions_Count]; // sides found to meet share a set
+    std::size_t next[Grid::Directions_Count];
+    for (int i = 0; i < ring_count; i++)
+    {
+        if (groups[i] != i)
+            continue;
+
+        int side = sides_count++;
+        side_labels[side] = NewLabel();
+        side_sets[side] = side;
+        next[side] = 0;
+        labels[ring[i]] = side_labels[side];
+        side_cells[side].assign(1, ring[i]);
+    }
+
+    // every side grows by one cell in turns until a single set of sides is
+    // still growing, the others have then been explored entirely
+    int growing_set;
+    while (true)
+    {
+        growing_set = -1;
+        bool are_several_growing = false;
+        for (int side = 0; side < sides_count; side++)
+        {
+            if (next[side] == side_cells[side].size())
+                continue;
+            if (growing_set == -1)
+                growing_set = side_sets[side];
+            else if (side_sets[side] != growing_set)
+                are_several_growing = true;
+        }
+        if (!are_several_growing)
+            break;
+
+        for (int side = 0; side < sides_count; side++)
+        {
+            if (next[side] == side_cells[side].size())
+                continue;
+
+            int current = side_cells[side][next[side]++];
+            unsigned char current_neighbours = grid.NeighbourMask(current);
+            for (int d = 0; d < Grid::Directions_Count; d++)
+            {
+                if (!(current_neighbours & (1 << d)))
+                    continue;
+
+                int next_cell = current + grid.NeighbourOffset(d);
+                int next_label = labels[next_cell];
+                if (next_label == label)
+                {
+                    labels[next_cell] = side_labels[side];
+                    side_cells[side].push_back(next_cell);
+                    continue;
+                }
+
+                // reached the cells of another side, both sides are one area
+                for (int other = 0; other < sides_count; other++)
+                {
+                    if (side_labels[other] != next_label || side_sets[other] == side_sets[side])
+                        continue;
+
+                    int merged = side_sets[other];
+                    for (int k = 0; k < sides_count; k++)
+                        if (side_sets[k] == merged)
+                            side_sets[k] = side_sets[side];
+                }
+            }
+        }
+    }
+
+    // the set still growing keeps the old label, or the largest one if all stopped
+    int kept_set = growing_set;
+    if (kept_set == -1)
+    {
+        std::size_t set_sizes[Grid::Directions_Count] = {};
+        for (int side = 0; side < sides_count; side++)
+            set_sizes[side_sets[side]] += side_cells[side].size();
+        kept_set = 0;
+        for (int set = 1; set < sides_count; set++)
+            if (set_sizes[set] > set_sizes[kept_set])
+                kept_set = set;
+    }
+
+    std::size_t moved = 0;
+    for (int side = 0; side < sides_count; side++)
+    {
+        int set = side_sets[side];
+        int new_label = set == kept_set ? label : side_labels[set];
+        for (int moved_cell : side_cells[side])
+            labels[moved_cell] = new_label;
+
+        if (set != kept_set)
+        {
+            sizes[new_label] += side_cells[side].size();
+            moved += side_cells[side].size();
+        }
+    }
+    sizes[label] -= moved;
+
+    for (int side = 0; side < sides_count; side++)
+        if (side_sets[side] != side || side == kept_set)
+            ReleaseLabel(side_labels[side]);
+}
+
+int ComponentLabels::Label(int cell) const
+{
+    return labels[cell];
+}
+
+std::size_t ComponentLabels::Size(int label) const
+{
+    return sizes[label];
+}
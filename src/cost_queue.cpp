@@ -1,24 +1,24 @@
-#include "searcher.h"
+#include "cost_queue.h"
 #include <algorithm>
 
-Cell Searcher::CostQueue::get()
+Cell CostQueue::get()
 {
     Cell el = std::get<Cell>(elements.back());
     elements.pop_back();
     return el;
 }
 
-const bool Searcher::CostQueue::empty() const
+bool CostQueue::empty() const
 {
     return elements.empty();
 }
 
-void Searcher::CostQueue::clear()
+void CostQueue::clear()
 {
     elements.clear();
 }
 
-void Searcher::CostQueue::put_unique(const Cell &item, int all_cost, int d_cost)
+void CostQueue::put_unique(const Cell &item, int all_cost, int d_cost)
 {
     auto it = std::find_if(elements.begin(), elements.end(), [&item](const CQElement &el) {return std::get<Cell>(el) == item;});
     
@@ -33,7 +33,7 @@ void Searcher::CostQueue::put_unique(const Cell &item, int all_cost, int d_cost)
     }
 }
 
-void Searcher::CostQueue::sort()
+void CostQueue::sort()
 {
     std::sort(elements.begin(), elements.end(), std::greater<CQElement>());
 }
\ No newline at end of file
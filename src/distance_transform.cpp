@@ -0,0 +1,371 @@
+#include "distance_transform.h"
+#include <algorithm>
+#include <climits>
+#include "instrumentation.h"
+
+// the vector kernels are compiled for their instruction sets function by
+// function and only called once the cpu reported them, so the rest of the
+// build keeps its default flags
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define ASTAR_X86_KERNELS 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#define ASTAR_TARGET(isa)
+#else
+#define ASTAR_TARGET(isa) __attribute__((target(isa)))
+#endif
+#else
+#define ASTAR_X86_KERNELS 0
+#endif
+
+// the distance of one cell after looking at the three cells of the near row
+static int VerticalCell(const int *near, const int *row, int column, int width)
+{
+    int best = std::min(row[column], near[column] + Grid::Straight_Cost);
+    if (column > 0)
+        best = std::min(best, near[column - 1] + Grid::Diagonal_Cost);
+    if (column + 1 < width)
+        best = std::min(best, near[column + 1] + Grid::Diagonal_Cost);
+    return best;
+}
+
+// the first cell and the cells from `first` on, the vector kernels leave
+// them out because their rows do not have both diagonal neighbours
+static void VerticalRest(const int *near, int *row, int width, int first)
+{
+    for (int column = 0; column < width; column = column == 0 ? std::max(first, 1) : column + 1)
+        row[column] = VerticalCell(near, row, column, width);
+}
+
+static void VerticalStepScalar(const int *near, int *row, int width)
+{
+    VerticalRest(near, row, width, 1);
+}
+
+static void ForwardScanScalar(int *row, int width)
+{
+    for (int column = 1; column < width; column++)
+        row[column] = std::min(row[column], row[column - 1] + Grid::Straight_Cost);
+}
+
+static void BackwardScanScalar(int *row, int width)
+{
+    for (int column = width - 2; column >= 0; column--)
+        row[column] = std::min(row[column], row[column + 1] + Grid::Straight_Cost);
+}
+
+#if ASTAR_X86_KERNELS
+// a forward scan, d[c] = min(d[c], d[c - 1] + 12), is the prefix minimum of
+// d[k] - 12k plus 12c. Inside a block the minimum is taken in log steps over
+// lanes shifted by 1, 2 and 4, the last lane carries it to the next block.
+// The backward scan is the suffix minimum of d[k] + 12k, which goes past
+// Infinity, so its shifted-in lanes hold INT_MAX
+
+ASTAR_TARGET("sse4.1")
+static void VerticalStepSse(const int *near, int *row, int width)
+{
+    const __m128i straight = _mm_set1_epi32(Grid::Straight_Cost);
+    const __m128i diagonal = _mm_set1_epi32(Grid::Diagonal_Cost);
+
+    int column = 1;
+    for (; column + 4 < width; column += 4)
+    {
+        __m128i old = _mm_loadu_si128((const __m128i *)(row + column));
+        __m128i up = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(near + column)), straight);
+        __m128i left = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(near + column - 1)), diagonal);
+        __m128i right = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(near + column + 1)), diagonal);
+        __m128i best = _mm_min_epi32(_mm_min_epi32(old, up), _mm_min_epi32(left, right));
+        _mm_storeu_si128((__m128i *)(row + column), best);
+    }
+
+    VerticalRest(near, row, width, column);
+}
+
+ASTAR_TARGET("sse4.1")
+static void ForwardScanSse(int *row, int width)
+{
+    const __m128i lane_offsets = _mm_setr_epi32(0, 12, 24, 36);
+    const __m128i first_lane = _mm_setr_epi32(DistanceTransform::Infinity, 0, 0, 0);
+    const __m128i first_lanes = _mm_setr_epi32(DistanceTransform::Infinity, DistanceTransform::Infinity, 0, 0);
+    __m128i carry = _mm_set1_epi32(DistanceTransform::Infinity);
+
+    int column = 0;
+    for (; column + 4 <= width; column += 4)
+    {
+        __m128i offsets = _mm_add_epi32(_mm_set1_epi32(column * Grid::Straight_Cost), lane_offsets);
+        __m128i t = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(row + column)), offsets);
+        t = _mm_min_epi32(t, _mm_or_si128(_mm_slli_si128(t, 4), first_lane));
+        t = _mm_min_epi32(t, _mm_or_si128(_mm_slli_si128(t, 8), first_lanes));
+        t = _mm_min_epi32(t, carry);
+        carry = _mm_shuffle_epi32(t, _MM_SHUFFLE(3, 3, 3, 3));
+        _mm_storeu_si128((__m128i *)(row + column), _mm_add_epi32(t, offsets));
+    }
+
+    for (column = std::max(column, 1); column < width; column++)
+        row[column] = std::min(row[column], row[column - 1] + Grid::Straight_Cost);
+}
+
+ASTAR_TARGET("sse4.1")
+static void BackwardScanSse(int *row, int width)
+{
+    const __m128i lane_offsets = _mm_setr_epi32(0, 12, 24, 36);
+    const __m128i last_lane = _mm_setr_epi32(0, 0, 0, INT_MAX);
+    const __m128i last_lanes = _mm_setr_epi32(0, 0, INT_MAX, INT_MAX);
+    __m128i carry = _mm_set1_epi32(INT_MAX);
+
+    int end = width;
+    for (; end >= 4; end -= 4)
+    {
+        int begin = end - 4;
+        __m128i offsets = _mm_add_epi32(_mm_set1_epi32(begin * Grid::Straight_Cost), lane_offsets);
+        __m128i u = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(row + begin)), offsets);
+        u = _mm_min_epi32(u, _mm_or_si128(_mm_srli_si128(u, 4), last_lane));
+        u = _mm_min_epi32(u, _mm_or_si128(_mm_srli_si128(u, 8), last_lanes));
+        u = _mm_min_epi32(u, carry);
+        carry = _mm_shuffle_epi32(u, _MM_SHUFFLE(0, 0, 0, 0));
+        _mm_storeu_si128((__m128i *)(row + begin), _mm_sub_epi32(u, offsets));
+    }
+
+    for (int column = std::min(end, width - 1) - 1; column >= 0; column--)
+        row[column] = std::min(row[column], row[column + 1] + Grid::Straight_Cost);
+}
+
+ASTAR_TARGET("avx2")
+static void VerticalStepAvx2(const int *near, int *row, int width)
+{
+    const __m256i straight = _mm256_set1_epi32(Grid::Straight_Cost);
+    const __m256i diagonal = _mm256_set1_epi32(Grid::Diagonal_Cost);
+
+    int column = 1;
+    for (; column + 8 < width; column += 8)
+    {
+        __m256i old = _mm256_loadu_si256((const __m256i *)(row + column));
+        __m256i up = _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)(near + column)), straight);
+        __m256i left = _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)(near + column - 1)), diagonal);
+        __m256i right = _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)(near + column + 1)), diagonal);
+        __m256i best = _mm256_min_epi32(_mm256_min_epi32(old, up), _mm256_min_epi32(left, right));
+        _mm256_storeu_si256((__m256i *)(row + column), best);
+    }
+
+    VerticalRest(near, row, width, column);
+}
+
+ASTAR_TARGET("avx2")
+static void ForwardScanAvx2(int *row, int width)
+{
+    const __m256i lane_offsets = _mm256_setr_epi32(0, 12, 24, 36, 48, 60, 72, 84);
+    const __m256i by_one = _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6);
+    const __m256i by_two = _mm256_setr_epi32(0, 0, 0, 1, 2, 3, 4, 5);
+    const __m256i by_four = _mm256_setr_epi32(0, 0, 0, 0, 0, 1, 2, 3);
+    const __m256i last = _mm256_set1_epi32(7);
+    const __m256i infinity = _mm256_set1_epi32(DistanceTransform::Infinity);
+    __m256i carry = infinity;
+
+    int column = 0;
+    for (; column + 8 <= width; column += 8)
+    {
+        __m256i offsets = _mm256_add_epi32(_mm256_set1_epi32(column * Grid::Straight_Cost), lane_offsets);
+        __m256i t = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(row + column)), offsets);
+        t = _mm256_min_epi32(t, _mm256_blend_epi32(_mm256_permutevar8x32_epi32(t, by_one), infinity, 0x01));
+        t = _mm256_min_epi32(t, _mm256_blend_epi32(_mm256_permutevar8x32_epi32(t, by_two), infinity, 0x03));
+        t = _mm256_min_epi32(t, _mm256_blend_epi32(_mm256_permutevar8x32_epi32(t, by_four), infinity, 0x0F));
+        t = _mm256_min_epi32(t, carry);
+        carry = _mm256_permutevar8x32_epi32(t, last);
+        _mm256_storeu_si256((__m256i *)(row + column), _mm256_add_epi32(t, offsets));
+    }
+
+    for (column = std::max(column, 1); column < width; column++)
+        row[column] = std::min(row[column], row[column - 1] + Grid::Straight_Cost);
+}
+
+ASTAR_TARGET("avx2")
+static void BackwardScanAvx2(int *row, int width)
+{
+    const __m256i lane_offsets = _mm256_setr_epi32(0, 12, 24, 36, 48, 60, 72, 84);
+    const __m256i by_one = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 7);
+    const __m256i by_two = _mm256_setr_epi32(2, 3, 4, 5, 6, 7, 7, 7);
+    const __m256i by_four = _mm256_setr_epi32(4, 5, 6, 7, 7, 7, 7, 7);
+    const __m256i first = _mm256_setzero_si256();
+    const __m256i past_end = _mm256_set1_epi32(INT_MAX);
+    __m256i carry = past_end;
+
+    int end = width;
+    for (; end >= 8; end -= 8)
+    {
+        int begin = end - 8;
+        __m256i offsets = _mm256_add_epi32(_mm256_set1_epi32(begin * Grid::Straight_Cost), lane_offsets);
+        __m256i u = _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)(row + begin)), offsets);
+        u = _mm256_min_epi32(u, _mm256_blend_epi32(_mm256_permutevar8x32_epi32(u, by_one), past_end, 0x80));
+        u = _mm256_min_epi32(u, _mm256_blend_epi32(_mm256_permutevar8x32_epi32(u, by_two), past_end, 0xC0));
+        u = _mm256_min_epi32(u, _mm256_blend_epi32(_mm256_permutevar8x32_epi32(u, by_four), past_end, 0xF0));
+        u = _mm256_min_epi32(u, carry);
+        carry = _mm256_permutevar8x32_epi32(u, first);
+        _mm256_storeu_si256((__m256i *)(row + begin), _mm256_sub_epi32(u, offsets));
+    }
+
+    for (int column = std::min(end, width - 1) - 1; column >= 0; column--)
+        row[column] = std::min(row[column], row[column + 1] + Grid::Straight_Cost);
+}
+
+static bool CpuHasSse41()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+#else
+    // may run before the constructors that would initialise it
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+static bool CpuHasAvx2()
+{
+#if defined(_MSC_VER)
+    // the os has to save the ymm registers too
+    int info[4];
+    __cpuid(info, 1);
+    bool has_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return has_avx && (info[1] & (1 << 5));
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+// the vertical step of a row and its scans
+struct SweepKernel
+{
+    void (*vertical_step)(const int *near, int *row, int width);
+    void (*forward_scan)(int *row, int width);
+    void (*backward_scan)(int *row, int width);
+};
+
+static const SweepKernel Sweep_Kernels[DistanceTransform::Kernels_Count] =
+{
+    {VerticalStepScalar, ForwardScanScalar, BackwardScanScalar},
+#if ASTAR_X86_KERNELS
+    {VerticalStepSse, ForwardScanSse, BackwardScanSse},
+    {VerticalStepAvx2, ForwardScanAvx2, BackwardScanAvx2}
+#else
+    {VerticalStepScalar, ForwardScanScalar, BackwardScanScalar},
+    {VerticalStepScalar, ForwardScanScalar, BackwardScanScalar}
+#endif
+};
+
+DistanceTransform::DistanceTransform(const Grid *measured_grid)
+{
+    grid = measured_grid;
+    kernel = BestKernel();
+}
+
+const char *DistanceTransform::KernelKey(Kernel kind)
+{
+    switch (kind)
+    {
+    case Sse_Kernel:
+        return "sse";
+    case Avx2_Kernel:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+bool DistanceTransform::KernelFromKey(const std::string &key, Kernel &kind)
+{
+    for (int i = 0; i < Kernels_Count; i++)
+    {
+        if (key == KernelKey(Kernel(i)))
+        {
+            kind = Kernel(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DistanceTransform::IsSupported(Kernel kind)
+{
+#if ASTAR_X86_KERNELS
+    static const bool has_sse41 = CpuHasSse41();
+    static const bool has_avx2 = has_sse41 && CpuHasAvx2();
+    if (kind == Sse_Kernel)
+        return has_sse41;
+    if (kind == Avx2_Kernel)
+        return has_avx2;
+#endif
+    return kind == Scalar_Kernel;
+}
+
+DistanceTransform::Kernel DistanceTransform::BestKernel()
+{
+    for (int i = Kernels_Count - 1; i > Scalar_Kernel; i--)
+    {
+        if (IsSupported(Kernel(i)))
+            return Kernel(i);
+    }
+    return Scalar_Kernel;
+}
+
+void DistanceTransform::SetKernel(Kernel kind)
+{
+    kernel = IsSupported(kind) ? kind : Scalar_Kernel;
+}
+
+DistanceTransform::Kernel DistanceTransform::KernelKind() const
+{
+    return kernel;
+}
+
+void DistanceTransform::Sweep(bool is_forward)
+{
+    const SweepKernel &sweep = Sweep_Kernels[kernel];
+    int width = grid->Width();
+    int height = grid->Height();
+
+    for (int i = 0; i < height; i++)
+    {
+        int row = is_forward ? i : height - 1 - i;
+        int *distances_row = distances.data() + std::size_t(row) * width;
+        if (i > 0)
+        {
+            const int *near = distances.data() + std::size_t(is_forward ? row - 1 : row + 1) * width;
+            sweep.vertical_step(near, distances_row, width);
+        }
+
+        if (is_forward)
+            sweep.forward_scan(distances_row, width);
+        else
+            sweep.backward_scan(distances_row, width);
+    }
+}
+
+void DistanceTransform::Clearance()
+{
+    ASTAR_SCOPED_TIMER("clearance_transform");
+    distances.resize(grid->CellsCount());
+    for (std::size_t cell = 0; cell < distances.size(); cell++)
+        distances[cell] = grid->IsFree(cell) ? int(Infinity) : 0;
+
+    // the nearest blocked cell is reached without passing another one,
+    // so the two sweeps of a chamfer transform are exact
+    Sweep(true);
+    Sweep(false);
+}
+
+const std::vector<int>& DistanceTransform::Distances() const
+{
+    return distances;
+}
+
+int DistanceTransform::Distance(int cell) const
+{
+    return distances[cell];
+}
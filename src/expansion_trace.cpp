@@ -0,0 +1,496 @@
+#include "expansion_trace.h"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cstdint>
+
+static const char Magic[4] = {'A', 'T', 'R', 'C'};
+
+static void WriteVarint(std::vector<unsigned char> &bytes, std::uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back((unsigned char)value);
+}
+
+static bool ReadVarint(const std::vector<unsigned char> &bytes, std::size_t &offset, std::uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && offset < bytes.size(); shift += 7)
+    {
+        unsigned char byte = bytes[offset++];
+        value |= std::uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+// small negative deltas stay small: 0, -1, 1, -2, 2 ... become 0, 1, 2, 3, 4 ...
+static std::uint64_t ZigZag(long long value)
+{
+    return value < 0 ? (std::uint64_t(-(value + 1)) << 1) | 1 : std::uint64_t(value) << 1;
+}
+
+static long long UnZigZag(std::uint64_t value)
+{
+    return value & 1 ? -(long long)(value >> 1) - 1 : (long long)(value >> 1);
+}
+
+static bool ReadInt(const std::vector<unsigned char> &bytes, std::size_t &offset, int &value, bool is_signed)
+{
+    std::uint64_t raw;
+    if (!ReadVarint(bytes, offset, raw))
+        return false;
+    long long decoded = is_signed ? UnZigZag(raw) : (long long)raw;
+    if (decoded < INT32_MIN || decoded > INT32_MAX)
+        return false;
+    value = int(decoded);
+    return true;
+}
+
+void ExpansionTrace::Begin(const Grid &grid, int start_cell, int destination_cell, int algorithm_index)
+{
+    width = grid.Width();
+    height = grid.Height();
+    start = start_cell;
+    destination = destination_cell;
+    algorithm = algorithm_index;
+
+    blocked = grid.BlockedBits();
+    costs = grid.Costs();
+
+    steps.clear();
+    steps_count = 0;
+    last_expanded = start;
+    is_recording = true;
+    path_found = false;
+    path_cost = 0;
+    path.clear();
+}
+
+// splits cells into a mask of the neighbours of the expanded cell, bit d
+// for Grid direction d, and the cells further away
+static unsigned char NeighbourMask(int expanded, int width, const std::vector<int> &cells, std::vector<int> &far_cells)
+{
+    // direction of every (column, row) offset in a 3x3 block, -1 for the centre
+    static const int Block_Directions[9] = {0, 1, 2, 3, -1, 4, 5, 6, 7};
+    int column = expanded % width;
+    int row = expanded / width;
+    unsigned char neighbours = 0;
+    far_cells.clear();
+    for (int cell : cells)
+    {
+        int column_delta = cell % width - column;
+        int row_delta = cell / width - row;
+        int d = column_delta >= -1 && column_delta <= 1 && row_delta >= -1 && row_delta <= 1
+              ? Block_Directions[(column_delta + 1) * 3 + row_delta + 1] : -1;
+        if (d != -1)
+            neighbours |= 1 << d;
+        else
+            far_cells.push_back(cell);
+    }
+    return neighbours;
+}
+
+void ExpansionTrace::AppendStep(int expanded, bool is_backward, const std::vector<int> &opened,
+                                const std::vector<int> &reparented)
+{
+    if (!is_recording)
+        return;
+    steps_count++;
+    if (expanded == -1)
+    {
+        steps.push_back(0);
+        return;
+    }
+
+    unsigned char neighbours = NeighbourMask(expanded, width, opened, far_cells);
+    bool has_reparented = !reparented.empty();
+    WriteVarint(steps, (is_backward ? 2 : 1) | (neighbours != 0) << 2 | has_reparented << 3 |
+                       std::uint64_t(far_cells.size()) << 4);
+    WriteVarint(steps, ZigZag((long long)expanded - last_expanded));
+    if (neighbours != 0)
+        steps.push_back(neighbours);
+    for (int cell : far_cells)
+        WriteVarint(steps, ZigZag((long long)cell - expanded));
+
+    if (has_reparented)
+    {
+        steps.push_back(NeighbourMask(expanded, width, reparented, far_cells));
+        WriteVarint(steps, far_cells.size());
+        for (int cell : far_cells)
+            WriteVarint(steps, ZigZag((long long)cell - expanded));
+    }
+    last_expanded = expanded;
+}
+
+void ExpansionTrace::Finish(bool is_found, int cost, const std::vector<int> &found_path)
+{
+    if (!is_recording)
+        return;
+    is_recording = false;
+    path_found = is_found;
+    path_cost = cost;
+    path = found_path;
+}
+
+bool ExpansionTrace::IsRecording() const
+{
+    return is_recording;
+}
+
+// "ATRC", then varints: version, width, height, start + 1, destination + 1,
+// algorithm, path found, path cost, path cells count and the zigzag deltas
+// of the path cells starting from the start. Then the blocked cells as a
+// bitset, 8 cells per byte, and the costs of the free cells as (cost, run
+// length) pairs, random maps pack better than as runs of cells. Last the
+// steps count, the steps bytes count and the steps
+bool ExpansionTrace::Save(const std::string &file_path) const
+{
+    std::vector<unsigned char> bytes(Magic, Magic + sizeof(Magic));
+    WriteVarint(bytes, Format_Version);
+    WriteVarint(bytes, width);
+    WriteVarint(bytes, height);
+    WriteVarint(bytes, start + 1);
+    WriteVarint(bytes, destination + 1);
+    WriteVarint(bytes, algorithm);
+    WriteVarint(bytes, path_found);
+    WriteVarint(bytes, path_cost);
+    WriteVarint(bytes, path.size());
+    int previous = start;
+    for (int cell : path)
+    {
+        WriteVarint(bytes, ZigZag((long long)cell - previous));
+        previous = cell;
+    }
+
+    std::size_t blocked_offset = bytes.size();
+    bytes.resize(blocked_offset + (costs.size() + 7) / 8);
+    for (std::size_t i = blocked_offset; i < bytes.size(); i++)
+        bytes[i] = (unsigned char)(blocked[(i - blocked_offset) / 8] >> ((i - blocked_offset) % 8 * 8));
+
+    std::vector<unsigned char> free_costs;
+    for (std::size_t cell = 0; cell < costs.size(); cell++)
+        if (!((blocked[cell >> 6] >> (cell & 63)) & 1))
+            free_costs.push_back(costs[cell]);
+    for (std::size_t i = 0; i < free_costs.size();)
+    {
+        std::size_t run = 1;
+        while (i + run < free_costs.size() && free_costs[i + run] == free_costs[i])
+            run++;
+        bytes.push_back(free_costs[i]);
+        WriteVarint(bytes, run);
+        i += run;
+    }
+
+    WriteVarint(bytes, steps_count);
+    WriteVarint(bytes, steps.size());
+    bytes.insert(bytes.end(), steps.begin(), steps.end());
+
+    std::ofstream file(file_path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "ERROR: FAILED TO OPEN TRACE FILE: " << file_path << std::endl;
+        return false;
+    }
+    file.write((const char *)bytes.data(), bytes.size());
+    if (!file)
+    {
+        std::cout << "ERROR: FAILED TO WRITE TRACE FILE: " << file_path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ExpansionTrace::Load(const std::string &file_path)
+{
+    std::ifstream file(file_path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "ERROR: FAILED TO OPEN TRACE FILE: " << file_path << std::endl;
+        return false;
+    }
+    std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // a failed load leaves an empty trace rather than a half read one
+    if (!ReadFile(bytes, file_path))
+    {
+        *this = ExpansionTrace();
+        return false;
+    }
+    return true;
+}
+
+bool ExpansionTrace::ReadFile(const std::vector<unsigned char> &bytes, const std::string &file_path)
+{
+    if (bytes.size() < sizeof(Magic) || !std::equal(Magic, Magic + sizeof(Magic), bytes.begin()))
+    {
+        std::cout << "ERROR: NOT A TRACE FILE: " << file_path << std::endl;
+        return false;
+    }
+
+    std::size_t offset = sizeof(Magic);
+    int version;
+    if (!ReadInt(bytes, offset, version, false))
+    {
+        std::cout << "ERROR: TRACE FILE IS TRUNCATED: " << file_path << std::endl;
+        return false;
+    }
+    if (version != Format_Version)
+    {
+        std::cout << "ERROR: TRACE FORMAT VERSION " << version << " IS NOT SUPPORTED, EXPECTED " << int(Format_Version) << std::endl;
+        return false;
+    }
+
+    int found, path_count;
+    if (!ReadInt(bytes, offset, width, false) || !ReadInt(bytes, offset, height, false) ||
+        !ReadInt(bytes, offset, start, false) || !ReadInt(bytes, offset, destination, false) ||
+        !ReadInt(bytes, offset, algorithm, false) || !ReadInt(bytes, offset, found, false) ||
+        !ReadInt(bytes, offset, path_cost, false) || !ReadInt(bytes, offset, path_count, false))
+    {
+        std::cout << "ERROR: TRACE FILE IS TRUNCATED: " << file_path << std::endl;
+        return false;
+    }
+    start--;
+    destination--;
+    path_found = found != 0;
+
+    long long cells_count = (long long)width * height;
+    if (width < 1 || height < 1 || width > G_Max_Side || height > G_Max_Side ||
+        start < -1 || start >= cells_count || destination < -1 || destination >= cells_count ||
+        path_count < 0 || path_count > cells_count)
+    {
+        std::cout << "ERROR: BAD TRACE HEADER: " << file_path << std::endl;
+        return false;
+    }
+
+    path.resize(path_count);
+    int previous = start;
+    for (int &cell : path)
+    {
+        if (!ReadInt(bytes, offset, cell, true))
+        {
+            std::cout << "ERROR: TRACE FILE IS TRUNCATED: " << file_path << std::endl;
+            return false;
+        }
+        cell += previous;
+        previous = cell;
+        if (cell < 0 || cell >= cells_count)
+        {
+            std::cout << "ERROR: TRACE PATH LEAVES THE GRID: " << file_path << std::endl;
+            return false;
+        }
+    }
+
+    std::size_t bitset_bytes = std::size_t(cells_count + 7) / 8;
+    if (bytes.size() - offset < bitset_bytes)
+    {
+        std::cout << "ERROR: TRACE FILE IS TRUNCATED: " << file_path << std::endl;
+        return false;
+    }
+    // bits past the last cell are dropped
+    blocked.assign((cells_count + 63) / 64, 0);
+    costs.assign(cells_count, 1);
+    std::size_t free_count = 0;
+    for (long long cell = 0; cell < cells_count; cell++)
+    {
+        if (bytes[offset + cell / 8] & (1 << (cell % 8)))
+            blocked[cell >> 6] |= std::uint64_t(1) << (cell & 63);
+        else
+            free_count++;
+    }
+    offset += bitset_bytes;
+
+    // the runs of costs go over the free cells only
+    std::size_t costs_count = 0;
+    long long cell = 0;
+    while (costs_count < free_count && offset < bytes.size())
+    {
+        unsigned char cost = bytes[offset++];
+        std::uint64_t run;
+        if (cost == 0 || !ReadVarint(bytes, offset, run) || run == 0 || run > free_count - costs_count)
+            break;
+        for (std::uint64_t i = 0; i < run; cell++)
+        {
+            if (!((blocked[cell >> 6] >> (cell & 63)) & 1))
+            {
+                costs[cell] = cost;
+                i++;
+            }
+        }
+        costs_count += run;
+    }
+
+    std::uint64_t steps_size = 0;
+    std::uint64_t count = 0;
+    if (costs_count != free_count || !ReadVarint(bytes, offset, count) ||
+        !ReadVarint(bytes, offset, steps_size) || steps_size != bytes.size() - offset)
+    {
+        std::cout << "ERROR: TRACE FILE IS TRUNCATED: " << file_path << std::endl;
+        return false;
+    }
+    steps.assign(bytes.begin() + offset, bytes.end());
+    steps_count = count;
+    is_recording = false;
+
+    // every step is decoded once, so replays can trust the cells
+    std::size_t step_offset = 0;
+    int previous_expanded = start;
+    Step step;
+    std::size_t decoded = 0;
+    while (DecodeStep(step_offset, previous_expanded, step))
+        decoded++;
+    if (decoded != steps_count || step_offset != steps.size())
+    {
+        std::cout << "ERROR: CORRUPT TRACE STEPS: " << file_path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ExpansionTrace::RestoreGrid(Grid &grid) const
+{
+    grid.Resize(width, height, blocked.data());
+    grid.SetCosts(costs);
+    if (start != -1)
+        grid.SetStartCell(start);
+    if (destination != -1)
+        grid.SetDestinationCell(destination);
+}
+
+// appends the cells of a neighbour mask and count far cells to cells,
+// false if one is outside of the grid
+bool ExpansionTrace::DecodeCells(std::size_t &offset, int expanded, unsigned char neighbours, std::uint64_t far_count,
+                                 std::vector<int> &cells) const
+{
+    int column = expanded % width;
+    int row = expanded / width;
+    for (int d = 0; d < Grid::Directions_Count; d++)
+    {
+        if (!(neighbours & (1 << d)))
+            continue;
+        int next_column = column + Grid::Direction_Columns[d];
+        int next_row = row + Grid::Direction_Rows[d];
+        if (next_column < 0 || next_column >= width || next_row < 0 || next_row >= height)
+            return false;
+        cells.push_back(next_row * width + next_column);
+    }
+
+    long long cells_count = (long long)width * height;
+    for (; far_count > 0; far_count--)
+    {
+        int far_delta;
+        if (!ReadInt(steps, offset, far_delta, true))
+            return false;
+        long long cell = (long long)expanded + far_delta;
+        if (cell < 0 || cell >= cells_count)
+            return false;
+        cells.push_back(int(cell));
+    }
+    return true;
+}
+
+bool ExpansionTrace::DecodeStep(std::size_t &offset, int &previous_expanded, Step &step) const
+{
+    step.expanded = -1;
+    step.is_backward = false;
+    step.opened.clear();
+    step.reparented.clear();
+
+    std::uint64_t header;
+    if (offset >= steps.size() || !ReadVarint(steps, offset, header))
+        return false;
+    int side = int(header & 3);
+    if (side == 0)
+        return header == 0;
+    if (side == 3)
+        return false;
+
+    bool has_reparented = header & 8;
+    std::uint64_t far_count = header >> 4;
+
+    int delta;
+    bool has_neighbours = header & 4;
+    if (!ReadInt(steps, offset, delta, true) || (has_neighbours && offset >= steps.size()))
+        return false;
+    long long expanded = (long long)previous_expanded + delta;
+    if (expanded < 0 || expanded >= (long long)width * height)
+        return false;
+    step.expanded = int(expanded);
+    step.is_backward = side == 2;
+
+    unsigned char neighbours = has_neighbours ? steps[offset++] : 0;
+    if (has_neighbours && neighbours == 0)
+        return false;
+    if (!DecodeCells(offset, step.expanded, neighbours, far_count, step.opened))
+        return false;
+
+    if (has_reparented)
+    {
+        std::uint64_t reparented_far_count;
+        if (offset >= steps.size())
+            return false;
+        neighbours = steps[offset++];
+        if (!ReadVarint(steps, offset, reparented_far_count) ||
+            !DecodeCells(offset, step.expanded, neighbours, reparented_far_count, step.reparented))
+            return false;
+    }
+
+    previous_expanded = step.expanded;
+    return true;
+}
+
+int ExpansionTrace::Width() const
+{
+    return width;
+}
+
+int ExpansionTrace::Height() const
+{
+    return height;
+}
+
+int ExpansionTrace::Start() const
+{
+    return start;
+}
+
+int ExpansionTrace::Destination() const
+{
+    return destination;
+}
+
+int ExpansionTrace::AlgorithmIndex() const
+{
+    return algorithm;
+}
+
+std::size_t ExpansionTrace::StepsCount() const
+{
+    return steps_count;
+}
+
+std::size_t ExpansionTrace::StepsBytes() const
+{
+    return steps.size();
+}
+
+bool ExpansionTrace::PathFound() const
+{
+    return path_found;
+}
+
+int ExpansionTrace::PathCost() const
+{
+    return path_cost;
+}
+
+const std::vector<int>& ExpansionTrace::Path() const
+{
+    return path;
+}
@@ -0,0 +1,351 @@
+#include "flow_field.h"
+#include <algorithm>
+#include "jump_point_search.h"
+#include "instrumentation.h"
+
+// the direction tables are mirrored, d and 7 - d are opposite moves
+static int Opposite(int direction)
+{
+    return Grid::Directions_Count - 1 - direction;
+}
+
+FlowField::FlowField(const Grid *flowed_grid)
+{
+    grid = flowed_grid;
+}
+
+void FlowField::SetDestination(int cell)
+{
+    wanted_destination = cell;
+}
+
+int FlowField::DestinationCell() const
+{
+    return destination;
+}
+
+void FlowField::CellChanged(int cell)
+{
+    // an unbuilt field is built from scratch anyway
+    if (is_built)
+        pending_cells.push_back(cell);
+}
+
+void FlowField::SetDirection(int cell, int direction)
+{
+    std::uint64_t &word = directions[cell / Cells_Per_Word];
+    int shift = cell % Cells_Per_Word * 3;
+    word = (word & ~(std::uint64_t(7) << shift)) | (std::uint64_t(direction) << shift);
+}
+
+bool FlowField::IsInside(int cell, int direction) const
+{
+    return grid->Contains(grid->Column(cell) + Grid::Direction_Columns[direction],
+                          grid->Row(cell) + Grid::Direction_Rows[direction]);
+}
+
+int FlowField::BestStep(int cell, int &direction) const
+{
+    int best = Infinity;
+    unsigned char neighbours = grid->NeighbourMask(cell);
+    for (int d = 0; d < Grid::Directions_Count; d++)
+    {
+        int next = cell + grid->NeighbourOffset(d);
+        if (!(neighbours & (1 << d)) || distances[next] == Infinity)
+            continue;
+
+        int distance = distances[next] + JumpPointSearch::StepCost(d) * grid->Cost(next);
+        if (distance < best)
+        {
+            best = distance;
+            direction = d;
+        }
+    }
+    return best;
+}
+
+void FlowField::Build()
+{
+    std::size_t cells_count = grid->CellsCount();
+    directions.assign((cells_count + Cells_Per_Word - 1) / Cells_Per_Word, 0);
+    distances.assign(cells_count, Infinity);
+    max_distance = 0;
+    settled_count = 0;
+    was_rebuilt = true;
+    changed_cells.clear();
+    if (destination == -1)
+        return;
+
+    // Dial's algorithm like Landmarks::BuildTable, grown from the destination.
+    // Moves are symmetric, a cell reached in direction d steps back into the
+    // settled cell the opposite way and pays for entering it
+    if (buckets.empty())
+        buckets.resize(Grid::Diagonal_Cost * Grid::Max_Cost + 1);
+    distances[destination] = 0;
+    buckets[0].assign(1, destination);
+    std::size_t queued = 1;
+
+    for (int distance = 0; queued > 0; distance++)
+    {
+        std::vector<int> &bucket = buckets[distance % buckets.size()];
+        for (std::size_t b = 0; b < bucket.size(); b++)
+        {
+            int current = bucket[b];
+            if (distances[current] != distance)
+                continue; // reached again by a shorter path
+
+            settled_count++;
+            max_distance = distance;
+            unsigned char neighbours = grid->NeighbourMask(current);
+            int entering_cost = grid->Cost(current);
+            for (int d = 0; d < Grid::Directions_Count; d++)
+            {
+                if (!(neighbours & (1 << d)))
+                    continue;
+
+                int previous = current + grid->NeighbourOffset(d);
+                int previous_distance = distance + JumpPointSearch::StepCost(d) * entering_cost;
+                if (previous_distance >= distances[previous])
+                    continue;
+
+                distances[previous] = previous_distance;
+                SetDirection(previous, Opposite(d));
+                buckets[previous_distance % buckets.size()].push_back(previous);
+                queued++;
+            }
+        }
+        queued -= bucket.size();
+        bucket.clear();
+    }
+}
+
+void FlowField::Invalidate(int root)
+{
+    if (root == destination || distances[root] == Infinity)
+        return;
+
+    // every cell whose next step leads into an invalid cell is invalid too
+    distances[root] = Infinity;
+    invalid_cells.push_back(root);
+    for (std::size_t i = invalid_cells.size() - 1; i < invalid_cells.size(); i++)
+    {
+        int cell = invalid_cells[i];
+        changed_cells.push_back(cell);
+        for (int d = 0; d < Grid::Directions_Count; d++)
+        {
+            if (!IsInside(cell, d))
+                continue;
+
+            int previous = cell + grid->NeighbourOffset(d);
+            if (previous != destination && distances[previous] != Infinity && Direction(previous) == Opposite(d))
+            {
+                distances[previous] = Infinity;
+                invalid_cells.push_back(previous);
+            }
+        }
+    }
+}
+
+void FlowField::Repair()
+{
+    was_rebuilt = false;
+    changed_cells.clear();
+    settled_count = 0;
+    invalid_cells.clear();
+
+    // an edit changes the moves of its 3x3 block: the cells that stepped into
+    // the edited cell or along a diagonal it closed lose their paths, and with
+    // them all cells whose paths went through them
+    for (int cell : pending_cells)
+    {
+        for (int d = -1; d < Grid::Directions_Count; d++)
+        {
+            if (d != -1 && !IsInside(cell, d))
+                continue;
+
+            int around = d == -1 ? cell : cell + grid->NeighbourOffset(d);
+            if (around == destination || distances[around] == Infinity)
+                continue;
+
+            int direction = Direction(around);
+            if (!grid->IsFree(around) || !(grid->NeighbourMask(around) & (1 << direction)) ||
+                around + grid->NeighbourOffset(direction) == cell)
+                Invalidate(around);
+        }
+    }
+
+    // the invalid cells restart from their cheapest valid neighbour and the
+    // cells around the edits take the cheaper steps the edits opened, then
+    // Dijkstra's algorithm spreads the lower distances
+    queue.reserve(grid->CellsCount());
+    queue.clear();
+    auto seed = [this](int cell)
+    {
+        if (!grid->IsFree(cell))
+            return;
+
+        int direction;
+        int distance = cell == destination ? 0 : BestStep(cell, direction);
+        if (distance < distances[cell])
+        {
+            distances[cell] = distance;
+            SetDirection(cell, direction);
+            changed_cells.push_back(cell);
+        }
+        if (distances[cell] != Infinity)
+            queue.put(cell, distances[cell], distances[cell]);
+    };
+
+    for (int cell : invalid_cells)
+        seed(cell);
+    for (int cell : pending_cells)
+    {
+        seed(cell);
+        for (int d = 0; d < Grid::Directions_Count; d++)
+        {
+            if (IsInside(cell, d))
+                seed(cell + grid->NeighbourOffset(d));
+        }
+    }
+
+    while (!queue.empty())
+    {
+        int current = queue.get();
+        int distance = distances[current];
+        settled_count++;
+        max_distance = std::max(max_distance, distance);
+
+        unsigned char neighbours = grid->NeighbourMask(current);
+        int entering_cost = grid->Cost(current);
+        for (int d = 0; d < Grid::Directions_Count; d++)
+        {
+            if (!(neighbours & (1 << d)))
+                continue;
+
+            int previous = current + grid->NeighbourOffset(d);
+            int previous_distance = distance + JumpPointSearch::StepCost(d) * entering_cost;
+            if (previous_distance >= distances[previous])
+                continue;
+
+            distances[previous] = previous_distance;
+            SetDirection(previous, Opposite(d));
+            changed_cells.push_back(previous);
+            queue.put(previous, previous_distance, previous_distance);
+            ASTAR_COUNT(Open_List_Pushes, 1);
+        }
+    }
+}
+
+void FlowField::Update()
+{
+    int target = wanted_destination != -1 ? wanted_destination : grid->Destination();
+    if (target != -1 && (std::size_t(target) >= grid->CellsCount() || !grid->IsFree(target)))
+        target = -1;
+
+    // every edit bumps the grid version once, so the pending cells cover
+    // all edits exactly when the counts match
+    bool is_tracked = is_built && target == destination && built_cells_count == grid->CellsCount() &&
+                      grid->Version() == built_version + pending_cells.size();
+    if (is_tracked && pending_cells.empty())
+    {
+        was_rebuilt = false;
+        changed_cells.clear();
+        settled_count = 0;
+        return;
+    }
+
+    ASTAR_SCOPED_TIMER("flow_field_update");
+    if (is_tracked)
+        Repair();
+    else
+    {
+        destination = target;
+        Build();
+    }
+
+    pending_cells.clear();
+    is_built = true;
+    built_version = grid->Version();
+    built_cells_count = grid->CellsCount();
+}
+
+bool FlowField::IsBuilt() const
+{
+    return is_built;
+}
+
+bool FlowField::Fits(int cell) const
+{
+    // a field of a resized grid holds nothing until its update
+    return destination != -1 && built_cells_count == grid->CellsCount() &&
+           std::size_t(destination) < built_cells_count && cell >= 0 && std::size_t(cell) < built_cells_count;
+}
+
+bool FlowField::IsReachable(int cell) const
+{
+    // the component labels of the grid answer it, so agents only read the
+    // directions
+    return Fits(cell) && grid->AreConnected(cell, destination);
+}
+
+int FlowField::Direction(int cell) const
+{
+    if (!Fits(cell))
+        return 0;
+    return int(directions[cell / Cells_Per_Word] >> (cell % Cells_Per_Word * 3)) & 7;
+}
+
+int FlowField::NextCell(int cell) const
+{
+    if (cell == destination || !IsReachable(cell))
+        return -1;
+    return cell + grid->NeighbourOffset(Direction(cell));
+}
+
+int FlowField::Distance(int cell) const
+{
+    return Fits(cell) ? distances[cell] : int(Infinity);
+}
+
+int FlowField::MaxDistance() const
+{
+    return max_distance;
+}
+
+bool FlowField::Path(int cell, std::vector<int> &path) const
+{
+    path.clear();
+    if (!IsReachable(cell))
+        return false;
+    if (cell == destination)
+        return true;
+
+    // a field out of date could loop, no path is longer than the grid
+    for (int next = NextCell(cell); next != destination; next += grid->NeighbourOffset(Direction(next)))
+    {
+        path.push_back(next);
+        if (path.size() > grid->CellsCount())
+            return false;
+    }
+    return true;
+}
+
+bool FlowField::WasRebuilt() const
+{
+    return was_rebuilt;
+}
+
+const std::vector<int>& FlowField::ChangedCells() const
+{
+    return changed_cells;
+}
+
+std::size_t FlowField::SettledCount() const
+{
+    return settled_count;
+}
+
+std::size_t FlowField::MemoryBytes() const
+{
+    return directions.size() * sizeof(std::uint64_t) + distances.size() * sizeof(int);
+}
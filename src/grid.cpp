@@ -1,393 +1,447 @@
 #include "grid.h"
 #include <algorithm>
-#include <string>
+#include <cstring>
 
-#include "glad/glad.h"
+const int Grid::Direction_Columns[Grid::Directions_Count] = {-1, -1, -1,  0, 0,  1, 1, 1};
+const int Grid::Direction_Rows[Grid::Directions_Count]    = {-1,  0,  1, -1, 1, -1, 0, 1};
 
-Grid::Grid()
+Grid::Grid(int grid_width, int grid_height)
 {    
-    // set up cells
-    cells = std::vector<std::vector<Cell>>(G_Resolution_Side, std::vector<Cell>(G_Resolution_Side));
-    float half_cell_size = cell_size / 2.0f;
-
-    for (int i = 0; i < G_Resolution_Side; i++)
-    {
-        for (int j = 0; j < G_Resolution_Side; j++)
-        {
-            cells[i][j].center = {half_cell_size + i * cell_size,
-                                  half_cell_size + j * cell_size};
-            cells[i][j].grid_column = i;
-            cells[i][j].grid_row = j;
-        }
-    }
+    Resize(grid_width, grid_height);
 }
 
-void Grid::InitializeGrid()
+void Grid::Resize(int grid_width, int grid_height, const std::uint64_t *blocked_bits)
 {
-    // set of lines - all vertical or all horizontal lines
-    // each vertical line has ends coords (offset, -1) & (offset, 1)
-    // each horizontal line has ends coords (-1, offset) & (1, offset)
-    const int lines_count = G_Resolution_Side - 1;
-    float offsets[lines_count];
-    float ends[2] = {-1.0f, 1.0f};
+    width = grid_width;
+    height = grid_height;
+    start = -1;
+    destination = -1;
 
-    for (int i = 0; i < lines_count; i++)
-        offsets[i] = Normalized(cell_size * (i + 1));
+    for (int d = 0; d < Directions_Count; d++)
+        neighbour_offsets[d] = Direction_Rows[d] * width + Direction_Columns[d];
 
+    blocked.assign((CellsCount() + 63) / 64, 0);
+    if (blocked_bits && !blocked.empty())
+    {
+        std::copy(blocked_bits, blocked_bits + blocked.size(), blocked.begin());
+        // bits past the last cell stay clear
+        if (CellsCount() & 63)
+            blocked.back() &= (std::uint64_t(1) << (CellsCount() & 63)) - 1;
+    }
+    // every mask is written by the rebuild
+    neighbour_masks.resize(CellsCount());
+    RebuildNeighbourMasks();
+    ResetCosts();
+
+    regions_columns = (width + Region_Side - 1) / Region_Side;
+    regions_rows = (height + Region_Side - 1) / Region_Side;
+    region_versions.assign(std::size_t(regions_columns) * regions_rows, 0);
+    TouchAllRegions();
+}
 
-    glGenVertexArrays(1, &grid_vao);
-    glBindVertexArray(grid_vao);
+int Grid::Width() const
+{
+    return width;
+}
 
-    unsigned int VBO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(ends) + sizeof(offsets), NULL, GL_STATIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(ends), ends);
-    glBufferSubData(GL_ARRAY_BUFFER, sizeof(ends), sizeof(offsets), offsets);
+int Grid::Height() const
+{
+    return height;
+}
 
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
-    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)(sizeof(ends)));
-    glVertexAttribDivisor(1, 1);
+std::size_t Grid::CellsCount() const
+{
+    return std::size_t(width) * height;
+}
 
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+bool Grid::Contains(int column, int row) const
+{
+    return column >= 0 && column < width && row >= 0 && row < height;
 }
 
-void Grid::InitializeMainCells()
+int Grid::Index(int column, int row) const
 {
-    std::fill_n(start_data, 8, -1.0f);
-    std::fill_n(destination_data, 8, -1.0f);
+    return row * width + column;
+}
 
-    unsigned int indices[] =
-    {
-        0, 1, 2,
-        0, 2, 3
-    };
-    unsigned int EBO;
-    glGenBuffers(1, &EBO);
+int Grid::Column(int index) const
+{
+    return index % width;
+}
 
-    glGenVertexArrays(1, &start_vao);
-    glBindVertexArray(start_vao);
+int Grid::Row(int index) const
+{
+    return index / width;
+}
 
-    glGenBuffers(1, &start_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, start_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(start_data) + sizeof(start_color), NULL, GL_STATIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(start_data), start_data);
-    glBufferSubData(GL_ARRAY_BUFFER, sizeof(start_data), sizeof(start_color), start_color);
+Cell Grid::CellOf(int index) const
+{
+    return {Column(index), Row(index)};
+}
 
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (void*)0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, (void*)(sizeof(start_data)));
-    glVertexAttribDivisor(1, 1);
+bool Grid::IsFree(int index) const
+{
+    return !((blocked[index >> 6] >> (index & 63)) & 1);
+}
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+bool Grid::IsFree(int column, int row) const
+{
+    return IsFree(Index(column, row));
+}
 
-    glGenVertexArrays(1, &destination_vao);
-    glBindVertexArray(destination_vao);
+int Grid::Start() const
+{
+    return start;
+}
 
-    glGenBuffers(1, &destination_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, destination_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(destination_data) + sizeof(destination_color), NULL, GL_STATIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(destination_data), destination_data);
-    glBufferSubData(GL_ARRAY_BUFFER, sizeof(destination_data), sizeof(destination_color), destination_color);
-    
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (void*)0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, (void*)(sizeof(destination_data)));
-    glVertexAttribDivisor(1, 1);
+int Grid::Destination() const
+{
+    return destination;
+}
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+unsigned char Grid::NeighbourMask(int index) const
+{
+    return neighbour_masks[index];
+}
 
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+int Grid::NeighbourOffset(int direction) const
+{
+    return neighbour_offsets[direction];
 }
 
-void Grid::InitializeBlockedCells()
+unsigned char Grid::ComputeNeighbourMask(int column, int row) const
 {
-    std::size_t coords_s;
-    float *coords = NormalizedDefaultCellCoords(coords_s);
+    unsigned char mask = 0;
+    for (int d = 0; d < Directions_Count; d++)
+    {
+        int i = column + Direction_Columns[d];
+        int j = row + Direction_Rows[d];
+
+        if (!Contains(i, j) || !IsFree(i, j) ||
+            // can't move diagonally if desired cell is blocked by 2 neighbours
+            (i != column && j != row && !IsFree(i, row) && !IsFree(column, j)))
+            continue;
 
-    // by dafault no blocked cells should be drawn
-    // so offset pushes the quads outside the window
-    float offsets[2 * G_Resolution_Side * G_Resolution_Side];
-    std::fill_n(offsets, 2 * G_Resolution_Side * G_Resolution_Side, Normalized(-cell_size / 2.0f));   
+        mask |= 1 << d;
+    }
 
+    return mask;
+}
 
-    unsigned int indices[] =
+void Grid::UpdateNeighbourMasksAround(int index)
+{
+    // a cell takes part only in the moves of its 8 neighbours: either as
+    // the target or as one of the two cells a diagonal move squeezes between
+    int column = Column(index);
+    int row = Row(index);
+    for (int d = 0; d < Directions_Count; d++)
     {
-        0, 1, 2,
-        0, 2, 3
-    };
-    unsigned int EBO;
-    glGenBuffers(1, &EBO);
+        int i = column + Direction_Columns[d];
+        int j = row + Direction_Rows[d];
+        if (Contains(i, j))
+            neighbour_masks[Index(i, j)] = ComputeNeighbourMask(i, j);
+    }
+}
 
-    glGenVertexArrays(1, &blocked_cells_vao);
-    glBindVertexArray(blocked_cells_vao);
+// byte k of entry b is bit k of b, spreads 8 bits of a direction over 8 cells
+static const std::uint64_t *SpreadBits()
+{
+    static std::uint64_t spread[256];
+    static bool is_built = false;
+    if (is_built)
+        return spread;
 
-    glGenBuffers(1, &blocked_cells_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, blocked_cells_vbo);
-    glBufferData(GL_ARRAY_BUFFER, coords_s + sizeof(blocked_cells_color) + sizeof(offsets), NULL, GL_STATIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, coords_s, coords);
-    glBufferSubData(GL_ARRAY_BUFFER, coords_s, sizeof(blocked_cells_color), blocked_cells_color);
-    glBufferSubData(GL_ARRAY_BUFFER, coords_s + sizeof(blocked_cells_color), sizeof(offsets), offsets);
+    for (int bits = 0; bits < 256; bits++)
+    {
+        spread[bits] = 0;
+        for (int k = 0; k < 8; k++)
+            spread[bits] |= std::uint64_t((bits >> k) & 1) << (k * 8);
+    }
+    is_built = true;
+    return spread;
+}
 
-    delete[] coords;
+void Grid::RebuildNeighbourMasks()
+{
+    static const std::uint64_t *spread = SpreadBits();
 
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (void*)0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, (void*)coords_s);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (void*)(coords_s + sizeof(blocked_cells_color)));
-    glVertexAttribDivisor(1, G_Resolution_Side * G_Resolution_Side);
-    glVertexAttribDivisor(2, 1);
+    // 64 cells of a row at a time: free[r][c] holds the free bits of the
+    // cells one row and one column away (r, c = 0 before, 1 same, 2 after),
+    // then every direction is one and/or of them
+    for (int j = 0; j < height; j++)
+    {
+        std::size_t row_first = std::size_t(j) * width;
+        for (int column = 0; column < width; column += 64)
+        {
+            int cells = std::min(width - column, 64);
+            std::uint64_t in_row = cells == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << cells) - 1;
+            // neighbours one column before or after must still be in the row
+            std::uint64_t has_before = column == 0 ? in_row & ~std::uint64_t(1) : in_row;
+            std::uint64_t has_after = column + 64 >= width ? in_row >> 1 : in_row;
+
+            std::uint64_t free[3][3] = {};
+            for (int r = 0; r < 3; r++)
+            {
+                int row = j + r - 1;
+                if (row < 0 || row >= height)
+                    continue;
+                std::size_t first = std::size_t(row) * width + column;
+                free[r][0] = (first > 0 ? FreeBits(first - 1) : FreeBits(0) << 1) & has_before;
+                free[r][1] = FreeBits(first) & in_row;
+                free[r][2] = FreeBits(first + 1) & has_after;
+            }
+
+            std::uint64_t moves[Directions_Count];
+            for (int d = 0; d < Directions_Count; d++)
+            {
+                int c = Direction_Columns[d] + 1;
+                int r = Direction_Rows[d] + 1;
+                moves[d] = free[r][c];
+                // can't move diagonally if desired cell is blocked by 2 neighbours
+                if (c != 1 && r != 1)
+                    moves[d] &= free[1][c] | free[r][1];
+            }
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+            unsigned char *masks = neighbour_masks.data() + row_first + column;
+            for (int k = 0; k < cells; k += 8)
+            {
+                std::uint64_t bytes = 0;
+                for (int d = 0; d < Directions_Count; d++)
+                    bytes |= spread[(moves[d] >> k) & 0xff] << d;
+                std::memcpy(masks + k, &bytes, std::min(cells - k, 8));
+            }
+        }
+    }
 
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    // relabelled by the first query
+    components.Invalidate();
 }
 
-const Cell* Grid::Start() const
+void Grid::RemoveAllBlockedCells()
 {
-    return start;
+    std::fill(blocked.begin(), blocked.end(), 0);
+    RebuildNeighbourMasks();
 }
 
-const Cell* Grid::Destination() const
+int Grid::Component(int index) const
 {
-    return destination;
+    components.Update(*this);
+    return components.Label(index);
 }
 
-const float* Grid::StartColor() const
+std::size_t Grid::ComponentSize(int index) const
 {
-    return start_color;
+    components.Update(*this);
+    return components.Size(components.Label(index));
 }
 
-const float* Grid::DestinationColor() const
+bool Grid::AreConnected(int a, int b) const
 {
-    return destination_color;
+    if (!IsFree(a) || !IsFree(b))
+        return false;
+    components.Update(*this);
+    return components.Label(a) == components.Label(b);
 }
 
-void Grid::UpdateMainCellDataStorage(const Cell *cell, float *data_storage)
+int Grid::Cost(int index) const
 {
-    float half_cell_size = cell_size / 2.0f;
-    data_storage[0] = data_storage[2] = Normalized(cell->center.x - half_cell_size);
-    data_storage[4] = data_storage[6] = Normalized(cell->center.x + half_cell_size);
-    data_storage[1] = data_storage[7] = Normalized(cell->center.y - half_cell_size);
-    data_storage[3] = data_storage[5] = Normalized(cell->center.y + half_cell_size);
+    return costs[index];
 }
 
-void Grid::UpdateMainCellVbo(unsigned int &VBO, float *data, std::size_t data_size)
+const std::vector<std::uint64_t>& Grid::BlockedBits() const
 {
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, data_size, data);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return blocked;
 }
 
-void Grid::UpdateBlockedCellsVbo(float *data, std::size_t data_size, std::size_t offset)
+std::uint64_t Grid::FreeBits(std::size_t index) const
 {
-    // + 11 comes from the fact that in the blocked_cells_vbo coords (8 floats)
-    // and color (3 floats) of a single quad go first 
-    offset += sizeof(float) * 11;
-
-    glBindBuffer(GL_ARRAY_BUFFER, blocked_cells_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, offset, data_size, data);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (index >= CellsCount())
+        return 0;
+    std::size_t word = index >> 6;
+    int shift = index & 63;
+    std::uint64_t bits = blocked[word] >> shift;
+    if (shift != 0)
+        bits |= (word + 1 < blocked.size() ? blocked[word + 1] : ~std::uint64_t(0)) << (64 - shift);
+    // the tail of the last word is clear in the bitset
+    std::size_t remaining = CellsCount() - index;
+    if (remaining < 64)
+        bits |= ~std::uint64_t(0) << remaining;
+    return ~bits;
 }
 
-void Grid::RemoveStartCell()
+const std::vector<unsigned char>& Grid::Costs() const
 {
-    start = nullptr;
-    for (std::size_t i = 0; i < sizeof(start_data) / sizeof(float); i++)
-        start_data[i] = -1.0f;
-    UpdateMainCellVbo(start_vbo, start_data, sizeof(start_data));
+    return costs;
 }
 
-void Grid::RemoveDestinationCell()
+bool Grid::HasUniformCosts() const
 {
-    destination = nullptr;
-    for (std::size_t i = 0; i < sizeof(destination_data) / sizeof(float); i++)
-        destination_data[i] = -1.0f;
-    UpdateMainCellVbo(destination_vbo, destination_data, sizeof(destination_data));
+    return cost_counts[1] == CellsCount();
 }
 
-void Grid::RemoveAllBlockedCells()
+int Grid::MaxCost() const
 {
-    for (std::size_t i = 0; i < cells.size(); i++)
-        for (std::size_t j = 0; j < cells[i].size(); j++)
-            if (!cells[i][j].is_free)
-                cells[i][j].is_free = true;
-
-    float offsets[2 * G_Resolution_Side * G_Resolution_Side];
-    std::fill_n(offsets, 2 * G_Resolution_Side * G_Resolution_Side, Normalized(-cell_size / 2.0f));
-
-    UpdateBlockedCellsVbo(offsets, sizeof(offsets), 0);
+    int cost = Max_Cost;
+    while (cost > 1 && cost_counts[cost] == 0)
+        cost--;
+    return cost;
 }
 
-std::vector<Cell> Grid::ReachableFreeNeighbourCells(const Cell &cell) const
+void Grid::ResetCosts()
 {
-    std::vector<Cell> neighbours;
-    for (int i = cell.grid_column - 1; i <= cell.grid_column + 1; i++)
-    {
-        for (int j = cell.grid_row - 1; j <= cell.grid_row + 1; j++)
-        {
-            if (i < 0 || i >= G_Resolution_Side || 
-                j < 0 || j >= G_Resolution_Side || 
-                (i == cell.grid_column && j == cell.grid_row) || 
-                !cells[i][j].is_free ||
-                // can't move diagonally if desired cell is blocked by 2 neighbours
-                (i != cell.grid_column && j != cell.grid_row &&
-                !cells[i][cell.grid_row].is_free && !cells[cell.grid_column][j].is_free)
-            )
-                continue;
-
-            neighbours.push_back(cells[i][j]);
-        }
-    }
-
-    return neighbours;
+    costs.assign(CellsCount(), 1);
+    std::fill(cost_counts, cost_counts + Max_Cost + 1, 0);
+    cost_counts[1] = CellsCount();
 }
 
-Cell* Grid::FindCellAround(double position_x, double position_y)
+void Grid::SetStartCell(int index)
 {
-    float half_cell_size = cell_size / 2.0f;
+    if (start == index)
+        return;
 
-    std::vector<Cell>::iterator it;
-    for (int i = 0; i < G_Resolution_Side; i++)
-    {
-        it = std::find_if(cells[i].begin(), cells[i].end(),
-            [position_x, position_y, half_cell_size](const Cell &c)
-            {
-                return position_x >= c.center.x - half_cell_size &&
-                       position_x <= c.center.x + half_cell_size &&
-                       position_y >= c.center.y - half_cell_size &&
-                       position_y <= c.center.y + half_cell_size;
-            });
-        
-        if (it != cells[i].end())
-            break;
-    }
+    if (!IsFree(index))
+        RemoveBlockedCell(index);
+    else if (destination == index)
+        destination = -1;
 
-    return &(*it);
+    start = index;
 }
 
-float* Grid::NormalizedDefaultCellCoords(std::size_t &size) const
+void Grid::SetDestinationCell(int index)
 {
-    // square with center point (0, 0)
-    float half_cell = cell_size / 2.0f;
-    float center = float(W_Side) / 2.0f;
+    if (destination == index)
+        return;
 
-    float *coords = new float[8]
-    {
-        Normalized(center - half_cell), Normalized(center - half_cell),
-        Normalized(center - half_cell), Normalized(center + half_cell),
-        Normalized(center + half_cell), Normalized(center + half_cell),
-        Normalized(center + half_cell), Normalized(center - half_cell)
-    };
+    if (!IsFree(index))
+        RemoveBlockedCell(index);
+    else if (start == index)
+        start = -1;
 
-    size = 8 * sizeof(float);
-    return coords;
+    destination = index;
 }
 
-void Grid::SetStartCell(Cell *cell)
+void Grid::PlaceBlockedCell(int index)
 {
-    if (start == cell)
+    if (!IsFree(index))
         return;
 
-    if (!cell->is_free)
-        RemoveBlockedCell(cell);
-    else if (destination == cell)
-        RemoveDestinationCell();
+    if (start == index)
+        start = -1;
+    else if (destination == index)
+        destination = -1;
 
-    start = cell;
-    UpdateMainCellDataStorage(start, start_data);
-    UpdateMainCellVbo(start_vbo, start_data, sizeof(start_data));
+    blocked[index >> 6] |= std::uint64_t(1) << (index & 63);
+    UpdateNeighbourMasksAround(index);
+    components.CellBlocked(*this, index);
+    TouchRegionsAround(index);
 }
 
-void Grid::SetDestinationCell(Cell *cell)
+void Grid::RemoveBlockedCell(int index)
 {
-    if (destination == cell)
+    if (IsFree(index))
         return;
 
-    if (!cell->is_free)
-        RemoveBlockedCell(cell);
-    else if (start == cell)
-        RemoveStartCell();
+    blocked[index >> 6] &= ~(std::uint64_t(1) << (index & 63));
+    UpdateNeighbourMasksAround(index);
+    components.CellFreed(*this, index);
+    TouchRegionsAround(index);
+}
 
-    destination = cell;
-    UpdateMainCellDataStorage(destination, destination_data);
-    UpdateMainCellVbo(destination_vbo, destination_data, sizeof(destination_data));
+void Grid::SetOccupancy(const std::vector<unsigned char> &blocked_flags)
+{
+    std::fill(blocked.begin(), blocked.end(), 0);
+    for (std::size_t i = 0; i < blocked_flags.size() && i < CellsCount(); i++)
+        if (blocked_flags[i])
+            blocked[i >> 6] |= std::uint64_t(1) << (i & 63);
+
+    if (start != -1 && !IsFree(start))
+        start = -1;
+    if (destination != -1 && !IsFree(destination))
+        destination = -1;
+
+    RebuildNeighbourMasks();
+    TouchAllRegions();
 }
 
-void Grid::PlaceBlockedCell(Cell* cell)
+void Grid::SetCost(int index, int cost)
 {
-    if (!cell->is_free)
+    cost = std::min(std::max(cost, 1), int(Max_Cost));
+    if (costs[index] == cost)
         return;
 
-    if (start == cell)
-        RemoveStartCell();
-    else if (destination == cell)
-        RemoveDestinationCell();
-
-    cell->is_free = false;
-    float position[2] = {Normalized(cell->center.x), Normalized(cell->center.y)};
-    std::size_t offset = sizeof(float) * 2 * (cell->grid_row * G_Resolution_Side + cell->grid_column);
-
-    UpdateBlockedCellsVbo(position, sizeof(position), offset);
+    // the moves entering the cell change, they all start in its 3x3 block
+    cost_counts[costs[index]]--;
+    cost_counts[cost]++;
+    costs[index] = cost;
+    TouchRegionsAround(index);
 }
 
-void Grid::RemoveBlockedCell(Cell *cell)
+void Grid::SetCosts(const std::vector<unsigned char> &cell_costs)
 {
-    if (cell->is_free)
-        return;
-
-    cell->is_free = true;
-    float position[2] = {Normalized(-cell_size / 2.0f), Normalized(-cell_size / 2.0f)};
-    std::size_t offset = sizeof(float) * 2 * (cell->grid_row * G_Resolution_Side + cell->grid_column);
+    SetCosts(cell_costs.data(), cell_costs.size());
+}
 
-    UpdateBlockedCellsVbo(position, sizeof(position), offset);
+void Grid::SetCosts(const unsigned char *cell_costs, std::size_t count)
+{
+    count = std::min(count, CellsCount());
+    std::copy(cell_costs, cell_costs + count, costs.begin());
+    std::fill(costs.begin() + count, costs.end(), 1);
+    std::fill(cost_counts, cost_counts + Max_Cost + 1, 0);
+    for (unsigned char &cost : costs)
+    {
+        cost = std::max<unsigned char>(cost, 1);
+        cost_counts[cost]++;
+    }
+    TouchAllRegions();
 }
 
 void Grid::ClearAll()
 {
-    RemoveStartCell();
-    RemoveDestinationCell();
+    start = -1;
+    destination = -1;
     RemoveAllBlockedCells();
+    ResetCosts();
+    TouchAllRegions();
 }
 
-void Grid::DrawSetOfGridLines() const
+void Grid::TouchRegionsAround(int index)
 {
-    glBindVertexArray(grid_vao);
-    glDrawArraysInstanced(GL_LINES, 0, 2, G_Resolution_Side - 1);
-    glBindVertexArray(0);
+    version++;
+
+    // the block never spans more than 2x2 regions
+    int column = Column(index);
+    int row = Row(index);
+    int first_column = std::max(column - 1, 0) / Region_Side;
+    int last_column = std::min(column + 1, width - 1) / Region_Side;
+    int first_row = std::max(row - 1, 0) / Region_Side;
+    int last_row = std::min(row + 1, height - 1) / Region_Side;
+    for (int j = first_row; j <= last_row; j++)
+        for (int i = first_column; i <= last_column; i++)
+            region_versions[j * regions_columns + i] = version;
 }
 
-void Grid::DrawStart() const
+void Grid::TouchAllRegions()
 {
-    glBindVertexArray(start_vao);
-    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, 1);
-    glBindVertexArray(0);
+    version++;
+    std::fill(region_versions.begin(), region_versions.end(), version);
 }
 
-void Grid::DrawDestination() const
+std::uint64_t Grid::Version() const
 {
-    glBindVertexArray(destination_vao);
-    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, 1);
-    glBindVertexArray(0);
+    return version;
 }
 
-void Grid::DrawBlockedCells() const
+int Grid::RegionsColumns() const
 {
-    glBindVertexArray(blocked_cells_vao);
-    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, G_Resolution_Side * G_Resolution_Side);
-    glBindVertexArray(0);
-}
\ No newline at end of file
+    return regions_columns;
+}
+
+int Grid::RegionsRows() const
+{
+    return regions_rows;
+}
+
+std::uint64_t Grid::RegionVersion(int region_column, int region_row) const
+{
+    return region_versions[region_row * regions_columns + region_column];
+}
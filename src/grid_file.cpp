@@ -0,0 +1,390 @@
+#include "grid_file.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ASTAR_HAS_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char Magic[4] = {'A', 'G', 'R', 'D'};
+
+enum { Header_Size = 32, Layer_Entry_Size = 24 };
+enum { Occupancy_Layer = 1, Cost_Layer = 2 };
+enum { Raw_Encoding = 0, Runs_Encoding = 1 };
+
+// the bytes of a whole file, mapped where the platform allows it
+class MappedFile
+{
+    const unsigned char *data = nullptr;
+    std::size_t size = 0;
+#ifdef ASTAR_HAS_MMAP
+    void *mapping = nullptr;
+#endif
+    // read fallback, in words so raw layers stay 8-byte aligned
+    std::vector<std::uint64_t> buffer;
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile& operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    bool Open(const std::string &path);
+    const unsigned char* Data() const { return data; }
+    std::size_t Size() const { return size; }
+};
+
+MappedFile::~MappedFile()
+{
+#ifdef ASTAR_HAS_MMAP
+    if (mapping)
+        munmap(mapping, size);
+#endif
+}
+
+bool MappedFile::Open(const std::string &path)
+{
+#ifdef ASTAR_HAS_MMAP
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor == -1)
+        return false;
+    struct stat status;
+    if (fstat(descriptor, &status) == 0 && status.st_size > 0)
+    {
+        void *mapped = mmap(nullptr, std::size_t(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (mapped != MAP_FAILED)
+        {
+            mapping = mapped;
+            data = (const unsigned char *)mapped;
+            size = std::size_t(status.st_size);
+        }
+    }
+    close(descriptor);
+    if (mapping)
+        return true;
+#endif
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+    file.seekg(0, std::ios::end);
+    size = std::size_t(file.tellg());
+    file.seekg(0, std::ios::beg);
+    buffer.assign((size + 7) / 8, 0);
+    file.read((char *)buffer.data(), size);
+    data = (const unsigned char *)buffer.data();
+    return bool(file);
+}
+
+static bool IsLittleEndianHost()
+{
+    std::uint16_t one = 1;
+    unsigned char first;
+    std::memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+static std::uint64_t ReadLittleEndian(const unsigned char *bytes, int count)
+{
+    std::uint64_t value = 0;
+    for (int i = 0; i < count; i++)
+        value |= std::uint64_t(bytes[i]) << (i * 8);
+    return value;
+}
+
+static void WriteLittleEndian(std::vector<unsigned char> &bytes, std::uint64_t value, int count)
+{
+    for (int i = 0; i < count; i++)
+        bytes.push_back((unsigned char)(value >> (i * 8)));
+}
+
+static void WriteVarint(std::vector<unsigned char> &bytes, std::uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back((unsigned char)value);
+}
+
+static bool ReadVarint(const unsigned char *bytes, std::size_t end, std::size_t &offset, std::uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && offset < end; shift += 7)
+    {
+        unsigned char byte = bytes[offset++];
+        value |= std::uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+// sets bits [first, end), a word at a time
+static void SetBits(std::vector<std::uint64_t> &bits, std::size_t first, std::size_t end)
+{
+    while (first < end)
+    {
+        std::size_t count = std::min<std::size_t>(64 - (first & 63), end - first);
+        std::uint64_t mask = count == 64 ? ~std::uint64_t(0) : ((std::uint64_t(1) << count) - 1) << (first & 63);
+        bits[first >> 6] |= mask;
+        first += count;
+    }
+}
+
+static std::vector<unsigned char> RawOccupancy(const Grid &grid)
+{
+    std::vector<unsigned char> bytes;
+    bytes.reserve(grid.BlockedBits().size() * 8);
+    for (std::uint64_t word : grid.BlockedBits())
+        WriteLittleEndian(bytes, word, 8);
+    return bytes;
+}
+
+static std::vector<unsigned char> OccupancyRuns(const Grid &grid)
+{
+    std::vector<unsigned char> bytes;
+    bool is_blocked = false;
+    std::size_t run = 0;
+    for (std::size_t cell = 0; cell < grid.CellsCount(); cell++)
+    {
+        if (grid.IsFree(int(cell)) == is_blocked)
+        {
+            WriteVarint(bytes, run);
+            is_blocked = !is_blocked;
+            run = 0;
+        }
+        run++;
+    }
+    WriteVarint(bytes, run);
+    return bytes;
+}
+
+static std::vector<unsigned char> CostRuns(const Grid &grid)
+{
+    const std::vector<unsigned char> &costs = grid.Costs();
+    std::vector<unsigned char> bytes;
+    for (std::size_t i = 0; i < costs.size();)
+    {
+        std::size_t run = 1;
+        while (i + run < costs.size() && costs[i + run] == costs[i])
+            run++;
+        bytes.push_back(costs[i]);
+        WriteVarint(bytes, run);
+        i += run;
+    }
+    return bytes;
+}
+
+bool SaveGridFile(const std::string &path, const Grid &grid)
+{
+    struct Layer
+    {
+        int kind;
+        int encoding;
+        std::vector<unsigned char> bytes;
+    };
+    std::vector<Layer> layers;
+
+    std::vector<unsigned char> runs = OccupancyRuns(grid);
+    if (runs.size() < grid.BlockedBits().size() * 8)
+        layers.push_back({Occupancy_Layer, Runs_Encoding, std::move(runs)});
+    else
+        layers.push_back({Occupancy_Layer, Raw_Encoding, RawOccupancy(grid)});
+
+    if (!grid.HasUniformCosts())
+    {
+        runs = CostRuns(grid);
+        if (runs.size() < grid.CellsCount())
+            layers.push_back({Cost_Layer, Runs_Encoding, std::move(runs)});
+        else
+            layers.push_back({Cost_Layer, Raw_Encoding, grid.Costs()});
+    }
+
+    std::vector<unsigned char> bytes(Magic, Magic + sizeof(Magic));
+    WriteLittleEndian(bytes, Grid_File_Version, 4);
+    WriteLittleEndian(bytes, grid.Width(), 4);
+    WriteLittleEndian(bytes, grid.Height(), 4);
+    WriteLittleEndian(bytes, std::uint32_t(grid.Start()), 4);
+    WriteLittleEndian(bytes, std::uint32_t(grid.Destination()), 4);
+    WriteLittleEndian(bytes, layers.size(), 4);
+    WriteLittleEndian(bytes, 0, 4);
+
+    std::size_t offset = Header_Size + layers.size() * Layer_Entry_Size;
+    for (const Layer &layer : layers)
+    {
+        offset = (offset + 7) & ~std::size_t(7);
+        WriteLittleEndian(bytes, layer.kind, 4);
+        WriteLittleEndian(bytes, layer.encoding, 4);
+        WriteLittleEndian(bytes, offset, 8);
+        WriteLittleEndian(bytes, layer.bytes.size(), 8);
+        offset += layer.bytes.size();
+    }
+    for (const Layer &layer : layers)
+    {
+        bytes.resize((bytes.size() + 7) & ~std::size_t(7), 0);
+        bytes.insert(bytes.end(), layer.bytes.begin(), layer.bytes.end());
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "ERROR: FAILED TO OPEN GRID FILE: " << path << std::endl;
+        return false;
+    }
+    file.write((const char *)bytes.data(), bytes.size());
+    if (!file)
+    {
+        std::cout << "ERROR: FAILED TO WRITE GRID FILE: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool LoadGridFile(const std::string &path, Grid &grid)
+{
+    MappedFile file;
+    if (!file.Open(path))
+    {
+        std::cout << "ERROR: FAILED TO OPEN GRID FILE: " << path << std::endl;
+        return false;
+    }
+    const unsigned char *data = file.Data();
+    std::size_t size = file.Size();
+    if (size < Header_Size || !std::equal(Magic, Magic + sizeof(Magic), data))
+    {
+        std::cout << "ERROR: NOT A GRID FILE: " << path << std::endl;
+        return false;
+    }
+
+    std::uint64_t version = ReadLittleEndian(data + 4, 4);
+    if (version > Grid_File_Version)
+    {
+        std::cout << "ERROR: GRID FILE VERSION " << version << " IS NEWER THAN " << int(Grid_File_Version) << ": " << path << std::endl;
+        return false;
+    }
+
+    std::uint64_t width = ReadLittleEndian(data + 8, 4);
+    std::uint64_t height = ReadLittleEndian(data + 12, 4);
+    int start = int(std::int32_t(ReadLittleEndian(data + 16, 4)));
+    int destination = int(std::int32_t(ReadLittleEndian(data + 20, 4)));
+    std::uint64_t layers_count = ReadLittleEndian(data + 24, 4);
+    std::size_t cells_count = std::size_t(width * height);
+    if (version == 0 || width < 1 || height < 1 || width > G_Max_Side || height > G_Max_Side ||
+        start < -1 || start >= int(cells_count) || destination < -1 || destination >= int(cells_count) ||
+        layers_count > (size - Header_Size) / Layer_Entry_Size)
+    {
+        std::cout << "ERROR: BAD GRID FILE HEADER: " << path << std::endl;
+        return false;
+    }
+
+    // raw layers are used in place, runs are decoded into these
+    std::size_t words_count = (cells_count + 63) / 64;
+    const std::uint64_t *blocked_bits = nullptr;
+    std::vector<std::uint64_t> decoded_bits;
+    const unsigned char *costs = nullptr;
+    std::vector<unsigned char> decoded_costs;
+    for (std::size_t layer = 0; layer < layers_count; layer++)
+    {
+        const unsigned char *entry = data + Header_Size + layer * Layer_Entry_Size;
+        std::uint64_t kind = ReadLittleEndian(entry, 4);
+        std::uint64_t encoding = ReadLittleEndian(entry + 4, 4);
+        std::uint64_t offset = ReadLittleEndian(entry + 8, 8);
+        std::uint64_t layer_size = ReadLittleEndian(entry + 16, 8);
+        if (kind != Occupancy_Layer && kind != Cost_Layer)
+            continue;
+
+        bool is_valid = offset <= size && layer_size <= size - offset && (encoding == Raw_Encoding || encoding == Runs_Encoding);
+        std::size_t end = std::size_t(offset + layer_size);
+        if (is_valid && kind == Occupancy_Layer && encoding == Raw_Encoding)
+        {
+            is_valid = layer_size == words_count * 8 && offset % 8 == 0;
+            if (is_valid && IsLittleEndianHost())
+                blocked_bits = (const std::uint64_t *)(data + offset);
+            else if (is_valid)
+            {
+                decoded_bits.resize(words_count);
+                for (std::size_t w = 0; w < words_count; w++)
+                    decoded_bits[w] = ReadLittleEndian(data + offset + w * 8, 8);
+                blocked_bits = decoded_bits.data();
+            }
+        }
+        else if (is_valid && kind == Occupancy_Layer)
+        {
+            decoded_bits.assign(words_count, 0);
+            std::size_t cell = 0;
+            bool is_blocked = false;
+            std::size_t position = std::size_t(offset);
+            std::uint64_t run;
+            while (is_valid && position < end)
+            {
+                is_valid = ReadVarint(data, end, position, run) && run <= cells_count - cell;
+                if (is_valid && is_blocked)
+                    SetBits(decoded_bits, cell, cell + std::size_t(run));
+                cell += is_valid ? std::size_t(run) : 0;
+                is_blocked = !is_blocked;
+            }
+            is_valid = is_valid && cell == cells_count;
+            blocked_bits = decoded_bits.data();
+        }
+        else if (is_valid && encoding == Raw_Encoding)
+        {
+            is_valid = layer_size == cells_count;
+            costs = data + offset;
+        }
+        else if (is_valid)
+        {
+            decoded_costs.resize(cells_count);
+            std::size_t cell = 0;
+            std::size_t position = std::size_t(offset);
+            std::uint64_t run;
+            while (is_valid && position < end)
+            {
+                unsigned char cost = data[position++];
+                is_valid = ReadVarint(data, end, position, run) && run <= cells_count - cell;
+                if (is_valid)
+                    std::fill(decoded_costs.begin() + cell, decoded_costs.begin() + cell + std::size_t(run), cost);
+                cell += is_valid ? std::size_t(run) : 0;
+            }
+            is_valid = is_valid && cell == cells_count;
+            costs = decoded_costs.data();
+        }
+
+        if (!is_valid)
+        {
+            std::cout << "ERROR: BAD GRID FILE LAYER " << layer << ": " << path << std::endl;
+            return false;
+        }
+    }
+
+    if (!blocked_bits)
+    {
+        std::cout << "ERROR: GRID FILE HAS NO OCCUPANCY LAYER: " << path << std::endl;
+        return false;
+    }
+
+    grid.Resize(int(width), int(height), blocked_bits);
+    if (costs)
+        grid.SetCosts(costs, cells_count);
+    if (start != -1)
+        grid.SetStartCell(start);
+    if (destination != -1)
+        grid.SetDestinationCell(destination);
+    return true;
+}
+
+bool IsGridFile(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(Magic)];
+    return file.read(magic, sizeof(magic)) && std::equal(Magic, Magic + sizeof(Magic), magic);
+}
@@ -0,0 +1,543 @@
+#include "hierarchy.h"
+#include <algorithm>
+#include <cstdlib>
+#include "jump_point_search.h"
+#include "search_policies.h"
+#include "instrumentation.h"
+
+Hierarchy::Hierarchy(const Grid *abstracted_grid, int side)
+{
+    grid = abstracted_grid;
+    cluster_side = side;
+    buckets.resize(Grid::Diagonal_Cost * Grid::Max_Cost + 1);
+}
+
+bool Hierarchy::IsBuilt() const
+{
+    return !clusters.empty() && built_width == grid->Width() && built_height == grid->Height();
+}
+
+int Hierarchy::ClusterSide() const
+{
+    return cluster_side;
+}
+
+std::size_t Hierarchy::NodesCount() const
+{
+    return nodes.size() - free_nodes.size();
+}
+
+int Hierarchy::ClusterOf(int cell) const
+{
+    return (grid->Row(cell) / cluster_side) * clusters_columns + grid->Column(cell) / cluster_side;
+}
+
+int Hierarchy::FindNode(int cluster_index, int cell) const
+{
+    for (int id : clusters[cluster_index].nodes)
+    {
+        if (nodes[id].cell == cell)
+            return id;
+    }
+    return -1;
+}
+
+int Hierarchy::VerticalBorder(int cluster_column, int cluster_row) const
+{
+    return cluster_row * (clusters_columns - 1) + cluster_column;
+}
+
+int Hierarchy::HorizontalBorder(int cluster_column, int cluster_row) const
+{
+    return (clusters_columns - 1) * clusters_rows + cluster_row * clusters_columns + cluster_column;
+}
+
+void Hierarchy::Build()
+{
+    ASTAR_SCOPED_TIMER("hierarchy_build");
+    built_width = grid->Width();
+    built_height = grid->Height();
+    clusters_columns = (built_width + cluster_side - 1) / cluster_side;
+    clusters_rows = (built_height + cluster_side - 1) / cluster_side;
+
+    clusters.assign(clusters_columns * clusters_rows, Cluster());
+    for (int j = 0; j < clusters_rows; j++)
+    {
+        for (int i = 0; i < clusters_columns; i++)
+        {
+            Cluster &cluster = clusters[j * clusters_columns + i];
+            cluster.first_column = i * cluster_side;
+            cluster.first_row = j * cluster_side;
+            cluster.width = std::min(cluster_side, built_width - cluster.first_column);
+            cluster.height = std::min(cluster_side, built_height - cluster.first_row);
+        }
+    }
+
+    borders.clear();
+    for (int j = 0; j < clusters_rows; j++)
+    {
+        for (int i = 0; i + 1 < clusters_columns; i++)
+        {
+            const Cluster &left = clusters[j * clusters_columns + i];
+            Border border;
+            border.first_cell = grid->Index(left.first_column + left.width - 1, left.first_row);
+            border.along = built_width;
+            border.across = 1;
+            border.length = left.height;
+            border.clusters[0] = j * clusters_columns + i;
+            border.clusters[1] = j * clusters_columns + i + 1;
+            borders.push_back(border);
+        }
+    }
+    for (int j = 0; j + 1 < clusters_rows; j++)
+    {
+        for (int i = 0; i < clusters_columns; i++)
+        {
+            const Cluster &lower = clusters[j * clusters_columns + i];
+            Border border;
+            border.first_cell = grid->Index(lower.first_column, lower.first_row + lower.height - 1);
+            border.along = 1;
+            border.across = built_width;
+            border.length = lower.width;
+            border.clusters[0] = j * clusters_columns + i;
+            border.clusters[1] = (j + 1) * clusters_columns + i;
+            borders.push_back(border);
+        }
+    }
+
+    nodes.clear();
+    free_nodes.clear();
+
+    for (Border &border : borders)
+        BuildBorder(border);
+    for (std::size_t i = 0; i < clusters.size(); i++)
+        BuildCluster(i);
+}
+
+void Hierarchy::UpdateCell(int cell)
+{
+    if (!IsBuilt())
+        return;
+
+    int cluster_index = ClusterOf(cell);
+    const Cluster &cluster = clusters[cluster_index];
+    int cluster_column = cluster_index % clusters_columns;
+    int cluster_row = cluster_index / clusters_columns;
+    int column = grid->Column(cell) - cluster.first_column;
+    int row = grid->Row(cell) - cluster.first_row;
+
+    std::vector<int> touched_borders;
+    if (column == 0 && cluster_column > 0)
+        touched_borders.push_back(VerticalBorder(cluster_column - 1, cluster_row));
+    if (column == cluster.width - 1 && cluster_column + 1 < clusters_columns)
+        touched_borders.push_back(VerticalBorder(cluster_column, cluster_row));
+    if (row == 0 && cluster_row > 0)
+        touched_borders.push_back(HorizontalBorder(cluster_column, cluster_row - 1));
+    if (row == cluster.height - 1 && cluster_row + 1 < clusters_rows)
+        touched_borders.push_back(HorizontalBorder(cluster_column, cluster_row));
+
+    std::vector<int> touched_clusters = {cluster_index};
+    for (int border : touched_borders)
+    {
+        BuildBorder(borders[border]);
+        touched_clusters.push_back(borders[border].clusters[0]);
+        touched_clusters.push_back(borders[border].clusters[1]);
+    }
+
+    std::sort(touched_clusters.begin(), touched_clusters.end());
+    touched_clusters.erase(std::unique(touched_clusters.begin(), touched_clusters.end()), touched_clusters.end());
+    for (int i : touched_clusters)
+        BuildCluster(i);
+}
+
+void Hierarchy::BuildBorder(Border &border)
+{
+    border.transitions.clear();
+
+    int run_begin = -1;
+    for (int i = 0; i <= border.length; i++)
+    {
+        int cell = border.first_cell + i * border.along;
+        bool is_open = i < border.length && grid->IsFree(cell) && grid->IsFree(cell + border.across);
+
+        if (is_open && run_begin == -1)
+        {
+            run_begin = i;
+        }
+        else if (!is_open && run_begin != -1)
+        {
+            int run_end = i - 1;
+            if (run_end - run_begin + 1 < Max_Single_Transition_Run)
+            {
+                int middle = border.first_cell + (run_begin + run_end) / 2 * border.along;
+                border.transitions.push_back(middle);
+                border.transitions.push_back(middle + border.across);
+            }
+            else
+            {
+                for (int end : {run_begin, run_end})
+                {
+                    border.transitions.push_back(border.first_cell + end * border.along);
+                    border.transitions.push_back(border.first_cell + end * border.along + border.across);
+                }
+            }
+            run_begin = -1;
+        }
+    }
+}
+
+void Hierarchy::BuildCluster(int cluster_index)
+{
+    Cluster &cluster = clusters[cluster_index];
+    int cluster_column = cluster_index % clusters_columns;
+    int cluster_row = cluster_index / clusters_columns;
+
+    for (int id : cluster.nodes)
+    {
+        nodes[id].cell = -1;
+        free_nodes.push_back(id);
+    }
+    cluster.nodes.clear();
+
+    // transitions store the cell of the left/lower cluster first
+    std::vector<int> cells;
+    auto collect = [&](int border, int side)
+    {
+        const std::vector<int> &transitions = borders[border].transitions;
+        for (std::size_t i = side; i < transitions.size(); i += 2)
+            cells.push_back(transitions[i]);
+    };
+    if (cluster_column > 0)
+        collect(VerticalBorder(cluster_column - 1, cluster_row), 1);
+    if (cluster_column + 1 < clusters_columns)
+        collect(VerticalBorder(cluster_column, cluster_row), 0);
+    if (cluster_row > 0)
+        collect(HorizontalBorder(cluster_column, cluster_row - 1), 1);
+    if (cluster_row + 1 < clusters_rows)
+        collect(HorizontalBorder(cluster_column, cluster_row), 0);
+
+    // a corner cell can be a transition of two borders
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+    for (int cell : cells)
+    {
+        Node node = {cell, cluster_index, int(cluster.nodes.size())};
+        if (free_nodes.empty())
+        {
+            cluster.nodes.push_back(nodes.size());
+            nodes.push_back(node);
+        }
+        else
+        {
+            cluster.nodes.push_back(free_nodes.back());
+            nodes[free_nodes.back()] = node;
+            free_nodes.pop_back();
+        }
+    }
+
+    // moves are symmetric, but their costs only while every cell of the
+    // cluster costs the same: then one search per node fills its row and column
+    bool is_symmetric = true;
+    for (int j = 0; j < cluster.height && is_symmetric; j++)
+        for (int i = 0; i < cluster.width && is_symmetric; i++)
+            is_symmetric = grid->Cost(grid->Index(cluster.first_column + i, cluster.first_row + j)) == 1;
+
+    std::size_t k = cells.size();
+    cluster.distances.assign(k * k, -1);
+    for (std::size_t i = 0; i < k; i++)
+    {
+        cluster.distances[i * k + i] = 0;
+        if (is_symmetric && i + 1 == k)
+            break;
+
+        ClusterDistances(cluster, cells[i]);
+        for (std::size_t j = is_symmetric ? i + 1 : 0; j < k; j++)
+        {
+            if (j == i)
+                continue;
+
+            int local = (grid->Row(cells[j]) - cluster.first_row) * cluster.width + grid->Column(cells[j]) - cluster.first_column;
+            cluster.distances[i * k + j] = local_distances[local];
+            if (is_symmetric)
+                cluster.distances[j * k + i] = local_distances[local];
+        }
+    }
+}
+
+void Hierarchy::ClusterDistances(const Cluster &cluster, int source)
+{
+    // Dial's algorithm: a step costs at most Diagonal_Cost * Max_Cost, so that
+    // many rotating buckets plus one hold every queued distance
+    local_distances.assign(std::size_t(cluster.width) * cluster.height, -1);
+    int source_local = (grid->Row(source) - cluster.first_row) * cluster.width + grid->Column(source) - cluster.first_column;
+    local_distances[source_local] = 0;
+    buckets[0].assign(1, source_local);
+    std::size_t queued = 1;
+
+    for (int distance = 0; queued > 0; distance++)
+    {
+        std::vector<int> &bucket = buckets[distance % buckets.size()];
+        for (std::size_t b = 0; b < bucket.size(); b++)
+        {
+            int current = bucket[b];
+            if (local_distances[current] != distance)
+                continue; // reached again by a shorter path
+
+            int column = current % cluster.width;
+            int row = current / cluster.width;
+            unsigned char neighbours = grid->NeighbourMask(grid->Index(cluster.first_column + column, cluster.first_row + row));
+            for (int d = 0; d < Grid::Directions_Count; d++)
+            {
+                int next_column = column + Grid::Direction_Columns[d];
+                int next_row = row + Grid::Direction_Rows[d];
+                if (!(neighbours & (1 << d)) || next_column < 0 || next_column >= cluster.width ||
+                    next_row < 0 || next_row >= cluster.height)
+                    continue;
+
+                int next = next_row * cluster.width + next_column;
+                int next_cost = grid->Cost(grid->Index(cluster.first_column + next_column, cluster.first_row + next_row));
+                int next_distance = distance + JumpPointSearch::StepCost(d) * next_cost;
+                if (local_distances[next] != -1 && local_distances[next] <= next_distance)
+                    continue;
+
+                local_distances[next] = next_distance;
+                buckets[next_distance % buckets.size()].push_back(next);
+                queued++;
+            }
+        }
+        queued -= bucket.size();
+        bucket.clear();
+    }
+}
+
+void Hierarchy::ClusterSearch(const Cluster &cluster, int source, int target, SearchArena &arena, bool is_reversed) const
+{
+    // the arena is indexed by the position of the cell inside the cluster
+    auto local = [&cluster](int column, int row) { return (row - cluster.first_row) * cluster.width + column - cluster.first_column; };
+    int target_column = target == -1 ? 0 : grid->Column(target);
+    int target_row = target == -1 ? 0 : grid->Row(target);
+
+    arena.Reset();
+    int source_local = local(grid->Column(source), grid->Row(source));
+    arena.Open(source_local, -1, 0);
+    arena.opened.put(source_local, 0, 0);
+
+    while (!arena.opened.empty())
+    {
+        int current = arena.opened.get();
+        int column = cluster.first_column + current % cluster.width;
+        int row = cluster.first_row + current / cluster.width;
+        if (column == target_column && row == target_row && target != -1)
+            return;
+
+        arena.Close(current);
+        unsigned char neighbours = grid->NeighbourMask(grid->Index(column, row));
+        int g_cost = arena.GCost(current);
+
+        for (int d = 0; d < Grid::Directions_Count; d++)
+        {
+            if (!(neighbours & (1 << d)))
+                continue;
+
+            int next_column = column + Grid::Direction_Columns[d];
+            int next_row = row + Grid::Direction_Rows[d];
+            if (next_column < cluster.first_column || next_column >= cluster.first_column + cluster.width ||
+                next_row < cluster.first_row || next_row >= cluster.first_row + cluster.height)
+                continue;
+
+            // a reversed search walks the moves backwards and pays for the cell they leave
+            int next = local(next_column, next_row);
+            int paid_cell = is_reversed ? grid->Index(column, row) : grid->Index(next_column, next_row);
+            int next_g_cost = g_cost + JumpPointSearch::StepCost(d) * grid->Cost(paid_cell);
+            SearchArena::NodeState state = arena.State(next);
+            if (state == SearchArena::Closed || (state == SearchArena::Opened && next_g_cost >= arena.GCost(next)))
+                continue;
+
+            int h_cost = target == -1 ? 0 : OctileHeuristic::Estimate(abs(next_column - target_column), abs(next_row - target_row));
+            arena.Open(next, current, next_g_cost);
+            arena.opened.put(next, next_g_cost + h_cost, h_cost);
+        }
+    }
+}
+
+void Hierarchy::AppendClusterPath(const Cluster &cluster, int from, int to, SearchArena &arena, std::vector<int> &cells) const
+{
+    ClusterSearch(cluster, from, to, arena);
+
+    std::size_t first = cells.size();
+    int local = (grid->Row(to) - cluster.first_row) * cluster.width + grid->Column(to) - cluster.first_column;
+    for (; arena.Parent(local) != -1; local = arena.Parent(local))
+        cells.push_back(grid->Index(cluster.first_column + local % cluster.width, cluster.first_row + local / cluster.width));
+    std::reverse(cells.begin() + first, cells.end());
+}
+
+void Hierarchy::AbstractEdges(std::vector<int> &cell_pairs) const
+{
+    cell_pairs.clear();
+
+    for (const Cluster &cluster : clusters)
+    {
+        std::size_t k = cluster.nodes.size();
+        for (std::size_t i = 0; i < k; i++)
+        {
+            for (std::size_t j = i + 1; j < k; j++)
+            {
+                if (cluster.distances[i * k + j] < 0)
+                    continue;
+                cell_pairs.push_back(nodes[cluster.nodes[i]].cell);
+                cell_pairs.push_back(nodes[cluster.nodes[j]].cell);
+            }
+        }
+    }
+
+    for (const Border &border : borders)
+        cell_pairs.insert(cell_pairs.end(), border.transitions.begin(), border.transitions.end());
+}
+
+bool Hierarchy::FindPath(int start, int destination, SearchArena &cell_arena, SearchArena &node_arena,
+                         std::vector<int> &path, int &path_cost, std::size_t &expanded) const
+{
+    path.resize(0);
+    path_cost = 0;
+    expanded = 0;
+
+    if (!IsBuilt() || start == -1 || destination == -1 || !grid->IsFree(start) || !grid->IsFree(destination))
+        return false;
+
+    if (cell_arena.Size() != std::size_t(cluster_side) * cluster_side)
+        cell_arena.Resize(std::size_t(cluster_side) * cluster_side);
+    if (node_arena.Size() != nodes.size() + 2)
+        node_arena.Resize(nodes.size() + 2);
+
+    // start and destination join the abstract graph as two extra nodes linked
+    // to the nodes of their clusters (and to each other if they share one)
+    int start_cluster = ClusterOf(start);
+    int destination_cluster = ClusterOf(destination);
+    const Cluster &first = clusters[start_cluster];
+    const Cluster &last = clusters[destination_cluster];
+    auto local_distance = [&](const Cluster &cluster, int cell)
+    {
+        int local = (grid->Row(cell) - cluster.first_row) * cluster.width + grid->Column(cell) - cluster.first_column;
+        return cell_arena.State(local) == SearchArena::Closed ? cell_arena.GCost(local) : -1;
+    };
+
+    ClusterSearch(last, destination, -1, cell_arena, true);
+    std::vector<int> to_destination;
+    for (int id : last.nodes)
+        to_destination.push_back(local_distance(last, nodes[id].cell));
+    int direct = start_cluster == destination_cluster ? local_distance(last, start) : -1;
+
+    ClusterSearch(first, start, -1, cell_arena);
+    std::vector<int> from_start;
+    for (int id : first.nodes)
+        from_start.push_back(local_distance(first, nodes[id].cell));
+
+    int start_id = nodes.size();
+    int destination_id = nodes.size() + 1;
+    auto node_cell = [&](int id) { return id == start_id ? start : (id == destination_id ? destination : nodes[id].cell); };
+    auto open = [&](int id, int parent, int g_cost)
+    {
+        SearchArena::NodeState state = node_arena.State(id);
+        if (state == SearchArena::Closed || (state == SearchArena::Opened && g_cost >= node_arena.GCost(id)))
+            return;
+
+        int cell = node_cell(id);
+        int h_cost = OctileHeuristic::Estimate(abs(grid->Column(cell) - grid->Column(destination)),
+                                               abs(grid->Row(cell) - grid->Row(destination)));
+        node_arena.Open(id, parent, g_cost);
+        node_arena.opened.put(id, g_cost + h_cost, h_cost);
+    };
+
+    node_arena.Reset();
+    open(start_id, -1, 0);
+
+    bool found = false;
+    while (!node_arena.opened.empty())
+    {
+        int current = node_arena.opened.get();
+        if (current == destination_id)
+        {
+            found = true;
+            break;
+        }
+
+        node_arena.Close(current);
+        expanded++;
+        int g_cost = node_arena.GCost(current);
+
+        if (current == start_id)
+        {
+            for (std::size_t i = 0; i < first.nodes.size(); i++)
+            {
+                if (from_start[i] >= 0)
+                    open(first.nodes[i], current, from_start[i]);
+            }
+            if (direct >= 0)
+                open(destination_id, current, direct);
+            continue;
+        }
+
+        const Node &node = nodes[current];
+        const Cluster &cluster = clusters[node.cluster];
+        std::size_t k = cluster.nodes.size();
+        for (std::size_t i = 0; i < k; i++)
+        {
+            int distance = cluster.distances[node.slot * k + i];
+            if (distance > 0)
+                open(cluster.nodes[i], current, g_cost + distance);
+        }
+
+        if (node.cluster == destination_cluster && to_destination[node.slot] >= 0)
+            open(destination_id, current, g_cost + to_destination[node.slot]);
+
+        // transitions: free orthogonal neighbours that are nodes of another cluster
+        int column = grid->Column(node.cell);
+        int row = grid->Row(node.cell);
+        const int steps[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+        for (const int *step : steps)
+        {
+            if (!grid->Contains(column + step[0], row + step[1]))
+                continue;
+
+            int neighbour = grid->Index(column + step[0], row + step[1]);
+            int neighbour_cluster = ClusterOf(neighbour);
+            if (neighbour_cluster == node.cluster)
+                continue;
+
+            int id = FindNode(neighbour_cluster, neighbour);
+            if (id != -1)
+                open(id, current, g_cost + Grid::Straight_Cost * grid->Cost(neighbour));
+        }
+    }
+
+    if (!found)
+        return false;
+
+    path_cost = node_arena.GCost(destination_id);
+
+    std::vector<int> waypoints;
+    for (int id = destination_id; id != -1; id = node_arena.Parent(id))
+        waypoints.push_back(node_cell(id));
+    std::reverse(waypoints.begin(), waypoints.end());
+
+    // waypoints in different clusters are transitions of one orthogonal step,
+    // the others are linked by a search inside their cluster
+    for (std::size_t i = 1; i < waypoints.size(); i++)
+    {
+        int from = waypoints[i - 1];
+        int to = waypoints[i];
+        if (from == to)
+            continue;
+
+        if (ClusterOf(from) != ClusterOf(to))
+            path.push_back(to);
+        else
+            AppendClusterPath(clusters[ClusterOf(from)], from, to, cell_arena, path);
+    }
+
+    // destination is not part of the path
+    if (!path.empty())
+        path.pop_back();
+    return true;
+}
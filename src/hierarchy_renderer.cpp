@@ -0,0 +1,63 @@
+#include "hierarchy_renderer.h"
+#include <vector>
+
+#include "glad/glad.h"
+#include "instrumentation.h"
+
+HierarchyRenderer::HierarchyRenderer(const Grid *rendered_grid, const Hierarchy *rendered_hierarchy)
+{
+    grid = rendered_grid;
+    hierarchy = rendered_hierarchy;
+}
+
+void HierarchyRenderer::Initialize()
+{
+    glGenVertexArrays(1, &overlay_vao);
+    glBindVertexArray(overlay_vao);
+
+    glGenBuffers(1, &overlay_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, overlay_vbo);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (void*)0);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void HierarchyRenderer::Update()
+{
+    std::vector<float> vertices;
+    float width = grid->Width();
+    float height = grid->Height();
+
+    for (int x = hierarchy->ClusterSide(); x < grid->Width(); x += hierarchy->ClusterSide())
+        vertices.insert(vertices.end(), {float(x), 0.0f, float(x), height});
+    for (int y = hierarchy->ClusterSide(); y < grid->Height(); y += hierarchy->ClusterSide())
+        vertices.insert(vertices.end(), {0.0f, float(y), width, float(y)});
+    border_vertices_count = vertices.size() / 2;
+
+    // edges link cell centers
+    std::vector<int> cell_pairs;
+    hierarchy->AbstractEdges(cell_pairs);
+    for (int cell : cell_pairs)
+        vertices.insert(vertices.end(), {grid->Column(cell) + 0.5f, grid->Row(cell) + 0.5f});
+    edge_vertices_count = cell_pairs.size();
+
+    glBindBuffer(GL_ARRAY_BUFFER, overlay_vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    ASTAR_COUNT(Gl_Bytes_Uploaded, vertices.size() * sizeof(float));
+}
+
+void HierarchyRenderer::Draw(const ShaderProgram &shader) const
+{
+    glBindVertexArray(overlay_vao);
+
+    shader.SetVec4("line_color", edge_color);
+    glDrawArrays(GL_LINES, border_vertices_count, edge_vertices_count);
+    shader.SetVec4("line_color", border_color);
+    glDrawArrays(GL_LINES, 0, border_vertices_count);
+
+    glBindVertexArray(0);
+}
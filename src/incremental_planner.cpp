@@ -0,0 +1,251 @@
+#include "incremental_planner.h"
+#include <algorithm>
+#include <cstdlib>
+#include "jump_point_search.h"
+#include "search_policies.h"
+#include "instrumentation.h"
+
+IncrementalPlanner::IncrementalPlanner(const Grid *planned_grid)
+{
+    grid = planned_grid;
+}
+
+int IncrementalPlanner::Heuristic(int cell) const
+{
+    return OctileHeuristic::Estimate(abs(grid->Column(cell) - grid->Column(start)), abs(grid->Row(cell) - grid->Row(start)));
+}
+
+int IncrementalPlanner::ComputeRhs(int cell) const
+{
+    if (cell == destination)
+        return 0;
+    if (!grid->IsFree(cell))
+        return Infinity;
+
+    // moves are symmetric, so successors and predecessors are the same cells,
+    // a move costs its length times the cost of the cell it enters
+    int rhs = Infinity;
+    unsigned char neighbours = grid->NeighbourMask(cell);
+    for (int d = 0; d < Grid::Directions_Count; d++)
+    {
+        int next = cell + grid->NeighbourOffset(d);
+        if (neighbours & (1 << d))
+            rhs = std::min(rhs, g_costs[next] + JumpPointSearch::StepCost(d) * grid->Cost(next));
+    }
+    return std::min(rhs, int(Infinity));
+}
+
+void IncrementalPlanner::QueueIfInconsistent(int cell)
+{
+    queue.remove(cell);
+    if (g_costs[cell] != rhs_costs[cell])
+    {
+        int k2 = std::min(g_costs[cell], rhs_costs[cell]);
+        queue.put(cell, k2 + Heuristic(cell) + key_modifier, k2);
+        ASTAR_COUNT(Open_List_Pushes, 1);
+    }
+}
+
+void IncrementalPlanner::UpdateVertex(int cell)
+{
+    rhs_costs[cell] = ComputeRhs(cell);
+    QueueIfInconsistent(cell);
+}
+
+bool IncrementalPlanner::IsStartConsistent() const
+{
+    // the start is final once no queued key is smaller than its own
+    int k2 = std::min(g_costs[start], rhs_costs[start]);
+    int k1 = k2 + key_modifier;
+    if (!queue.empty() && (queue.top_cost() < k1 || (queue.top_cost() == k1 && queue.top_d_cost() < k2)))
+        return false;
+    return g_costs[start] == rhs_costs[start];
+}
+
+void IncrementalPlanner::Start(int start_cell, int destination_cell)
+{
+    start = last_start = start_cell;
+    destination = destination_cell;
+    key_modifier = 0;
+    is_planned = false;
+    path.resize(0);
+    expanded_count = 0;
+
+    g_costs.assign(grid->CellsCount(), Infinity);
+    rhs_costs.assign(grid->CellsCount(), Infinity);
+    queue.clear();
+    queue.reserve(grid->CellsCount());
+
+    if (start == -1 || destination == -1)
+        return;
+
+    rhs_costs[destination] = 0;
+    QueueIfInconsistent(destination);
+}
+
+bool IncrementalPlanner::IsStarted() const
+{
+    return start != -1 && destination != -1 && g_costs.size() == grid->CellsCount();
+}
+
+int IncrementalPlanner::StartCell() const
+{
+    return start;
+}
+
+int IncrementalPlanner::DestinationCell() const
+{
+    return destination;
+}
+
+void IncrementalPlanner::CellChanged(int cell)
+{
+    if (is_planned)
+        expanded_count = 0;
+    is_planned = false;
+
+    // every move the cell takes part in links two cells of the 3x3 block
+    // around it: the cell itself or the corners a diagonal squeezes between
+    int column = grid->Column(cell);
+    int row = grid->Row(cell);
+    for (int j = row - 1; j <= row + 1; j++)
+    {
+        for (int i = column - 1; i <= column + 1; i++)
+        {
+            if (grid->Contains(i, j))
+                UpdateVertex(grid->Index(i, j));
+        }
+    }
+}
+
+void IncrementalPlanner::MoveStart(int start_cell)
+{
+    if (is_planned)
+        expanded_count = 0;
+    is_planned = false;
+
+    // queued keys stay valid lower bounds if they are all lowered by the
+    // drop of the heuristic, which is added to the new keys instead
+    start = start_cell;
+    key_modifier += OctileHeuristic::Estimate(abs(grid->Column(last_start) - grid->Column(start)),
+                                              abs(grid->Row(last_start) - grid->Row(start)));
+    last_start = start;
+}
+
+int IncrementalPlanner::Step()
+{
+    if (is_planned)
+        return -1;
+
+    if (IsStartConsistent() || queue.empty())
+    {
+        BuildPath();
+        is_planned = true;
+        return -1;
+    }
+
+    int old_k1 = queue.top_cost();
+    int old_k2 = queue.top_d_cost();
+    int cell = queue.get();
+    expanded_count++;
+    ASTAR_COUNT(Nodes_Expanded, 1);
+
+    int new_k2 = std::min(g_costs[cell], rhs_costs[cell]);
+    int new_k1 = new_k2 + Heuristic(cell) + key_modifier;
+    if (old_k1 < new_k1 || (old_k1 == new_k1 && old_k2 < new_k2))
+    {
+        // queued before the start moved
+        queue.put(cell, new_k1, new_k2);
+        return cell;
+    }
+
+    unsigned char neighbours = grid->NeighbourMask(cell);
+    if (g_costs[cell] > rhs_costs[cell])
+    {
+        g_costs[cell] = rhs_costs[cell];
+    }
+    else
+    {
+        g_costs[cell] = Infinity;
+        UpdateVertex(cell);
+    }
+
+    for (int d = 0; d < Grid::Directions_Count; d++)
+    {
+        if (neighbours & (1 << d))
+            UpdateVertex(cell + grid->NeighbourOffset(d));
+    }
+    return cell;
+}
+
+void IncrementalPlanner::Plan()
+{
+    while (Step() != -1)
+        ;
+}
+
+bool IncrementalPlanner::IsPlanned() const
+{
+    return is_planned;
+}
+
+void IncrementalPlanner::BuildPath()
+{
+    path.resize(0);
+    if (!PathFound())
+        return;
+
+    // the cheapest step always leads to a smaller g-cost, so this ends
+    // at the destination
+    int cell = start;
+    while (cell != destination)
+    {
+        int best = -1;
+        int best_cost = Infinity;
+        unsigned char neighbours = grid->NeighbourMask(cell);
+        for (int d = 0; d < Grid::Directions_Count; d++)
+        {
+            int next = cell + grid->NeighbourOffset(d);
+            if (!(neighbours & (1 << d)))
+                continue;
+
+            int cost = g_costs[next] + JumpPointSearch::StepCost(d) * grid->Cost(next);
+            if (cost < best_cost)
+            {
+                best = next;
+                best_cost = cost;
+            }
+        }
+
+        // only reachable through a planner bug, but never loop forever
+        if (best == -1 || path.size() >= grid->CellsCount())
+        {
+            path.resize(0);
+            return;
+        }
+
+        cell = best;
+        if (cell != destination)
+            path.push_back(cell);
+    }
+}
+
+bool IncrementalPlanner::PathFound() const
+{
+    return IsStarted() && g_costs[start] < Infinity;
+}
+
+int IncrementalPlanner::PathCost() const
+{
+    return PathFound() ? g_costs[start] : 0;
+}
+
+const std::vector<int>& IncrementalPlanner::Path() const
+{
+    return path;
+}
+
+std::size_t IncrementalPlanner::ExpandedCount() const
+{
+    return expanded_count;
+}
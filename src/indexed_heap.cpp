@@ -0,0 +1,149 @@
+#include "indexed_heap.h"
+#include <utility>
+
+IndexedHeap::IndexedHeap(std::size_t capacity)
+{
+    reserve(capacity);
+}
+
+void IndexedHeap::reserve(std::size_t capacity)
+{
+    if (position.size() < capacity)
+        position.resize(capacity, -1);
+}
+
+void IndexedHeap::Swap(std::size_t a, std::size_t b)
+{
+    std::swap(elements[a], elements[b]);
+    position[elements[a].item] = a;
+    position[elements[b].item] = b;
+}
+
+void IndexedHeap::SiftUp(std::size_t i)
+{
+    while (i > 0)
+    {
+        std::size_t parent = (i - 1) / 2;
+        if (!(elements[i] < elements[parent]))
+            break;
+        Swap(i, parent);
+        i = parent;
+    }
+}
+
+void IndexedHeap::SiftDown(std::size_t i)
+{
+    std::size_t count = elements.size();
+    while (true)
+    {
+        std::size_t smallest = i;
+        std::size_t left = 2 * i + 1;
+        std::size_t right = left + 1;
+
+        if (left < count && elements[left] < elements[smallest])
+            smallest = left;
+        if (right < count && elements[right] < elements[smallest])
+            smallest = right;
+        if (smallest == i)
+            break;
+
+        Swap(i, smallest);
+        i = smallest;
+    }
+}
+
+int IndexedHeap::get()
+{
+    int item = elements.front().item;
+    position[item] = -1;
+
+    if (elements.size() > 1)
+    {
+        elements.front() = elements.back();
+        position[elements.front().item] = 0;
+        elements.pop_back();
+        SiftDown(0);
+    }
+    else
+        elements.pop_back();
+
+    return item;
+}
+
+int IndexedHeap::top_cost() const
+{
+    return elements.front().all_cost;
+}
+
+int IndexedHeap::top_d_cost() const
+{
+    return elements.front().d_cost;
+}
+
+bool IndexedHeap::empty() const
+{
+    return elements.empty();
+}
+
+std::size_t IndexedHeap::size() const
+{
+    return elements.size();
+}
+
+bool IndexedHeap::contains(int item) const
+{
+    return position[item] != -1;
+}
+
+void IndexedHeap::clear()
+{
+    for (const HeapElement &el : elements)
+        position[el.item] = -1;
+    elements.clear();
+}
+
+void IndexedHeap::put(int item, int all_cost, int d_cost)
+{
+    int pos = position[item];
+    if (pos == -1)
+    {
+        elements.push_back({all_cost, d_cost, item});
+        position[item] = elements.size() - 1;
+        SiftUp(elements.size() - 1);
+        return;
+    }
+
+    HeapElement old = elements[pos];
+    elements[pos].all_cost = all_cost;
+    elements[pos].d_cost = d_cost;
+
+    if (elements[pos] < old)
+        SiftUp(pos);
+    else
+        SiftDown(pos);
+}
+
+
+void IndexedHeap::remove(int item)
+{
+    int pos = position[item];
+    if (pos == -1)
+        return;
+
+    position[item] = -1;
+    if (std::size_t(pos) == elements.size() - 1)
+    {
+        elements.pop_back();
+        return;
+    }
+
+    HeapElement removed = elements[pos];
+    elements[pos] = elements.back();
+    position[elements[pos].item] = pos;
+    elements.pop_back();
+
+    if (elements[pos] < removed)
+        SiftUp(pos);
+    else
+        SiftDown(pos);
+}
\ No newline at end of file
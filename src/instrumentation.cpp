@@ -0,0 +1,167 @@
+#include "instrumentation.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+
+struct TraceEvent
+{
+    const char *name;
+    std::uint64_t begin_us;
+    std::uint64_t duration_us;
+    int thread_id;
+    bool is_counter;
+    std::uint64_t counters[Instrumentation::Counters_Count];
+};
+
+static std::mutex counters_mutex;
+static std::vector<Instrumentation::ThreadCounters*> live_counters;
+static std::uint64_t exited_totals[Instrumentation::Counters_Count] = {};
+
+static std::atomic<bool> is_tracing{false};
+static std::mutex trace_mutex;
+static std::vector<TraceEvent> trace_events;
+
+static std::atomic<int> next_thread_id{1};
+static const std::chrono::steady_clock::time_point clock_origin = std::chrono::steady_clock::now();
+
+static int ThreadId()
+{
+    thread_local int id = next_thread_id++;
+    return id;
+}
+
+Instrumentation::ThreadCounters::ThreadCounters()
+{
+    for (std::atomic<std::uint64_t> &value : values)
+        value.store(0, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(counters_mutex);
+    live_counters.push_back(this);
+}
+
+Instrumentation::ThreadCounters::~ThreadCounters()
+{
+    std::lock_guard<std::mutex> lock(counters_mutex);
+    for (int i = 0; i < Counters_Count; i++)
+        exited_totals[i] += values[i].load(std::memory_order_relaxed);
+    live_counters.erase(std::find(live_counters.begin(), live_counters.end(), this));
+}
+
+Instrumentation::ThreadCounters& Instrumentation::LocalCounters()
+{
+    thread_local ThreadCounters counters;
+    return counters;
+}
+
+const char *Instrumentation::CounterName(Counter counter)
+{
+    switch (counter)
+    {
+    case Nodes_Expanded:
+        return "expanded";
+    case Open_List_Pushes:
+        return "pushes";
+    case Decrease_Keys:
+        return "decrease_keys";
+    case Neighbours_Generated:
+        return "neighbours";
+    case Gl_Bytes_Uploaded:
+        return "gl_bytes";
+    default:
+        return "unknown";
+    }
+}
+
+void Instrumentation::ReadCounters(std::uint64_t values[Counters_Count])
+{
+    std::lock_guard<std::mutex> lock(counters_mutex);
+    for (int i = 0; i < Counters_Count; i++)
+    {
+        values[i] = exited_totals[i];
+        for (const ThreadCounters *counters : live_counters)
+            values[i] += counters->values[i].load(std::memory_order_relaxed);
+    }
+}
+
+std::uint64_t Instrumentation::NowMicroseconds()
+{
+    auto elapsed = std::chrono::steady_clock::now() - clock_origin;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+void Instrumentation::StartTrace()
+{
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    trace_events.clear();
+    is_tracing = true;
+}
+
+bool Instrumentation::IsTracing()
+{
+    return is_tracing.load(std::memory_order_relaxed);
+}
+
+void Instrumentation::RecordEvent(const char *name, std::uint64_t begin_us, std::uint64_t end_us)
+{
+    if (!IsTracing())
+        return;
+
+    TraceEvent event = {name, begin_us, end_us - begin_us, ThreadId(), false, {}};
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    trace_events.push_back(event);
+}
+
+void Instrumentation::RecordCounters()
+{
+    if (!IsTracing())
+        return;
+
+    TraceEvent event = {"counters", NowMicroseconds(), 0, ThreadId(), true, {}};
+    ReadCounters(event.counters);
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    trace_events.push_back(event);
+}
+
+bool Instrumentation::WriteTrace(const std::string &path)
+{
+    is_tracing = false;
+
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        std::cout << "ERROR: FAILED TO OPEN TRACE FILE: " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (std::size_t i = 0; i < trace_events.size(); i++)
+    {
+        const TraceEvent &event = trace_events[i];
+        file << "{\"name\":\"" << event.name << "\",\"pid\":1,\"tid\":" << event.thread_id
+             << ",\"ts\":" << event.begin_us;
+        if (event.is_counter)
+        {
+            // the counters are running totals, the trace viewer plots them as graphs
+            file << ",\"ph\":\"C\",\"args\":{";
+            for (int c = 0; c < Counters_Count; c++)
+                file << (c > 0 ? "," : "") << "\"" << CounterName(Counter(c)) << "\":" << event.counters[c];
+            file << "}}";
+        }
+        else
+            file << ",\"ph\":\"X\",\"dur\":" << event.duration_us << "}";
+        file << (i + 1 < trace_events.size() ? ",\n" : "\n");
+    }
+    file << "]}\n";
+    trace_events.clear();
+
+    if (!file.good())
+    {
+        std::cout << "ERROR: FAILED TO WRITE TRACE FILE: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,178 @@
+#include "jump_point_search.h"
+#include <cstdlib>
+
+JumpPointSearch::JumpPointSearch(const Grid *searched_grid)
+{
+    static const PruningTables shared_tables = BuildTables();
+    grid = searched_grid;
+    tables = &shared_tables;
+}
+
+bool JumpPointSearch::IsDiagonal(int direction)
+{
+    return Grid::Direction_Columns[direction] != 0 && Grid::Direction_Rows[direction] != 0;
+}
+
+int JumpPointSearch::StepCost(int direction)
+{
+    return IsDiagonal(direction) ? Grid::Diagonal_Cost : Grid::Straight_Cost;
+}
+
+int JumpPointSearch::DirectionBetween(int from_column, int from_row, int to_column, int to_row)
+{
+    int dc = (to_column > from_column) - (to_column < from_column);
+    int dr = (to_row > from_row) - (to_row < from_row);
+
+    // directions are ordered by column then row offset with (0, 0) skipped
+    int k = (dc + 1) * 3 + (dr + 1);
+    return k < 4 ? k : k - 1;
+}
+
+JumpPointSearch::PruningTables JumpPointSearch::BuildTables()
+{
+    PruningTables built;
+    const int infinity = 1 << 20;
+    const int Block_Side = 3;
+
+    for (int direction = 0; direction <= No_Direction; direction++)
+    {
+        built.natural[direction] = 0;
+        if (direction == No_Direction)
+            continue;
+
+        built.natural[direction] |= 1 << direction;
+        if (IsDiagonal(direction))
+        {
+            built.natural[direction] |= 1 << DirectionBetween(0, 0, Grid::Direction_Columns[direction], 0);
+            built.natural[direction] |= 1 << DirectionBetween(0, 0, 0, Grid::Direction_Rows[direction]);
+        }
+    }
+
+    for (int ring = 0; ring < 256; ring++)
+    {
+        // local 3x3 block, x is the cell in the middle
+        bool is_free[Block_Side][Block_Side];
+        is_free[1][1] = true;
+        for (int d = 0; d < Grid::Directions_Count; d++)
+            is_free[Grid::Direction_Columns[d] + 1][Grid::Direction_Rows[d] + 1] = (ring >> d) & 1;
+
+        auto move_cost = [&is_free](int c1, int r1, int c2, int r2)
+        {
+            if (abs(c1 - c2) > 1 || abs(r1 - r2) > 1 || (c1 == c2 && r1 == r2) || !is_free[c2][r2])
+                return -1;
+            if (c1 != c2 && r1 != r2 && !is_free[c2][r1] && !is_free[c1][r2])
+                return -1;
+            return c1 != c2 && r1 != r2 ? int(Grid::Diagonal_Cost) : int(Grid::Straight_Cost);
+        };
+
+        for (int direction = 0; direction <= No_Direction; direction++)
+        {
+            unsigned char result = 0;
+
+            if (direction == No_Direction)
+            {
+                for (int d = 0; d < Grid::Directions_Count; d++)
+                    if (move_cost(1, 1, Grid::Direction_Columns[d] + 1, Grid::Direction_Rows[d] + 1) != -1)
+                        result |= 1 << d;
+                built.successors[direction][ring] = result;
+                continue;
+            }
+
+            int parent_c = 1 - Grid::Direction_Columns[direction];
+            int parent_r = 1 - Grid::Direction_Rows[direction];
+
+            // shortest paths from the parent that avoid x
+            int without_x[Block_Side][Block_Side];
+            for (int c = 0; c < Block_Side; c++)
+                for (int r = 0; r < Block_Side; r++)
+                    without_x[c][r] = infinity;
+            without_x[parent_c][parent_r] = 0;
+
+            for (int iteration = 0; iteration < Grid::Directions_Count; iteration++)
+                for (int c1 = 0; c1 < Block_Side; c1++)
+                    for (int r1 = 0; r1 < Block_Side; r1++)
+                        for (int c2 = 0; c2 < Block_Side; c2++)
+                            for (int r2 = 0; r2 < Block_Side; r2++)
+                            {
+                                if ((c1 == 1 && r1 == 1) || (c2 == 1 && r2 == 1) || without_x[c1][r1] == infinity)
+                                    continue;
+                                int cost = move_cost(c1, r1, c2, r2);
+                                if (cost != -1 && without_x[c1][r1] + cost < without_x[c2][r2])
+                                    without_x[c2][r2] = without_x[c1][r1] + cost;
+                            }
+
+            for (int d = 0; d < Grid::Directions_Count; d++)
+            {
+                int c = Grid::Direction_Columns[d] + 1;
+                int r = Grid::Direction_Rows[d] + 1;
+                int step = move_cost(1, 1, c, r);
+                if (step == -1)
+                    continue;
+
+                // a neighbour is pruned if it can be reached as cheaply without
+                // x (straight moves) or strictly cheaper (diagonal moves)
+                int via_x = StepCost(direction) + step;
+                bool pruned = IsDiagonal(direction) ? without_x[c][r] < via_x : without_x[c][r] <= via_x;
+                if (!pruned)
+                    result |= 1 << d;
+            }
+
+            built.successors[direction][ring] = result;
+        }
+    }
+
+    return built;
+}
+
+unsigned char JumpPointSearch::FreeRing(int cell) const
+{
+    int column = grid->Column(cell);
+    int row = grid->Row(cell);
+
+    unsigned char ring = 0;
+    for (int d = 0; d < Grid::Directions_Count; d++)
+    {
+        int i = column + Grid::Direction_Columns[d];
+        int j = row + Grid::Direction_Rows[d];
+        if (grid->Contains(i, j) && grid->IsFree(i, j))
+            ring |= 1 << d;
+    }
+
+    return ring;
+}
+
+unsigned char JumpPointSearch::Successors(int cell, int direction) const
+{
+    return tables->successors[direction][FreeRing(cell)];
+}
+
+int JumpPointSearch::Jump(int cell, int direction, int destination, int &steps) const
+{
+    int offset = grid->NeighbourOffset(direction);
+    int current = cell;
+    steps = 0;
+
+    while (true)
+    {
+        if (!(grid->NeighbourMask(current) & (1 << direction)))
+            return -1;
+
+        current += offset;
+        steps++;
+
+        if (current == destination)
+            return current;
+        if (Successors(current, direction) & ~tables->natural[direction])
+            return current;
+
+        if (IsDiagonal(direction))
+        {
+            int horizontal = DirectionBetween(0, 0, Grid::Direction_Columns[direction], 0);
+            int vertical = DirectionBetween(0, 0, 0, Grid::Direction_Rows[direction]);
+            int straight_steps;
+            if (Jump(current, horizontal, destination, straight_steps) != -1 ||
+                Jump(current, vertical, destination, straight_steps) != -1)
+                return current;
+        }
+    }
+}
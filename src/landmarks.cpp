@@ -0,0 +1,225 @@
+#include "landmarks.h"
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+#include "jump_point_search.h"
+#include "instrumentation.h"
+
+Landmarks::Landmarks(const Grid *measured_grid)
+{
+    grid = measured_grid;
+}
+
+void Landmarks::SetCount(int landmarks_count)
+{
+    count = std::max(landmarks_count, 1);
+    is_built = false;
+}
+
+int Landmarks::Count() const
+{
+    return count;
+}
+
+void Landmarks::SetPlacedCells(const std::vector<int> &landmark_cells)
+{
+    placed_cells = landmark_cells;
+    is_built = false;
+}
+
+const std::vector<int>& Landmarks::PlacedCells() const
+{
+    return placed_cells;
+}
+
+bool Landmarks::IsBuilt() const
+{
+    return is_built && built_version == grid->Version() && built_cells_count == grid->CellsCount();
+}
+
+const std::vector<int>& Landmarks::Cells() const
+{
+    return cells;
+}
+
+std::size_t Landmarks::MemoryBytes() const
+{
+    return tables.size() * sizeof(std::uint16_t);
+}
+
+void Landmarks::PickCells()
+{
+    cells.clear();
+    if (!placed_cells.empty())
+    {
+        for (int cell : placed_cells)
+        {
+            if (cell >= 0 && std::size_t(cell) < grid->CellsCount() && grid->IsFree(cell) &&
+                std::find(cells.begin(), cells.end(), cell) == cells.end())
+                cells.push_back(cell);
+        }
+        return;
+    }
+
+    int seed = -1;
+    for (std::size_t cell = 0; cell < grid->CellsCount(); cell++)
+    {
+        if (grid->IsFree(cell) && (seed == -1 || grid->ComponentSize(cell) > grid->ComponentSize(seed)))
+            seed = cell;
+    }
+    if (seed == -1)
+        return;
+
+    // hop counts are enough to spread the landmarks and much cheaper than
+    // costs. The first landmark is the farthest cell from the seed, every
+    // next one the farthest cell from all landmarks so far
+    std::vector<int> nearest(grid->CellsCount());
+    std::vector<int> hops(grid->CellsCount());
+    std::vector<int> queue;
+    int source = seed;
+    for (int i = 0;; i++)
+    {
+        if (i > 0)
+        {
+            cells.push_back(source);
+            if (int(cells.size()) == count)
+                break;
+        }
+
+        std::fill(hops.begin(), hops.end(), -1);
+        hops[source] = 0;
+        queue.assign(1, source);
+        for (std::size_t q = 0; q < queue.size(); q++)
+        {
+            int current = queue[q];
+            unsigned char neighbours = grid->NeighbourMask(current);
+            for (int d = 0; d < Grid::Directions_Count; d++)
+            {
+                int next = current + grid->NeighbourOffset(d);
+                if ((neighbours & (1 << d)) && hops[next] == -1)
+                {
+                    hops[next] = hops[current] + 1;
+                    queue.push_back(next);
+                }
+            }
+        }
+
+        // the seed itself is not a landmark, only the start of the selection
+        int farthest = source;
+        for (int cell : queue)
+        {
+            nearest[cell] = i <= 1 ? hops[cell] : std::min(nearest[cell], hops[cell]);
+            if (nearest[cell] > nearest[farthest])
+                farthest = cell;
+        }
+        if (nearest[farthest] == 0)
+            break; // fewer free cells than landmarks
+        source = farthest;
+    }
+}
+
+void Landmarks::BuildTable(int landmark, std::vector<int> &distances, std::vector<std::vector<int>> &buckets)
+{
+    // Dial's algorithm like Hierarchy::ClusterDistances, over the whole grid
+    distances.assign(grid->CellsCount(), -1);
+    distances[cells[landmark]] = 0;
+    buckets[0].assign(1, cells[landmark]);
+    std::size_t queued = 1;
+    int max_distance = 0;
+
+    for (int distance = 0; queued > 0; distance++)
+    {
+        std::vector<int> &bucket = buckets[distance % buckets.size()];
+        for (std::size_t b = 0; b < bucket.size(); b++)
+        {
+            int current = bucket[b];
+            if (distances[current] != distance)
+                continue; // reached again by a shorter path
+
+            max_distance = distance;
+            unsigned char neighbours = grid->NeighbourMask(current);
+            for (int d = 0; d < Grid::Directions_Count; d++)
+            {
+                if (!(neighbours & (1 << d)))
+                    continue;
+
+                int next = current + grid->NeighbourOffset(d);
+                int next_distance = distance + JumpPointSearch::StepCost(d) * grid->Cost(next);
+                if (distances[next] != -1 && distances[next] <= next_distance)
+                    continue;
+
+                distances[next] = next_distance;
+                buckets[next_distance % buckets.size()].push_back(next);
+                queued++;
+            }
+        }
+        queued -= bucket.size();
+        bucket.clear();
+    }
+
+    int scale = max_distance / (Unreachable - 1) + 1;
+    scales[landmark] = scale;
+    std::uint16_t *table = tables.data() + std::size_t(landmark) * distances.size();
+    for (std::size_t cell = 0; cell < distances.size(); cell++)
+        table[cell] = distances[cell] == -1 ? std::uint16_t(Unreachable) : std::uint16_t(distances[cell] / scale);
+}
+
+void Landmarks::Update(unsigned int threads_count)
+{
+    if (IsBuilt())
+        return;
+
+    ASTAR_SCOPED_TIMER("landmarks_build");
+    PickCells();
+    std::size_t cells_count = grid->CellsCount();
+    tables.assign(cells.size() * cells_count, Unreachable);
+    scales.assign(cells.size(), 1);
+    is_symmetric = grid->HasUniformCosts();
+
+    if (threads_count == 0)
+        threads_count = std::max(1u, std::thread::hardware_concurrency());
+    threads_count = std::min<unsigned int>(threads_count, cells.size());
+
+    // every thread builds the tables i, i + threads_count, ... with its own scratch
+    auto build = [this](unsigned int first, unsigned int step)
+    {
+        std::vector<int> distances;
+        std::vector<std::vector<int>> buckets(Grid::Diagonal_Cost * Grid::Max_Cost + 1);
+        for (std::size_t i = first; i < cells.size(); i += step)
+            BuildTable(i, distances, buckets);
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < threads_count; t++)
+        threads.emplace_back(build, t, threads_count);
+    if (threads_count > 0)
+        build(0, threads_count);
+    for (std::thread &thread : threads)
+        thread.join();
+
+    is_built = true;
+    built_version = grid->Version();
+    built_cells_count = cells_count;
+}
+
+int Landmarks::Estimate(int cell, int destination) const
+{
+    // a stored value q stands for a cost in [q * scale, q * scale + scale - 1],
+    // so the difference of two costs is at least the difference of the
+    // values times the scale minus scale - 1
+    std::size_t cells_count = built_cells_count;
+    int bound = 0;
+    for (std::size_t i = 0; i < cells.size(); i++)
+    {
+        const std::uint16_t *table = tables.data() + i * cells_count;
+        int to_destination = table[destination];
+        int to_cell = table[cell];
+        if (to_destination == Unreachable || to_cell == Unreachable)
+            continue;
+
+        int scale = scales[i];
+        int difference = is_symmetric ? std::abs(to_destination - to_cell) : to_destination - to_cell;
+        bound = std::max(bound, difference * scale - (scale - 1));
+    }
+    return bound;
+}
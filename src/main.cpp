@@ -1,22 +1,86 @@
 #include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <algorithm>
 
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
 
 #include "constants.h"
+#include "camera.h"
 #include "grid.h"
 #include "shader_program.h"
 #include "searcher.h"
+#include "board_renderer.h"
+#include "background_search.h"
+#include "hierarchy.h"
+#include "hierarchy_renderer.h"
+#include "path_cache.h"
+#include "landmarks.h"
+#include "flow_field.h"
+#include "expansion_trace.h"
+#include "trace_replay.h"
+#include "stats_overlay.h"
+#include "instrumentation.h"
+#include "map_loader.h"
+#include "grid_file.h"
+#include "map_generator.h"
 #include "shaders_dir.h"
 
 Grid grid;
 Searcher searcher(&grid);
+Camera camera;
+BoardRenderer board_renderer(&grid, &searcher, &camera);
+Hierarchy hierarchy(&grid);
+HierarchyRenderer hierarchy_renderer(&grid, &hierarchy);
+PathCache path_cache(&grid);
+Landmarks landmarks(&grid);
+FlowField flow_field(&grid);
+ExpansionTrace expansion_trace;
+MapGenerator map_generator;
+TraceReplay trace_replay(&expansion_trace);
+BackgroundSearch background_search;
+StatsOverlay stats_overlay;
+
+// how the search is spread over the frames. The first two run the steps on
+// this thread within a budget per frame, the last two search a copy of the
+// grid on a worker thread and only pick up its results
+enum SearchPacing
+{
+    Steps_Per_Frame = 0,
+    Milliseconds_Per_Frame,
+    Background_Steps,
+    Instant_Result,
+    Pacing_Modes_Count
+};
+
+SearchPacing pacing = Steps_Per_Frame;
+int steps_per_frame = 1;
+int milliseconds_per_frame = 4;
+const int max_steps_per_frame = 1 << 16;
+const int max_milliseconds_per_frame = 32;
+std::vector<BackgroundSearch::StepBatch> step_batches;
 
 bool is_placing_main_cells = true;
+// the right button paints cost 1 back while painting terrain
+bool is_painting_terrain = false;
+int terrain_brush_cost = 5;
 bool is_searching = false;
+bool is_showing_hierarchy = false;
+bool is_showing_stats = false;
+bool is_showing_flow = false;
+bool is_replaying = false;
+std::string trace_path;
+// searches on this thread are recorded, K saves the last one here
+std::string expansion_trace_path = "search.trace";
+// S saves the grid with its start and destination here, O loads it back
+std::string scene_path = "scene.grid";
 
 bool left_click = false;
 bool right_click = false;
+bool middle_click = false;
 double cursor_x;
 double cursor_y;
 
@@ -25,6 +89,242 @@ void ErrorCallback(int errorCode, const char *message)
     std::cout << "ERROR: " << message << "\nERROR CODE: " << errorCode << std::endl;
 }
 
+// -1 if the cursor is outside of the grid
+int CellUnderCursor()
+{
+    float world_x, world_y;
+    camera.ScreenToWorld(cursor_x, cursor_y, world_x, world_y);
+
+    int column = int(std::floor(world_x));
+    int row = int(std::floor(world_y));
+    return grid.Contains(column, row) ? grid.Index(column, row) : -1;
+}
+
+const char *PacingName(SearchPacing mode)
+{
+    switch (mode)
+    {
+    case Steps_Per_Frame:
+        return "STEPS PER FRAME";
+    case Milliseconds_Per_Frame:
+        return "MILLISECONDS PER FRAME";
+    case Background_Steps:
+        return "BACKGROUND";
+    case Instant_Result:
+        return "INSTANT";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+void PrintPacing()
+{
+    std::cout << "SEARCH PACING: " << PacingName(pacing);
+    if (pacing == Steps_Per_Frame)
+        std::cout << " (" << steps_per_frame << ")";
+    else if (pacing == Milliseconds_Per_Frame)
+        std::cout << " (" << milliseconds_per_frame << ")";
+    std::cout << std::endl;
+}
+
+// halves or doubles the budget of the current pacing
+void ScaleBudget(bool is_growing)
+{
+    if (pacing == Steps_Per_Frame)
+        steps_per_frame = is_growing ? std::min(steps_per_frame * 2, max_steps_per_frame) : std::max(steps_per_frame / 2, 1);
+    else if (pacing == Milliseconds_Per_Frame)
+        milliseconds_per_frame = is_growing ? std::min(milliseconds_per_frame * 2, max_milliseconds_per_frame)
+                                            : std::max(milliseconds_per_frame / 2, 1);
+    PrintPacing();
+}
+
+bool IsSearchRunning()
+{
+    return searcher.IsSearching() || background_search.IsActive();
+}
+
+bool IsReplayPlaying()
+{
+    return is_replaying && !trace_replay.IsAtEnd();
+}
+
+void PrintSearchResult(bool is_found, int path_cost, std::size_t expanded)
+{
+    if (is_found)
+        std::cout << "PATH COST: " << double(path_cost) / Grid::Straight_Cost;
+    else
+        std::cout << "NO PATH FOUND";
+    std::cout << ", EXPANDED: " << expanded << std::endl;
+}
+
+void ResetSearch()
+{
+    is_replaying = false;
+    background_search.Cancel();
+    searcher.Reset();
+    board_renderer.Reset();
+}
+
+void ShowReplay()
+{
+    board_renderer.ShowReplay(trace_replay);
+    if (!trace_replay.IsAtEnd())
+        return;
+    if (expansion_trace.PathFound())
+        board_renderer.UpdatePath(expansion_trace.Path());
+}
+
+// replays the last search recorded or loaded from the start, the live search is dropped
+void StartReplay()
+{
+    if (expansion_trace.Width() != grid.Width() || expansion_trace.Height() != grid.Height())
+    {
+        std::cout << "NO SEARCH TRACE RECORDED" << std::endl;
+        return;
+    }
+
+    ResetSearch();
+    trace_replay.Rewind();
+    ShowReplay();
+    is_replaying = true;
+    std::cout << "REPLAY: " << Searcher::AlgorithmName(Searcher::Algorithm(expansion_trace.AlgorithmIndex())) << ", "
+              << expansion_trace.StepsCount() << " STEPS, " << expansion_trace.StepsBytes() << " BYTES" << std::endl;
+}
+
+void StopReplay()
+{
+    if (!is_replaying)
+        return;
+    is_replaying = false;
+    board_renderer.Reset();
+}
+
+// jumps are rebuilt in one pass, playing on only draws the new steps
+void SeekReplay(std::size_t step)
+{
+    trace_replay.Seek(step);
+    ShowReplay();
+    if (trace_replay.IsAtEnd())
+        std::cout << "REPLAY STEP: " << trace_replay.Step() << " (END)" << std::endl;
+}
+
+// the hierarchy is only built once HPA* or its overlay is used,
+// afterwards edits keep it up to date
+void BuildHierarchy()
+{
+    hierarchy.Build();
+    if (is_showing_hierarchy)
+        hierarchy_renderer.Update();
+}
+
+// while shown the flow field follows the edits and the destination
+void RefreshFlowField()
+{
+    if (!is_showing_flow)
+        return;
+    flow_field.Update();
+    board_renderer.UpdateFlow();
+}
+
+void SaveScene()
+{
+    if (SaveGridFile(scene_path, grid))
+        std::cout << "SAVED SCENE: " << scene_path << std::endl;
+}
+
+// a loaded or generated grid replaces everything built on the last one
+void ReplaceGrid()
+{
+    ResetSearch();
+    path_cache.Clear();
+    // the field is updated first, the cells of the new size encode its flows
+    RefreshFlowField();
+    board_renderer.UpdateAllCells();
+    if (hierarchy.IsBuilt())
+        BuildHierarchy();
+    camera.Fit(grid.Width(), grid.Height());
+}
+
+void LoadScene()
+{
+    if (!LoadGridFile(scene_path, grid))
+        return;
+    ReplaceGrid();
+    std::cout << "LOADED SCENE: " << scene_path << ", " << grid.Width() << "x" << grid.Height() << std::endl;
+}
+
+// every map takes the next seed, printed so that the tools can make it again
+void GenerateMap()
+{
+    map_generator.SetSeed(map_generator.Seed() + 1);
+    double begin_time = glfwGetTime();
+    map_generator.Generate(grid);
+    ReplaceGrid();
+    std::cout << "GENERATED MAP: " << MapGenerator::KindKey(map_generator.GetKind()) << ", SEED " << map_generator.Seed()
+              << ", " << int((glfwGetTime() - begin_time) * 1000.0) << " MS" << std::endl;
+}
+
+void EditCell(int cell, bool is_placing_main_cell, bool is_left)
+{
+    if (cell == -1)
+        return;
+    StopReplay();
+
+    bool was_free = grid.IsFree(cell);
+    int old_cost = grid.Cost(cell);
+    bool is_repairing = false;
+
+    if (is_placing_main_cell)
+    {
+        if (is_left)
+            grid.SetStartCell(cell);
+        else
+            grid.SetDestinationCell(cell);
+    }
+    else if (is_painting_terrain)
+    {
+        grid.SetCost(cell, is_left ? terrain_brush_cost : 1);
+    }
+    else
+    {
+        if (is_left)
+            grid.PlaceBlockedCell(cell);
+        else
+            grid.RemoveBlockedCell(cell);
+    }
+
+    // start and destination unblock the cell they are placed on
+    if (was_free != grid.IsFree(cell) || old_cost != grid.Cost(cell))
+    {
+        hierarchy.UpdateCell(cell);
+        if (is_showing_hierarchy)
+            hierarchy_renderer.Update();
+        is_repairing = searcher.CellChanged(cell);
+        if (is_showing_flow)
+            flow_field.CellChanged(cell);
+    }
+
+    // D* Lite keeps its plan when the start moves, a new destination
+    // needs a new search
+    if (is_placing_main_cell && is_left)
+        is_repairing = searcher.MoveStart(cell) || is_repairing;
+    else if (is_placing_main_cell && searcher.IsRepairable())
+    {
+        ResetSearch();
+        is_repairing = false;
+    }
+
+    // the repair is drawn like a search: only the re-expanded cells show up
+    if (is_repairing)
+        board_renderer.Reset();
+
+    if (old_cost != grid.Cost(cell))
+        board_renderer.UpdateCost(cell);
+    board_renderer.UpdateMainCells();
+    board_renderer.UpdateCell(cell);
+    RefreshFlowField();
+}
+
 void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mods)
 {
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
@@ -36,60 +336,384 @@ void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mods
     if (key == GLFW_KEY_R && action == GLFW_PRESS)
     {
         grid.ClearAll();
-        searcher.Reset();
+        board_renderer.UpdateAllCells();
+        if (hierarchy.IsBuilt())
+            BuildHierarchy();
+        ResetSearch();
+        RefreshFlowField();
     }
 
     if (key == GLFW_KEY_C && action == GLFW_PRESS)
+        ResetSearch();
+
+    if (key == GLFW_KEY_TAB && action == GLFW_PRESS)
+    {
+        int next = (searcher.SelectedAlgorithm() + 1) % Searcher::Algorithms_Count;
+        searcher.SetAlgorithm(Searcher::Algorithm(next));
+        path_cache.Clear();
+        std::cout << "ALGORITHM: " << Searcher::AlgorithmName(searcher.SelectedAlgorithm()) << std::endl;
+
+        if (searcher.SelectedAlgorithm() == Searcher::Hierarchical_A_Star && !hierarchy.IsBuilt())
+            BuildHierarchy();
+    }
+
+    if (key == GLFW_KEY_Q && action == GLFW_PRESS)
+    {
+        int next = (searcher.OpenListKind() + 1) % OpenList::Kinds_Count;
+        searcher.SetOpenList(OpenList::Kind(next));
+        path_cache.Clear();
+        ResetSearch();
+        std::cout << "OPEN LIST: " << OpenList::KindKey(searcher.OpenListKind()) << std::endl;
+    }
+
+    // the heuristic and the moves of A*, to compare their expansions
+    if (key == GLFW_KEY_E && action == GLFW_PRESS)
+    {
+        int next = (searcher.HeuristicKind() + 1) % SearchPolicy::Heuristics_Count;
+        searcher.SetHeuristic(SearchPolicy::Heuristic(next));
+        path_cache.Clear();
+        std::cout << "HEURISTIC: " << SearchPolicy::HeuristicKey(searcher.HeuristicKind()) << std::endl;
+    }
+
+    if (key == GLFW_KEY_N && action == GLFW_PRESS)
+    {
+        int next = (searcher.NeighbourhoodKind() + 1) % SearchPolicy::Neighbourhoods_Count;
+        searcher.SetNeighbourhood(SearchPolicy::Neighbourhood(next));
+        path_cache.Clear();
+        std::cout << "MOVES: " << SearchPolicy::NeighbourhoodKey(searcher.NeighbourhoodKind()) << std::endl;
+    }
+
+    // hand-placed landmarks replace the picked ones, removing the last one
+    // picks them again. The tables are rebuilt at the next ALT search
+    if (key == GLFW_KEY_L && action == GLFW_PRESS && CellUnderCursor() != -1)
+    {
+        std::vector<int> placed = landmarks.PlacedCells();
+        std::vector<int>::iterator found = std::find(placed.begin(), placed.end(), CellUnderCursor());
+        if (found != placed.end())
+            placed.erase(found);
+        else
+            placed.push_back(CellUnderCursor());
+        landmarks.SetPlacedCells(placed);
+        path_cache.Clear();
+        std::cout << "PLACED LANDMARKS: " << placed.size() << std::endl;
+    }
+
+    if (key == GLFW_KEY_T && action == GLFW_PRESS)
+    {
+        is_painting_terrain = !is_painting_terrain;
+        std::cout << "PAINTING: " << (is_painting_terrain ? "TERRAIN" : "WALLS") << std::endl;
+    }
+
+    if (key >= GLFW_KEY_1 && key <= GLFW_KEY_9 && action == GLFW_PRESS)
+    {
+        terrain_brush_cost = key - GLFW_KEY_0;
+        std::cout << "TERRAIN COST: " << terrain_brush_cost << std::endl;
+    }
+
+    if (key == GLFW_KEY_H && action == GLFW_PRESS)
+    {
+        is_showing_hierarchy = !is_showing_hierarchy;
+        if (is_showing_hierarchy && !hierarchy.IsBuilt())
+            BuildHierarchy();
+        else if (is_showing_hierarchy)
+            hierarchy_renderer.Update();
+    }
+
+    // one field towards the destination answers every start at once
+    if (key == GLFW_KEY_F && action == GLFW_PRESS)
+    {
+        is_showing_flow = !is_showing_flow;
+        if (is_showing_flow)
+        {
+            flow_field.Update();
+            std::cout << "FLOW FIELD: " << flow_field.SettledCount() << " CELLS SETTLED, "
+                      << flow_field.MemoryBytes() / 1024 << " KB" << std::endl;
+            if (grid.Start() != -1 && flow_field.IsReachable(grid.Start()))
+                std::cout << "FLOW PATH COST: " << double(flow_field.Distance(grid.Start())) / Grid::Straight_Cost << std::endl;
+        }
+        board_renderer.SetFlowField(is_showing_flow ? &flow_field : nullptr);
+    }
+
+    // replays the last search at the steps per frame budget, comma and
+    // period jump a tenth of it back or forward
+    if (key == GLFW_KEY_V && action == GLFW_PRESS)
+    {
+        if (is_replaying)
+            StopReplay();
+        else
+            StartReplay();
+    }
+
+    if ((key == GLFW_KEY_COMMA || key == GLFW_KEY_PERIOD) && action == GLFW_PRESS && is_replaying)
+    {
+        std::size_t jump = std::max<std::size_t>(expansion_trace.StepsCount() / 10, 1);
+        std::size_t step = trace_replay.Step();
+        if (key == GLFW_KEY_COMMA)
+            SeekReplay(step > jump ? step - jump : 0);
+        else
+            SeekReplay(step + jump);
+        if (!trace_replay.IsAtEnd())
+            std::cout << "REPLAY STEP: " << trace_replay.Step() << " / " << expansion_trace.StepsCount() << std::endl;
+    }
+
+    if (key == GLFW_KEY_K && action == GLFW_PRESS)
+    {
+        if (expansion_trace.Width() == 0)
+            std::cout << "NO SEARCH TRACE RECORDED" << std::endl;
+        else if (expansion_trace.Save(expansion_trace_path))
+            std::cout << "SAVED TRACE: " << expansion_trace_path << ", " << expansion_trace.StepsCount() << " STEPS, "
+                      << expansion_trace.StepsBytes() << " BYTES" << std::endl;
+    }
+
+    if (key == GLFW_KEY_S && action == GLFW_PRESS)
+        SaveScene();
+    if (key == GLFW_KEY_O && action == GLFW_PRESS && !(left_click || right_click))
+        LoadScene();
+
+    if (key == GLFW_KEY_M && action == GLFW_PRESS)
+    {
+        map_generator.SetKind(MapGenerator::Kind((map_generator.GetKind() + 1) % MapGenerator::Kinds_Count));
+        std::cout << "MAP GENERATOR: " << MapGenerator::KindName(map_generator.GetKind()) << std::endl;
+    }
+    if (key == GLFW_KEY_G && action == GLFW_PRESS && !(left_click || right_click))
+        GenerateMap();
+
+    if (key == GLFW_KEY_I && action == GLFW_PRESS)
+        is_showing_stats = !is_showing_stats;
+
+    if (key == GLFW_KEY_P && action == GLFW_PRESS)
+    {
+        pacing = SearchPacing((pacing + 1) % Pacing_Modes_Count);
+        PrintPacing();
+    }
+
+    if (key == GLFW_KEY_RIGHT_BRACKET && action == GLFW_PRESS)
+        ScaleBudget(true);
+    if (key == GLFW_KEY_LEFT_BRACKET && action == GLFW_PRESS)
+        ScaleBudget(false);
+
+    bool is_in_background = pacing == Background_Steps || pacing == Instant_Result;
+    if (key == GLFW_KEY_ENTER && action == GLFW_PRESS && is_in_background)
+    {
+        // the live searcher and its cache stay out of it
+        is_replaying = false;
         searcher.Reset();
+        board_renderer.Reset();
+        background_search.SetPlacedLandmarks(landmarks.PlacedCells());
+        if (!background_search.Start(grid, searcher, pacing == Background_Steps))
+            std::cout << "START AND/OR DESTINATION NOT SET" << std::endl;
+    }
+    else if (key == GLFW_KEY_ENTER && action == GLFW_PRESS)
+    {
+        is_replaying = false;
+        background_search.Cancel();
+        board_renderer.Reset();
+        if (searcher.HeuristicKind() == SearchPolicy::Landmarks)
+            landmarks.Update();
+        if (!searcher.StartSearch())
+            std::cout << "START AND/OR DESTINATION NOT SET" << std::endl;
+        else if (!searcher.IsSearching())
+        {
+            // HPA* and cached queries are answered right away
+            if (searcher.PathFound())
+                board_renderer.UpdatePath();
+            PrintSearchResult(searcher.PathFound(), searcher.PathCost(), searcher.ExpandedCount());
+        }
+
+        std::cout << "PATH CACHE: " << path_cache.Hits() << " HITS, " << path_cache.Misses() << " MISSES, "
+                  << path_cache.Evictions() << " EVICTIONS" << std::endl;
+    }
 
-    if (key == GLFW_KEY_ENTER && action == GLFW_PRESS)
-        searcher.StartSearch();
+    if (action == GLFW_PRESS || action == GLFW_REPEAT)
+    {
+        const double pan_step = W_Side / 10.0;
+        const float zoom_step = 1.25f;
+
+        if (key == GLFW_KEY_LEFT)
+            camera.Pan(pan_step, 0.0);
+        else if (key == GLFW_KEY_RIGHT)
+            camera.Pan(-pan_step, 0.0);
+        else if (key == GLFW_KEY_UP)
+            camera.Pan(0.0, -pan_step);
+        else if (key == GLFW_KEY_DOWN)
+            camera.Pan(0.0, pan_step);
+        else if (key == GLFW_KEY_EQUAL)
+            camera.Zoom(zoom_step, W_Side / 2.0, W_Side / 2.0);
+        else if (key == GLFW_KEY_MINUS)
+            camera.Zoom(1.0f / zoom_step, W_Side / 2.0, W_Side / 2.0);
+        else if (key == GLFW_KEY_HOME)
+            camera.Fit(grid.Width(), grid.Height());
+    }
 }
 
 void CursorPositionCallback(GLFWwindow *window, double x_pos, double y_pos)
 {
+    double new_cursor_y = double(W_Side) - y_pos;
+    if (middle_click)
+        camera.Pan(x_pos - cursor_x, new_cursor_y - cursor_y);
+
     cursor_x = x_pos;
-    cursor_y = double(W_Side) - y_pos;
+    cursor_y = new_cursor_y;
 
     if (!is_placing_main_cells && (left_click || right_click))
-    {
-        Cell *cell = grid.FindCellAround(cursor_x, cursor_y);
-
-        if (left_click)
-            grid.PlaceBlockedCell(cell);
-        else
-            grid.RemoveBlockedCell(cell);
-    }
+        EditCell(CellUnderCursor(), false, left_click);
 }
 
 void MouseButtonCallback(GLFWwindow *window, int button, int action, int mods)
 {
+    if (button == GLFW_MOUSE_BUTTON_MIDDLE)
+    {
+        middle_click = action == GLFW_PRESS;
+        return;
+    }
+
     left_click = (button == GLFW_MOUSE_BUTTON_LEFT) && (action == GLFW_PRESS);
     right_click = (button == GLFW_MOUSE_BUTTON_RIGHT) && (action == GLFW_PRESS);
 
     if (left_click || right_click)
     {
-        Cell *cell = grid.FindCellAround(cursor_x, cursor_y);
+        int cell = CellUnderCursor();
 
         if (is_placing_main_cells && !is_searching)
+            EditCell(cell, true, left_click);
+        else if (!is_placing_main_cells)
+            EditCell(cell, false, left_click);
+    }
+}
+
+// runs search steps on this thread until the budget of the frame is used up
+void AdvanceSearch()
+{
+    double end_time = glfwGetTime() + milliseconds_per_frame / 1000.0;
+    int steps = 0;
+    while (searcher.IsSearching())
+    {
+        searcher.SearchStep();
+        board_renderer.AppendStep();
+        steps++;
+
+        if (pacing == Milliseconds_Per_Frame ? glfwGetTime() >= end_time : steps >= steps_per_frame)
+            break;
+    }
+
+    if (searcher.PathFound())
+        board_renderer.UpdatePath();
+    if (!searcher.IsSearching())
+        PrintSearchResult(searcher.PathFound(), searcher.PathCost(), searcher.ExpandedCount());
+}
+
+// draws whatever the worker has published since the last frame
+void PickUpBackgroundSearch()
+{
+    bool is_finished = background_search.TakeBatches(step_batches);
+    for (const BackgroundSearch::StepBatch &batch : step_batches)
+        board_renderer.AppendBatch(batch);
+    step_batches.clear();
+
+    if (!is_finished)
+        return;
+
+    if (background_search.PathFound())
+        board_renderer.UpdatePath(background_search.Path());
+    PrintSearchResult(background_search.PathFound(), background_search.PathCost(), background_search.ExpandedCount());
+}
+
+void ScrollCallback(GLFWwindow *window, double x_offset, double y_offset)
+{
+    camera.Zoom(std::pow(1.1f, float(y_offset)), cursor_x, cursor_y);
+}
+
+// usage: program [--trace <json file>] [--replay <trace file>] [--generate <kind> [--seed n]]
+//                [<map file> | <width> <height>]
+// --trace records the session as Chrome trace events written on exit,
+// --replay loads a search trace with its grid and plays it back. A map
+// given as a grid file is also where S saves the scene. --generate fills
+// the grid with a procedural map, G makes the next one
+bool ParseArguments(int argc, char **argv)
+{
+    std::vector<std::string> args;
+    std::string replay_path;
+    bool is_generating = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--trace" && i + 1 < argc)
+            trace_path = argv[++i];
+        else if (arg == "--replay" && i + 1 < argc)
+            replay_path = argv[++i];
+        else if (arg == "--generate" && i + 1 < argc)
         {
-            if (left_click)
-                grid.SetStartCell(cell);
-            else
-                grid.SetDestinationCell(cell);
+            MapGenerator::Kind kind;
+            if (!MapGenerator::KindFromKey(argv[++i], kind))
+            {
+                std::cout << "ERROR: UNKNOWN MAP KIND: " << argv[i] << std::endl;
+                return false;
+            }
+            map_generator.SetKind(kind);
+            is_generating = true;
         }
-        else if (!is_placing_main_cells)
+        else if (arg == "--seed" && i + 1 < argc)
+            map_generator.SetSeed(std::strtoull(argv[++i], nullptr, 10));
+        else
+            args.push_back(arg);
+    }
+
+    // the generated map would replace the loaded one
+    if (is_generating && (args.size() == 1 || !replay_path.empty()))
+    {
+        std::cout << "ERROR: --generate CANNOT BE USED WITH A MAP OR TRACE FILE" << std::endl;
+        return false;
+    }
+
+    if (!replay_path.empty())
+    {
+        if (!expansion_trace.Load(replay_path))
+            return false;
+        expansion_trace.RestoreGrid(grid);
+        expansion_trace_path = replay_path;
+        is_replaying = true;
+        return true;
+    }
+
+    if (args.size() == 1 && IsGridFile(args[0]))
+        scene_path = args[0];
+    if (args.size() == 1)
+        return LoadMap(args[0], grid);
+
+    if (args.size() == 2)
+    {
+        int width = std::atoi(args[0].c_str());
+        int height = std::atoi(args[1].c_str());
+        if (width < 1 || height < 1 || width > G_Max_Side || height > G_Max_Side)
         {
-            if (left_click)
-                grid.PlaceBlockedCell(cell);
-            else
-                grid.RemoveBlockedCell(cell);
+            std::cout << "ERROR: GRID SIDES MUST BE IN [1, " << G_Max_Side << "]" << std::endl;
+            return false;
         }
+        grid.Resize(width, height);
     }
+
+    if (is_generating)
+        map_generator.Generate(grid);
+    return true;
 }
 
-int main()
+int main(int argc, char **argv)
 {
+    if (!ParseArguments(argc, argv))
+        return 1;
+#ifdef ASTAR_INSTRUMENTATION
+    if (!trace_path.empty())
+        Instrumentation::StartTrace();
+#else
+    if (!trace_path.empty())
+        std::cout << "ERROR: BUILT WITHOUT ASTAR_INSTRUMENTATION, NO TRACE IS RECORDED" << std::endl;
+#endif
+    searcher.SetHierarchy(&hierarchy);
+    searcher.SetPathCache(&path_cache);
+    searcher.SetLandmarks(&landmarks);
+    searcher.SetTrace(&expansion_trace);
+    camera.Fit(grid.Width(), grid.Height());
+
     glfwSetErrorCallback(ErrorCallback);
 
     if (!glfwInit())
@@ -123,17 +747,16 @@ int main()
     glfwSetKeyCallback(window, KeyCallback);
     glfwSetCursorPosCallback(window, CursorPositionCallback);
     glfwSetMouseButtonCallback(window, MouseButtonCallback);
+    glfwSetScrollCallback(window, ScrollCallback);
 
-    ShaderProgram vertical_grid_shader(SHADERS_DIR "/v_grid.vs", SHADERS_DIR "/grid.fs");
-    ShaderProgram horizontal_grid_shader(SHADERS_DIR "/h_grid.vs", SHADERS_DIR "/grid.fs");
-    ShaderProgram main_cells_shader(SHADERS_DIR "/main_cells.vs", SHADERS_DIR "/cells.fs");
-    ShaderProgram cells_shader(SHADERS_DIR "/cells.vs", SHADERS_DIR "/cells.fs");
+    ShaderProgram board_shader(SHADERS_DIR "/board.vs", SHADERS_DIR "/board.fs");
+    ShaderProgram overlay_shader(SHADERS_DIR "/overlay.vs", SHADERS_DIR "/overlay.fs");
 
-    grid.InitializeGrid();
-    grid.InitializeMainCells();
-    grid.InitializeBlockedCells();
-    searcher.InitializePathCells();
-    searcher.InitializeSearchCells();
+    board_renderer.Initialize();
+    hierarchy_renderer.Initialize();
+    stats_overlay.Initialize();
+    if (is_replaying)
+        StartReplay();
 
     const int max_fps_on_still = 25;
     const int max_fps_on_search = 60;
@@ -150,32 +773,46 @@ int main()
 
         if (now_time - last_draw_time >= current_limit)
         {
-            if (is_searching != searcher.IsSearching())
+            if (is_searching != (IsSearchRunning() || IsReplayPlaying()))
             {
-                is_searching = searcher.IsSearching();
+                is_searching = IsSearchRunning() || IsReplayPlaying();
                 current_limit = (int)is_searching * on_search_speed_limit +
                                 (int)(!is_searching) * on_still_speed_limit;
             }
-            searcher.SearchStep();
-
-            glClearColor(0.972f, 0.913f, 0.898f, 1.0f);
-            glClear(GL_COLOR_BUFFER_BIT);
-
-            glUseProgram(cells_shader.ID());
-            searcher.DrawOpenedCells();
-            searcher.DrawClosedCells();
-            searcher.DrawPath();
-            grid.DrawBlockedCells();
-
-            glUseProgram(main_cells_shader.ID());
-            grid.DrawStart();
-            grid.DrawDestination();
-
-            glUseProgram(vertical_grid_shader.ID());
-            grid.DrawSetOfGridLines();
-            glUseProgram(horizontal_grid_shader.ID());
-            grid.DrawSetOfGridLines();
-        
+            stats_overlay.BeginFrame();
+            {
+                ASTAR_SCOPED_TIMER("frame");
+                {
+                    ASTAR_SCOPED_TIMER("search");
+                    if (searcher.IsSearching())
+                        AdvanceSearch();
+                    if (background_search.IsActive())
+                        PickUpBackgroundSearch();
+                    if (IsReplayPlaying())
+                        SeekReplay(trace_replay.Step() + steps_per_frame);
+                }
+
+                ASTAR_SCOPED_TIMER("draw");
+                float view[4];
+                camera.View(view);
+
+                // the board pass covers the whole window, no clear needed
+                glUseProgram(board_shader.ID());
+                board_shader.SetVec4("view", view);
+                board_renderer.Draw(board_shader);
+
+                glUseProgram(overlay_shader.ID());
+                if (is_showing_hierarchy)
+                {
+                    overlay_shader.SetVec4("view", view);
+                    hierarchy_renderer.Draw(overlay_shader);
+                }
+                if (is_showing_stats)
+                    stats_overlay.Draw(overlay_shader);
+            }
+            stats_overlay.EndFrame();
+            Instrumentation::RecordCounters();
+
             glfwSwapBuffers(window);
             
             last_draw_time = now_time;
@@ -184,5 +821,9 @@ int main()
         glfwPollEvents();
     }
 
+    background_search.Cancel();
     glfwTerminate();
+
+    if (!trace_path.empty() && Instrumentation::IsTracing())
+        return Instrumentation::WriteTrace(trace_path) ? 0 : 1;
 }
\ No newline at end of file
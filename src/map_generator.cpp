@@ -0,0 +1,501 @@
+#include "map_generator.h"
+#include "instrumentation.h"
+#include <algorithm>
+#include <utility>
+#include <thread>
+
+enum { Maze_Tile_Side = 64, Room_Sector_Side = 32, Cave_Period = 32, Cave_Octaves = 3 };
+
+static std::uint64_t SplitMix(std::uint64_t value)
+{
+    value += 0x9e3779b97f4a7c15ull;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+// seed of the random stream of a tile, stream 0 joins the tiles
+static std::uint64_t StreamSeed(std::uint64_t seed, std::uint64_t stream)
+{
+    return SplitMix(seed ^ SplitMix(stream));
+}
+
+// the same numbers on every platform, unlike the distributions of <random>
+struct RandomStream
+{
+    std::uint64_t state;
+
+    explicit RandomStream(std::uint64_t seed) : state(seed) {}
+    std::uint64_t Next() { return SplitMix(state++); }
+    // in [0, count), the high bits scaled instead of a division
+    int Below(int count) { return int((Next() >> 32) * std::uint64_t(count) >> 32); }
+};
+
+// runs task(i) for every i in [0, count), item i on thread i % threads_count
+template <typename Task>
+static void ParallelFor(unsigned int threads_count, int count, const Task &task)
+{
+    if (threads_count == 0)
+        threads_count = std::max(1u, std::thread::hardware_concurrency());
+    threads_count = std::min<unsigned int>(threads_count, std::max(count, 1));
+
+    auto run = [&task, count, threads_count](unsigned int first)
+    {
+        for (int i = first; i < count; i += threads_count)
+            task(i);
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < threads_count; t++)
+        threads.emplace_back(run, t);
+    run(0);
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+// random spanning tree of a columns x rows lattice, cell y * columns + x.
+// The backtracker walks on from the newest cell, Prim's grows from a random
+// edge of the whole frontier
+static void SpanningTree(int columns, int rows, bool is_prim, RandomStream &random, std::vector<std::pair<int, int>> &edges)
+{
+    int cells_count = columns * rows;
+    std::vector<unsigned char> visited(cells_count, 0);
+    auto unvisited_neighbours = [&](int cell, int *neighbours)
+    {
+        int x = cell % columns;
+        int y = cell / columns;
+        int count = 0;
+        if (x > 0 && !visited[cell - 1])
+            neighbours[count++] = cell - 1;
+        if (x + 1 < columns && !visited[cell + 1])
+            neighbours[count++] = cell + 1;
+        if (y > 0 && !visited[cell - columns])
+            neighbours[count++] = cell - columns;
+        if (y + 1 < rows && !visited[cell + columns])
+            neighbours[count++] = cell + columns;
+        return count;
+    };
+
+    int neighbours[4];
+    int start = random.Below(cells_count);
+    visited[start] = 1;
+    if (!is_prim)
+    {
+        std::vector<int> stack(1, start);
+        while (!stack.empty())
+        {
+            int cell = stack.back();
+            int count = unvisited_neighbours(cell, neighbours);
+            if (count == 0)
+            {
+                stack.pop_back();
+                continue;
+            }
+            int next = neighbours[random.Below(count)];
+            visited[next] = 1;
+            edges.push_back({cell, next});
+            stack.push_back(next);
+        }
+        return;
+    }
+
+    std::vector<std::pair<int, int>> frontier;
+    int cell = start;
+    while (true)
+    {
+        int count = unvisited_neighbours(cell, neighbours);
+        for (int i = 0; i < count; i++)
+            frontier.push_back({cell, neighbours[i]});
+
+        // edges to cells visited since they were queued are dropped
+        do
+        {
+            if (frontier.empty())
+                return;
+            int picked = random.Below(int(frontier.size()));
+            std::swap(frontier[picked], frontier.back());
+            cell = frontier.back().second;
+            if (!visited[cell])
+                edges.push_back(frontier.back());
+            frontier.pop_back();
+        } while (visited[cell]);
+        visited[cell] = 1;
+    }
+}
+
+const char *MapGenerator::KindName(Kind kind)
+{
+    switch (kind)
+    {
+    case Random:
+        return "RANDOM";
+    case Backtracker_Maze:
+        return "BACKTRACKER MAZE";
+    case Prim_Maze:
+        return "PRIM MAZE";
+    case Rooms:
+        return "ROOMS";
+    case Caves:
+        return "CAVES";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+const char *MapGenerator::KindKey(Kind kind)
+{
+    const char *keys[Kinds_Count] = {"random", "backtracker", "prim", "rooms", "caves"};
+    return kind >= 0 && kind < Kinds_Count ? keys[kind] : "unknown";
+}
+
+bool MapGenerator::KindFromKey(const std::string &key, Kind &kind)
+{
+    for (int i = 0; i < Kinds_Count; i++)
+    {
+        if (key == KindKey(Kind(i)))
+        {
+            kind = Kind(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+MapGenerator::Kind MapGenerator::GetKind() const
+{
+    return kind;
+}
+
+void MapGenerator::SetKind(Kind map_kind)
+{
+    kind = map_kind;
+}
+
+std::uint64_t MapGenerator::Seed() const
+{
+    return seed;
+}
+
+void MapGenerator::SetSeed(std::uint64_t map_seed)
+{
+    seed = map_seed;
+}
+
+double MapGenerator::Density() const
+{
+    return density;
+}
+
+void MapGenerator::SetDensity(double blocked_share)
+{
+    density = std::min(std::max(blocked_share, 0.0), 1.0);
+}
+
+void MapGenerator::SetThreadsCount(unsigned int count)
+{
+    threads_count = count;
+}
+
+void MapGenerator::GenerateRandom(int width, int height, std::vector<std::uint64_t> &blocked_bits) const
+{
+    // every cell hashes its own index, so the words can be filled in any order
+    std::size_t cells_count = std::size_t(width) * height;
+    std::uint64_t threshold = density >= 1.0 ? ~std::uint64_t(0) : std::uint64_t(density * 18446744073709551616.0);
+    std::uint64_t cells_seed = StreamSeed(seed, 0);
+    const int chunk_words = 1024;
+    int chunks_count = int((blocked_bits.size() + chunk_words - 1) / chunk_words);
+    ParallelFor(threads_count, chunks_count, [&](int chunk)
+    {
+        std::size_t end = std::min(blocked_bits.size(), std::size_t(chunk + 1) * chunk_words);
+        for (std::size_t word = std::size_t(chunk) * chunk_words; word < end; word++)
+        {
+            std::uint64_t bits = 0;
+            for (int k = 0; k < 64; k++)
+                bits |= std::uint64_t(SplitMix(cells_seed + word * 64 + k) < threshold) << k;
+            blocked_bits[word] = bits;
+        }
+    });
+
+    if (cells_count & 63)
+        blocked_bits.back() &= (std::uint64_t(1) << (cells_count & 63)) - 1;
+}
+
+void MapGenerator::GenerateMaze(int width, int height, std::vector<unsigned char> &free_cells) const
+{
+    // maze cell (x, y) is grid cell (2x + 1, 2y + 1), the cells between two
+    // of them are their wall
+    int maze_columns = (width - 1) / 2;
+    int maze_rows = (height - 1) / 2;
+    if (maze_columns < 1 || maze_rows < 1)
+    {
+        std::fill(free_cells.begin(), free_cells.end(), 1);
+        return;
+    }
+
+    bool is_prim = kind == Prim_Maze;
+    int tile_columns = (maze_columns + Maze_Tile_Side - 1) / Maze_Tile_Side;
+    int tile_rows = (maze_rows + Maze_Tile_Side - 1) / Maze_Tile_Side;
+    auto carve = [&](int x, int y)
+    {
+        free_cells[std::size_t(y) * width + x] = 1;
+    };
+
+    // tiles only carve inside their own cells, the walls between tiles are left
+    ParallelFor(threads_count, tile_columns * tile_rows, [&](int tile)
+    {
+        int first_x = tile % tile_columns * Maze_Tile_Side;
+        int first_y = tile / tile_columns * Maze_Tile_Side;
+        int columns = std::min(int(Maze_Tile_Side), maze_columns - first_x);
+        int rows = std::min(int(Maze_Tile_Side), maze_rows - first_y);
+
+        RandomStream random(StreamSeed(seed, tile + 1));
+        std::vector<std::pair<int, int>> edges;
+        SpanningTree(columns, rows, is_prim, random, edges);
+        for (int y = 0; y < rows; y++)
+            for (int x = 0; x < columns; x++)
+                carve(2 * (first_x + x) + 1, 2 * (first_y + y) + 1);
+        for (const std::pair<int, int> &edge : edges)
+        {
+            int x = first_x + edge.first % columns + first_x + edge.second % columns;
+            int y = first_y + edge.first / columns + first_y + edge.second / columns;
+            carve(x + 1, y + 1);
+        }
+    });
+
+    // one opening per edge of a spanning tree over the tiles keeps a single path between any two cells
+    RandomStream random(StreamSeed(seed, 0));
+    std::vector<std::pair<int, int>> edges;
+    SpanningTree(tile_columns, tile_rows, is_prim, random, edges);
+    for (const std::pair<int, int> &edge : edges)
+    {
+        int tile = std::min(edge.first, edge.second);
+        int first_x = tile % tile_columns * Maze_Tile_Side;
+        int first_y = tile / tile_columns * Maze_Tile_Side;
+        if (edge.first / tile_columns == edge.second / tile_columns)
+        {
+            int x = first_x + Maze_Tile_Side - 1;
+            int y = first_y + random.Below(std::min(int(Maze_Tile_Side), maze_rows - first_y));
+            carve(2 * x + 2, 2 * y + 1);
+        }
+        else
+        {
+            int x = first_x + random.Below(std::min(int(Maze_Tile_Side), maze_columns - first_x));
+            int y = first_y + Maze_Tile_Side - 1;
+            carve(2 * x + 1, 2 * y + 2);
+        }
+    }
+}
+
+void MapGenerator::GenerateRooms(int width, int height, std::vector<unsigned char> &free_cells) const
+{
+    struct Room
+    {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    int sector_columns = std::max(width / Room_Sector_Side, 1);
+    int sector_rows = std::max(height / Room_Sector_Side, 1);
+    std::vector<Room> rooms(std::size_t(sector_columns) * sector_rows);
+
+    // a room per sector, one cell away from the sector borders when it fits
+    ParallelFor(threads_count, int(rooms.size()), [&](int sector)
+    {
+        int first_x = sector % sector_columns * width / sector_columns;
+        int first_y = sector / sector_columns * height / sector_rows;
+        int sector_width = (sector % sector_columns + 1) * width / sector_columns - first_x;
+        int sector_height = (sector / sector_columns + 1) * height / sector_rows - first_y;
+        int margin_x = sector_width > 2 ? 1 : 0;
+        int margin_y = sector_height > 2 ? 1 : 0;
+        int space_x = sector_width - 2 * margin_x;
+        int space_y = sector_height - 2 * margin_y;
+
+        RandomStream random(StreamSeed(seed, sector + 1));
+        Room room;
+        room.width = std::min(space_x, 4) + random.Below(space_x - std::min(space_x, 4) + 1);
+        room.height = std::min(space_y, 4) + random.Below(space_y - std::min(space_y, 4) + 1);
+        room.x = first_x + margin_x + random.Below(space_x - room.width + 1);
+        room.y = first_y + margin_y + random.Below(space_y - room.height + 1);
+        rooms[sector] = room;
+
+        for (int y = room.y; y < room.y + room.height; y++)
+            std::fill(free_cells.begin() + std::size_t(y) * width + room.x,
+                      free_cells.begin() + std::size_t(y) * width + room.x + room.width, 1);
+    });
+
+    // the spanning tree connects every room, some extra links between
+    // neighbouring sectors add loops
+    RandomStream random(StreamSeed(seed, 0));
+    std::vector<std::pair<int, int>> links;
+    SpanningTree(sector_columns, sector_rows, false, random, links);
+    for (int sector = 0; sector < int(rooms.size()); sector++)
+    {
+        if (sector % sector_columns + 1 < sector_columns && random.Below(5) == 0)
+            links.push_back({sector, sector + 1});
+        if (sector / sector_columns + 1 < sector_rows && random.Below(5) == 0)
+            links.push_back({sector, sector + sector_columns});
+    }
+
+    // corridors run between random cells of the two rooms, bending once
+    for (const std::pair<int, int> &link : links)
+    {
+        const Room &from = rooms[link.first];
+        const Room &to = rooms[link.second];
+        int from_x = from.x + random.Below(from.width);
+        int from_y = from.y + random.Below(from.height);
+        int to_x = to.x + random.Below(to.width);
+        int to_y = to.y + random.Below(to.height);
+        bool is_row_first = random.Below(2) == 0;
+        int row = is_row_first ? from_y : to_y;
+        int column = is_row_first ? to_x : from_x;
+
+        for (int x = std::min(from_x, to_x); x <= std::max(from_x, to_x); x++)
+            free_cells[std::size_t(row) * width + x] = 1;
+        for (int y = std::min(from_y, to_y); y <= std::max(from_y, to_y); y++)
+            free_cells[std::size_t(y) * width + column] = 1;
+    }
+}
+
+void MapGenerator::GenerateCaves(int width, int height, std::vector<unsigned char> &free_cells) const
+{
+    static const float gradients[8][2] = {{1.0f, 0.0f}, {-1.0f, 0.0f}, {0.0f, 1.0f}, {0.0f, -1.0f},
+                                          {0.7071f, 0.7071f}, {-0.7071f, 0.7071f}, {0.7071f, -0.7071f}, {-0.7071f, -0.7071f}};
+    std::uint64_t noise_seed = StreamSeed(seed, 0);
+    auto gradient = [noise_seed](int octave, std::uint64_t i, std::uint64_t j)
+    {
+        return gradients[SplitMix(noise_seed ^ (i << 40) ^ (j << 16) ^ std::uint64_t(octave)) & 7];
+    };
+    auto fade = [](float t)
+    {
+        return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+    };
+
+    // gradient noise of octaves of halving periods, quantized to 16 bits.
+    // Every row only depends on its own index
+    std::vector<std::uint16_t> noise(std::size_t(width) * height);
+    // offsets inside a lattice cell and their fades, the same for every row
+    std::vector<float> offsets[Cave_Octaves];
+    std::vector<float> fades[Cave_Octaves];
+    for (int octave = 0; octave < Cave_Octaves; octave++)
+    {
+        int period = Cave_Period >> octave;
+        for (int x = 0; x < period; x++)
+        {
+            offsets[octave].push_back(float(x) / period);
+            fades[octave].push_back(fade(offsets[octave].back()));
+        }
+    }
+
+    const int band_rows = 16;
+    int bands_count = (height + band_rows - 1) / band_rows;
+    ParallelFor(threads_count, bands_count, [&](int band)
+    {
+        std::vector<float> row_noise(width);
+        for (int y = band * band_rows; y < std::min(height, (band + 1) * band_rows); y++)
+        {
+            std::fill(row_noise.begin(), row_noise.end(), 0.0f);
+            float amplitude = 1.0f;
+            float amplitudes_sum = 0.0f;
+            for (int octave = 0; octave < Cave_Octaves; octave++)
+            {
+                int period = Cave_Period >> octave;
+                const float *u_offsets = offsets[octave].data();
+                const float *u_fades = fades[octave].data();
+                int j = y / period;
+                float v = u_offsets[y % period];
+                float fade_v = u_fades[y % period];
+                for (int i = 0; i * period < width; i++)
+                {
+                    // the corner gradients only change at lattice columns
+                    const float *g00 = gradient(octave, i, j);
+                    const float *g10 = gradient(octave, i + 1, j);
+                    const float *g01 = gradient(octave, i, j + 1);
+                    const float *g11 = gradient(octave, i + 1, j + 1);
+                    float *cells = row_noise.data() + i * period;
+                    int count = std::min(width - i * period, period);
+                    for (int x = 0; x < count; x++)
+                    {
+                        float u = u_offsets[x];
+                        float n00 = g00[0] * u + g00[1] * v;
+                        float n10 = g10[0] * (u - 1.0f) + g10[1] * v;
+                        float n01 = g01[0] * u + g01[1] * (v - 1.0f);
+                        float n11 = g11[0] * (u - 1.0f) + g11[1] * (v - 1.0f);
+                        float top = n00 + (n10 - n00) * u_fades[x];
+                        float bottom = n01 + (n11 - n01) * u_fades[x];
+                        cells[x] += amplitude * (top + (bottom - top) * fade_v);
+                    }
+                }
+                amplitudes_sum += amplitude;
+                amplitude *= 0.5f;
+            }
+
+            // 2D gradient noise stays within [-0.71, 0.71]
+            std::uint16_t *row = noise.data() + std::size_t(y) * width;
+            for (int x = 0; x < width; x++)
+            {
+                float value = row_noise[x] / (amplitudes_sum * 0.7072f) * 0.5f + 0.5f;
+                row[x] = std::uint16_t(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f);
+            }
+        }
+    });
+
+    // the lowest values are blocked, as many as the density asks for
+    std::vector<std::size_t> counts(65536, 0);
+    for (std::uint16_t value : noise)
+        counts[value]++;
+    std::size_t blocked_target = std::size_t(density * noise.size() + 0.5);
+    std::size_t blocked_count = 0;
+    int threshold = 0;
+    while (threshold < 65536 && blocked_count + counts[threshold] <= blocked_target)
+        blocked_count += counts[threshold++];
+
+    ParallelFor(threads_count, bands_count, [&](int band)
+    {
+        std::size_t first = std::size_t(band) * band_rows * width;
+        std::size_t end = std::min(noise.size(), std::size_t(band + 1) * band_rows * width);
+        for (std::size_t cell = first; cell < end; cell++)
+            free_cells[cell] = noise[cell] >= threshold;
+    });
+}
+
+void MapGenerator::Generate(Grid &grid) const
+{
+    ASTAR_SCOPED_TIMER("map_generate");
+    int width = grid.Width();
+    int height = grid.Height();
+    std::size_t cells_count = grid.CellsCount();
+    std::vector<std::uint64_t> blocked_bits((cells_count + 63) / 64, 0);
+
+    if (kind == Random)
+        GenerateRandom(width, height, blocked_bits);
+    else
+    {
+        // the other kinds carve free cells out of a blocked grid, a byte per
+        // cell so tiles never share a word, then pack them
+        std::vector<unsigned char> free_cells(cells_count, 0);
+        if (kind == Backtracker_Maze || kind == Prim_Maze)
+            GenerateMaze(width, height, free_cells);
+        else if (kind == Rooms)
+            GenerateRooms(width, height, free_cells);
+        else
+            GenerateCaves(width, height, free_cells);
+
+        const int chunk_words = 1024;
+        int chunks_count = int((blocked_bits.size() + chunk_words - 1) / chunk_words);
+        ParallelFor(threads_count, chunks_count, [&](int chunk)
+        {
+            std::size_t end = std::min(blocked_bits.size(), std::size_t(chunk + 1) * chunk_words);
+            for (std::size_t word = std::size_t(chunk) * chunk_words; word < end; word++)
+            {
+                std::uint64_t bits = 0;
+                for (std::size_t k = 0; k < 64 && word * 64 + k < cells_count; k++)
+                    bits |= std::uint64_t(!free_cells[word * 64 + k]) << k;
+                blocked_bits[word] = bits;
+            }
+        });
+    }
+
+    grid.Resize(width, height, blocked_bits.data());
+}
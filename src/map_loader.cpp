@@ -0,0 +1,176 @@
+#include "map_loader.h"
+#include "grid_file.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <cstdint>
+
+bool LoadAsciiMap(const std::string &path, Grid &grid)
+{
+    std::ifstream map_file(path);
+    if (!map_file.is_open())
+    {
+        std::cout << "ERROR: FAILED TO OPEN MAP FILE: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> rows;
+    std::string line;
+    while (std::getline(map_file, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (!line.empty())
+            rows.push_back(line);
+    }
+
+    if (rows.empty())
+    {
+        std::cout << "ERROR: MAP FILE IS EMPTY: " << path << std::endl;
+        return false;
+    }
+
+    int width = rows[0].size();
+    int height = rows.size();
+    if (width > G_Max_Side || height > G_Max_Side)
+    {
+        std::cout << "ERROR: MAP IS LARGER THAN " << G_Max_Side << "x" << G_Max_Side << std::endl;
+        return false;
+    }
+
+    // the grid is only resized once the whole map was read, with its occupancy
+    std::size_t cells_count = std::size_t(width) * height;
+    std::vector<std::uint64_t> blocked_bits((cells_count + 63) / 64, 0);
+    std::vector<unsigned char> costs(cells_count, 1);
+    bool has_costs = false;
+    for (int j = 0; j < height; j++)
+    {
+        if (int(rows[j].size()) != width)
+        {
+            std::cout << "ERROR: MAP ROW " << j << " MUST HAVE " << width << " COLUMNS" << std::endl;
+            return false;
+        }
+
+        for (int i = 0; i < width; i++)
+        {
+            char c = rows[j][i];
+            std::size_t cell = std::size_t(j) * width + i;
+            if (c == '#' || c == '@' || c == 'T' || c == 'O')
+                blocked_bits[cell >> 6] |= std::uint64_t(1) << (cell & 63);
+            else if (c >= '1' && c <= '9')
+            {
+                costs[cell] = c - '0';
+                has_costs = true;
+            }
+        }
+    }
+    grid.Resize(width, height, blocked_bits.data());
+    if (has_costs)
+        grid.SetCosts(costs);
+
+    return true;
+}
+
+bool LoadMovingAiMap(const std::string &path, Grid &grid)
+{
+    std::ifstream map_file(path);
+    if (!map_file.is_open())
+    {
+        std::cout << "ERROR: FAILED TO OPEN MAP FILE: " << path << std::endl;
+        return false;
+    }
+
+    int width = 0;
+    int height = 0;
+    std::string key;
+    while (map_file >> key && key != "map")
+    {
+        if (key == "width")
+            map_file >> width;
+        else if (key == "height")
+            map_file >> height;
+        else
+            map_file >> key; // the value of "type"
+    }
+
+    if (key != "map" || width < 1 || height < 1)
+    {
+        std::cout << "ERROR: BAD MOVING AI MAP HEADER: " << path << std::endl;
+        return false;
+    }
+    if (width > G_Max_Side || height > G_Max_Side)
+    {
+        std::cout << "ERROR: MAP IS LARGER THAN " << G_Max_Side << "x" << G_Max_Side << std::endl;
+        return false;
+    }
+
+    std::size_t cells_count = std::size_t(width) * height;
+    std::vector<std::uint64_t> blocked_bits((cells_count + 63) / 64, 0);
+    std::string row;
+    for (int j = 0; j < height; j++)
+    {
+        map_file >> row;
+        if (int(row.size()) != width)
+        {
+            std::cout << "ERROR: MAP ROW " << j << " MUST HAVE " << width << " COLUMNS" << std::endl;
+            return false;
+        }
+
+        for (int i = 0; i < width; i++)
+        {
+            char c = row[i];
+            std::size_t cell = std::size_t(j) * width + i;
+            if (c != '.' && c != 'G' && c != 'S')
+                blocked_bits[cell >> 6] |= std::uint64_t(1) << (cell & 63);
+        }
+    }
+    grid.Resize(width, height, blocked_bits.data());
+
+    return true;
+}
+
+bool LoadMap(const std::string &path, Grid &grid)
+{
+    if (IsGridFile(path))
+        return LoadGridFile(path, grid);
+
+    std::ifstream map_file(path);
+    std::string first_word;
+    if (map_file >> first_word && first_word == "type")
+        return LoadMovingAiMap(path, grid);
+    return LoadAsciiMap(path, grid);
+}
+
+bool LoadMovingAiScenario(const std::string &path, std::vector<Scenario> &scenarios)
+{
+    std::ifstream scenario_file(path);
+    if (!scenario_file.is_open())
+    {
+        std::cout << "ERROR: FAILED TO OPEN SCENARIO FILE: " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(scenario_file, line))
+    {
+        line_number++;
+        if (line.empty() || line == "\r" || line.compare(0, 7, "version") == 0)
+            continue;
+
+        // fields are tab separated, map names can't hold whitespace
+        std::istringstream fields(line);
+        Scenario scenario;
+        if (!(fields >> scenario.bucket >> scenario.map_name >> scenario.map_width >> scenario.map_height
+                     >> scenario.start_column >> scenario.start_row
+                     >> scenario.destination_column >> scenario.destination_row >> scenario.optimal_length))
+        {
+            std::cout << "ERROR: BAD SCENARIO LINE " << line_number << ": " << path << std::endl;
+            return false;
+        }
+        scenarios.push_back(scenario);
+    }
+
+    return true;
+}
@@ -0,0 +1,110 @@
+#include "open_list.h"
+#include <algorithm>
+
+const char *OpenList::KindKey(Kind kind)
+{
+    const char *keys[Kinds_Count] = {"heap", "buckets"};
+    return kind >= 0 && kind < Kinds_Count ? keys[kind] : "unknown";
+}
+
+bool OpenList::KindFromKey(const std::string &key, Kind &kind)
+{
+    for (int i = 0; i < Kinds_Count; i++)
+    {
+        if (key == KindKey(Kind(i)))
+        {
+            kind = Kind(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+OpenList::OpenList(std::size_t queue_capacity, Kind queue_kind)
+{
+    kind = queue_kind;
+    reserve(queue_capacity);
+}
+
+OpenList::Kind OpenList::GetKind() const
+{
+    return kind;
+}
+
+void OpenList::SetKind(Kind queue_kind)
+{
+    clear();
+    kind = queue_kind;
+    reserve(capacity);
+}
+
+void OpenList::reserve(std::size_t queue_capacity)
+{
+    capacity = std::max(capacity, queue_capacity);
+    if (kind == Bucket_Queue)
+        buckets.reserve(capacity);
+    else
+        heap.reserve(capacity);
+}
+
+int OpenList::get()
+{
+    return kind == Bucket_Queue ? buckets.get() : heap.get();
+}
+
+int OpenList::top_cost() const
+{
+    return kind == Bucket_Queue ? buckets.top_cost() : heap.top_cost();
+}
+
+int OpenList::top_d_cost() const
+{
+    return kind == Bucket_Queue ? buckets.top_d_cost() : heap.top_d_cost();
+}
+
+bool OpenList::empty() const
+{
+    return kind == Bucket_Queue ? buckets.empty() : heap.empty();
+}
+
+std::size_t OpenList::size() const
+{
+    return kind == Bucket_Queue ? buckets.size() : heap.size();
+}
+
+bool OpenList::contains(int item) const
+{
+    return kind == Bucket_Queue ? buckets.contains(item) : heap.contains(item);
+}
+
+void OpenList::clear()
+{
+    heap.clear();
+    buckets.clear();
+}
+
+void OpenList::put(int item, int all_cost, int d_cost)
+{
+    if (kind == Bucket_Queue)
+        buckets.put(item, all_cost, d_cost);
+    else
+        heap.put(item, all_cost, d_cost);
+}
+
+void OpenList::remove(int item)
+{
+    if (kind == Bucket_Queue)
+        buckets.remove(item);
+    else
+        heap.remove(item);
+}
+
+IndexedHeap& OpenList::Heap()
+{
+    return heap;
+}
+
+BucketQueue& OpenList::Buckets()
+{
+    return buckets;
+}
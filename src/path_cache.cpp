@@ -0,0 +1,149 @@
+#include "path_cache.h"
+#include <algorithm>
+#include <cstdlib>
+
+PathCache::PathCache(const Grid *cached_grid, std::size_t max_entries)
+{
+    grid = cached_grid;
+    capacity = std::max<std::size_t>(1, max_entries);
+}
+
+std::uint64_t PathCache::Key(int start, int destination)
+{
+    return (std::uint64_t(std::uint32_t(start)) << 32) | std::uint32_t(destination);
+}
+
+bool PathCache::IsValid(const Entry &entry) const
+{
+    if (entry.version == grid->Version())
+        return true;
+    if (!entry.result.found || entry.grid_width != grid->Width())
+        return false;
+
+    // manhattan(start, u) + manhattan(u, destination) splits into a column and
+    // a row part, each smallest over a region at the column/row closest to the
+    // span between start and destination
+    int start_column = grid->Column(entry.start);
+    int start_row = grid->Row(entry.start);
+    int destination_column = grid->Column(entry.destination);
+    int destination_row = grid->Row(entry.destination);
+
+    int reach = int(2LL * entry.result.cost / Grid::Diagonal_Cost);
+    auto least_part = [](int first, int last, int a, int b)
+    {
+        int low = std::min(a, b);
+        int high = std::max(a, b);
+        int gap = std::max(0, std::max(first - high, low - last));
+        return high - low + 2 * gap;
+    };
+
+    for (int j = 0; j < grid->RegionsRows(); j++)
+    {
+        int first_row = j * Grid::Region_Side;
+        int row_part = least_part(first_row, first_row + Grid::Region_Side - 1, start_row, destination_row);
+        if (row_part > reach)
+            continue;
+
+        for (int i = 0; i < grid->RegionsColumns(); i++)
+        {
+            int first_column = i * Grid::Region_Side;
+            int column_part = least_part(first_column, first_column + Grid::Region_Side - 1, start_column, destination_column);
+            if (row_part + column_part <= reach && grid->RegionVersion(i, j) > entry.version)
+                return false;
+        }
+    }
+    return true;
+}
+
+bool PathCache::Find(int start, int destination, Result &result)
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    auto found = index.find(Key(start, destination));
+    if (found == index.end())
+    {
+        misses++;
+        return false;
+    }
+
+    std::list<Entry>::iterator entry = found->second;
+    if (!IsValid(*entry))
+    {
+        entries.erase(entry);
+        index.erase(found);
+        invalidations++;
+        misses++;
+        return false;
+    }
+
+    // still valid now, so it stays valid for the current version
+    entry->version = grid->Version();
+    entries.splice(entries.begin(), entries, entry);
+    result = entry->result;
+    hits++;
+    return true;
+}
+
+void PathCache::Store(int start, int destination, const Result &result)
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    std::uint64_t key = Key(start, destination);
+    auto found = index.find(key);
+    if (found != index.end())
+    {
+        entries.erase(found->second);
+        index.erase(found);
+    }
+    else if (entries.size() == capacity)
+    {
+        index.erase(Key(entries.back().start, entries.back().destination));
+        entries.pop_back();
+        evictions++;
+    }
+
+    entries.push_front({start, destination, grid->Width(), grid->Version(), result});
+    index[key] = entries.begin();
+}
+
+void PathCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    entries.clear();
+    index.clear();
+}
+
+std::size_t PathCache::Size() const
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return entries.size();
+}
+
+std::size_t PathCache::Capacity() const
+{
+    return capacity;
+}
+
+std::size_t PathCache::Hits() const
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return hits;
+}
+
+std::size_t PathCache::Misses() const
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return misses;
+}
+
+std::size_t PathCache::Evictions() const
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return evictions;
+}
+
+std::size_t PathCache::Invalidations() const
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return invalidations;
+}
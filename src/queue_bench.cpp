@@ -0,0 +1,184 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+#include "cost_queue.h"
+#include "indexed_heap.h"
+#include "bucket_queue.h"
+
+// micro-benchmark of the open list: runs the same 8-connected search over an
+// empty side x side field with every queue and reports time per expansion.
+// the CostQueue runs are capped because every expansion re-sorts the whole list
+
+struct CostQueueAdapter
+{
+    CostQueue queue;
+    int side;
+
+    CostQueueAdapter(int field_side) : side(field_side) {}
+
+    bool empty() const { return queue.empty(); }
+    int get()
+    {
+        Cell cell = queue.get();
+        return cell.grid_row * side + cell.grid_column;
+    }
+    void put(int item, int all_cost, int d_cost)
+    {
+        Cell cell;
+        cell.grid_column = item % side;
+        cell.grid_row = item / side;
+        queue.put_unique(cell, all_cost, d_cost);
+    }
+    void expansion_done(bool changed)
+    {
+        if (changed)
+            queue.sort();
+    }
+};
+
+struct IndexedHeapAdapter
+{
+    IndexedHeap queue;
+
+    IndexedHeapAdapter(int field_side) : queue(std::size_t(field_side) * field_side) {}
+
+    bool empty() const { return queue.empty(); }
+    int get() { return queue.get(); }
+    void put(int item, int all_cost, int d_cost) { queue.put(item, all_cost, d_cost); }
+    void expansion_done(bool) {}
+};
+
+struct BucketQueueAdapter
+{
+    BucketQueue queue;
+
+    BucketQueueAdapter(int field_side) : queue(std::size_t(field_side) * field_side) {}
+
+    bool empty() const { return queue.empty(); }
+    int get() { return queue.get(); }
+    void put(int item, int all_cost, int d_cost) { queue.put(item, all_cost, d_cost); }
+    void expansion_done(bool) {}
+};
+
+struct BenchResult
+{
+    std::size_t expanded;
+    double seconds;
+};
+
+// a move costs its length times the cost of the cell it enters, the costs are
+// drawn from [1, max_cost] with the same seed for every queue
+template <typename Queue>
+BenchResult RunSearch(int side, bool use_heuristic, int max_cost, std::size_t max_expansions)
+{
+    std::size_t cells_count = std::size_t(side) * side;
+    std::vector<int> g_cost(cells_count, -1);
+    std::vector<char> closed(cells_count, 0);
+    std::vector<unsigned char> costs(cells_count, 1);
+    std::mt19937 generator(side);
+    std::uniform_int_distribution<int> cost_distribution(1, max_cost);
+    for (unsigned char &cost : costs)
+        cost = cost_distribution(generator);
+    Queue opened(side);
+
+    int start = 0;
+    int destination = (side - 1) * side + (side - 1);
+    auto distance = [side](int a, int b)
+    {
+        return std::abs(a % side - b % side) + std::abs(a / side - b / side);
+    };
+
+    std::size_t expanded = 0;
+    auto begin = std::chrono::steady_clock::now();
+
+    g_cost[start] = 0;
+    opened.put(start, 0, 0);
+    while (!opened.empty() && expanded < max_expansions)
+    {
+        int current = opened.get();
+        if (current == destination)
+            break;
+
+        closed[current] = 1;
+        expanded++;
+
+        int column = current % side;
+        int row = current / side;
+        bool changed = false;
+        for (int dr = -1; dr <= 1; dr++)
+        {
+            for (int dc = -1; dc <= 1; dc++)
+            {
+                int c = column + dc;
+                int r = row + dr;
+                if ((dc == 0 && dr == 0) || c < 0 || c >= side || r < 0 || r >= side)
+                    continue;
+
+                int nei = r * side + c;
+                if (closed[nei])
+                    continue;
+
+                int g = g_cost[current] + (std::abs(dc) + std::abs(dr)) * costs[nei];
+                if (g_cost[nei] == -1 || g < g_cost[nei])
+                {
+                    int h = use_heuristic ? distance(nei, destination) : 0;
+                    g_cost[nei] = g;
+                    opened.put(nei, g + h, h);
+                    changed = true;
+                }
+            }
+        }
+        opened.expansion_done(changed);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    return {expanded, std::chrono::duration<double>(end - begin).count()};
+}
+
+void PrintResult(const char *queue_name, int side, const char *workload, const BenchResult &result)
+{
+    std::cout << std::setw(12) << queue_name
+              << std::setw(6) << side
+              << std::setw(10) << workload
+              << std::setw(12) << result.expanded
+              << std::setw(14) << std::fixed << std::setprecision(1)
+              << (result.expanded > 0 ? result.seconds * 1e9 / result.expanded : 0.0)
+              << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t cost_queue_cap = 20000;
+    if (argc > 1)
+        cost_queue_cap = std::strtoul(argv[1], nullptr, 10);
+
+    const int sides[] = {40, 512, 2048};
+    const std::size_t unlimited = std::size_t(-1);
+
+    std::cout << std::setw(12) << "queue"
+              << std::setw(6) << "side"
+              << std::setw(10) << "workload"
+              << std::setw(12) << "expanded"
+              << std::setw(14) << "ns/expansion" << std::endl;
+
+    for (int side : sides)
+    {
+        // "astar": corner to corner with the Manhattan heuristic,
+        // "flood": zero heuristic, so the open list grows with the frontier,
+        // "terrain": astar over cells costing 1 to 9
+        PrintResult("CostQueue", side, "astar", RunSearch<CostQueueAdapter>(side, true, 1, cost_queue_cap));
+        PrintResult("IndexedHeap", side, "astar", RunSearch<IndexedHeapAdapter>(side, true, 1, unlimited));
+        PrintResult("BucketQueue", side, "astar", RunSearch<BucketQueueAdapter>(side, true, 1, unlimited));
+        PrintResult("CostQueue", side, "flood", RunSearch<CostQueueAdapter>(side, false, 1, cost_queue_cap));
+        PrintResult("IndexedHeap", side, "flood", RunSearch<IndexedHeapAdapter>(side, false, 1, unlimited));
+        PrintResult("BucketQueue", side, "flood", RunSearch<BucketQueueAdapter>(side, false, 1, unlimited));
+        PrintResult("IndexedHeap", side, "terrain", RunSearch<IndexedHeapAdapter>(side, true, 9, unlimited));
+        PrintResult("BucketQueue", side, "terrain", RunSearch<BucketQueueAdapter>(side, true, 9, unlimited));
+    }
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "search_arena.h"
+
+SearchArena::SearchArena(std::size_t cells_count)
+{
+    Resize(cells_count);
+}
+
+void SearchArena::Resize(std::size_t cells_count)
+{
+    nodes.assign(cells_count, {-1, 0, 0, Unvisited});
+    current_generation = 1;
+    opened = OpenList(cells_count, opened.GetKind());
+}
+
+std::size_t SearchArena::Size() const
+{
+    return nodes.size();
+}
+
+void SearchArena::Reset()
+{
+    opened.clear();
+    current_generation++;
+
+    // generation counter wrapped around, old stamps could look valid again
+    if (current_generation == 0)
+    {
+        for (Node &node : nodes)
+            node.generation = 0;
+        current_generation = 1;
+    }
+}
+
+SearchArena::NodeState SearchArena::State(int index) const
+{
+    const Node &node = nodes[index];
+    return node.generation == current_generation ? node.state : Unvisited;
+}
+
+int SearchArena::Parent(int index) const
+{
+    return nodes[index].parent;
+}
+
+int SearchArena::GCost(int index) const
+{
+    return nodes[index].g_cost;
+}
+
+void SearchArena::Open(int index, int parent, int g_cost)
+{
+    nodes[index] = {parent, g_cost, current_generation, Opened};
+}
+
+void SearchArena::Close(int index)
+{
+    nodes[index].state = Closed;
+}
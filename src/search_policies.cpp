@@ -0,0 +1,39 @@
+#include "search_policies.h"
+
+const char *SearchPolicy::HeuristicKey(Heuristic heuristic)
+{
+    const char *keys[Heuristics_Count] = {"manhattan", "octile", "chebyshev", "zero", "alt"};
+    return heuristic >= 0 && heuristic < Heuristics_Count ? keys[heuristic] : "unknown";
+}
+
+bool SearchPolicy::HeuristicFromKey(const std::string &key, Heuristic &heuristic)
+{
+    for (int i = 0; i < Heuristics_Count; i++)
+    {
+        if (key == HeuristicKey(Heuristic(i)))
+        {
+            heuristic = Heuristic(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *SearchPolicy::NeighbourhoodKey(Neighbourhood neighbourhood)
+{
+    const char *keys[Neighbourhoods_Count] = {"4", "8", "strict"};
+    return neighbourhood >= 0 && neighbourhood < Neighbourhoods_Count ? keys[neighbourhood] : "unknown";
+}
+
+bool SearchPolicy::NeighbourhoodFromKey(const std::string &key, Neighbourhood &neighbourhood)
+{
+    for (int i = 0; i < Neighbourhoods_Count; i++)
+    {
+        if (key == NeighbourhoodKey(Neighbourhood(i)))
+        {
+            neighbourhood = Neighbourhood(i);
+            return true;
+        }
+    }
+    return false;
+}
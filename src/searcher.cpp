@@ -1,55 +1,48 @@
-#include <iostream>
-
 #include "searcher.h"
 #include <algorithm>
+#include <climits>
 #include <cmath>
+#include "instrumentation.h"
 
-#include "glad/glad.h"
-
-float *ExtractCoords(const std::vector<Cell> &cells, std::size_t &size)
+const char *Searcher::AlgorithmName(Algorithm algorithm)
 {
-    float *coords = new float[cells.size() * 2];
-    for (std::size_t i = 0; i < cells.size(); i++)
+    switch (algorithm)
     {
-        coords[i * 2] = Normalized(cells[i].center.x);
-        coords[i * 2 + 1] = Normalized(cells[i].center.y);
+    case A_Star:
+        return "A*";
+    case Jump_Point_Search:
+        return "JPS";
+    case Bidirectional_A_Star:
+        return "BIDIRECTIONAL A*";
+    case Hierarchical_A_Star:
+        return "HPA*";
+    case D_Star_Lite:
+        return "D* LITE";
+    default:
+        return "UNKNOWN";
     }
-
-    size = cells.size() * 2 * sizeof(float);
-    return coords;
 }
 
-float *ExtractCoords(const Cell &cell, std::size_t &size)
+const char *Searcher::AlgorithmKey(Algorithm algorithm)
 {
-    float *coords = new float[2] 
-    {
-        Normalized(cell.center.x),
-        Normalized(cell.center.y)
-    };
-
-    size = 2 * sizeof(float);
-    return coords;
+    const char *keys[Algorithms_Count] = {"astar", "jps", "bidirectional", "hpa", "dstar"};
+    return algorithm >= 0 && algorithm < Algorithms_Count ? keys[algorithm] : "unknown";
 }
 
-float *CellsGradient(int cells_count, std::size_t &size, const float colorA[3], const float colorB[3])
+bool Searcher::AlgorithmFromKey(const std::string &key, Algorithm &algorithm)
 {
-    float *colors = new float[cells_count * 3]; 
-
-    float delta;
-    for (int i = 0; i <= cells_count - 1; i++)
+    for (int i = 0; i < Algorithms_Count; i++)
     {
-        delta = (i + 1) / (float)(cells_count + 1);
-
-        colors[i * 3] = (1 - delta) * colorA[0] + delta * colorB[0];
-        colors[i * 3 + 1] = (1 - delta) * colorA[1] + delta * colorB[1];
-        colors[i * 3 + 2] = (1 - delta) * colorA[2] + delta * colorB[2];
+        if (key == AlgorithmKey(Algorithm(i)))
+        {
+            algorithm = Algorithm(i);
+            return true;
+        }
     }
-
-    size = cells_count * 3 * sizeof(float);
-    return colors;
+    return false;
 }
 
-Searcher::Searcher(const Grid *searched_grid)
+Searcher::Searcher(const Grid *searched_grid) : jump_points(searched_grid), planner(searched_grid)
 {
     grid = searched_grid;
 }
@@ -59,187 +52,250 @@ bool Searcher::IsSearching() const
     return is_searching;
 }
 
-void Searcher::InitializeCellsVao(unsigned int& VAO, float *cells_color, std::size_t color_size)
+bool Searcher::PathFound() const
 {
-    std::size_t coords_s;
-    float *coords = grid->NormalizedDefaultCellCoords(coords_s);
-
-    unsigned int indices[] =
-    {
-        0, 1, 2,
-        0, 2, 3
-    };
-    unsigned int EBO;
-    glGenBuffers(1, &EBO);
-
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-
-    unsigned int VBO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, coords_s + color_size, NULL, GL_STATIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, coords_s, coords);
-    glBufferSubData(GL_ARRAY_BUFFER, coords_s, color_size, cells_color);
-
-    delete[] coords;
+    return path_found;
+}
 
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (void*)0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, (void*)coords_s);
-    glVertexAttribDivisor(1, G_Resolution_Side * G_Resolution_Side);
-    glVertexAttribDivisor(2, 1);
+Searcher::Algorithm Searcher::SelectedAlgorithm() const
+{
+    return algorithm;
+}
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+void Searcher::SetAlgorithm(Algorithm searcher_algorithm)
+{
+    algorithm = searcher_algorithm;
+}
 
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+OpenList::Kind Searcher::OpenListKind() const
+{
+    return open_list;
 }
 
-void Searcher::InitializePathCells()
+void Searcher::SetOpenList(OpenList::Kind kind)
 {
-    std::size_t coords_s;
-    float *coords = grid->NormalizedDefaultCellCoords(coords_s);
+    Reset();
+    open_list = kind;
+    for (SearchArena *side : {&arena, &backward_arena, &cluster_arena, &abstract_arena})
+        side->opened.SetKind(kind);
+}
 
-    unsigned int indices[] =
-    {
-        0, 1, 2,
-        0, 2, 3
-    };
-    unsigned int EBO;
-    glGenBuffers(1, &EBO);
+SearchPolicy::Heuristic Searcher::HeuristicKind() const
+{
+    return heuristic;
+}
 
-    glGenVertexArrays(1, &path_vao);
-    glBindVertexArray(path_vao);
+void Searcher::SetHeuristic(SearchPolicy::Heuristic estimate)
+{
+    heuristic = estimate;
+}
 
-    unsigned int VBO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, coords_s, coords, GL_STATIC_DRAW);
+SearchPolicy::Neighbourhood Searcher::NeighbourhoodKind() const
+{
+    return neighbourhood;
+}
 
-    delete[] coords;
+void Searcher::SetNeighbourhood(SearchPolicy::Neighbourhood moves)
+{
+    neighbourhood = moves;
+}
 
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (void*)0);
-    glVertexAttribDivisor(1, 1);
-    glVertexAttribDivisor(2, 1);
+void Searcher::CopySettings(const Searcher &other)
+{
+    algorithm = other.algorithm;
+    heuristic = other.heuristic;
+    neighbourhood = other.neighbourhood;
+    if (open_list != other.open_list)
+        SetOpenList(other.open_list);
+}
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+void Searcher::SetHierarchy(const Hierarchy *grid_hierarchy)
+{
+    hierarchy = grid_hierarchy;
+}
 
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+void Searcher::SetLandmarks(const Landmarks *grid_landmarks)
+{
+    landmarks = grid_landmarks;
 }
 
-void Searcher::InitializeSearchCells()
+void Searcher::SetPathCache(PathCache *cache)
 {
-    InitializeCellsVao(opened_vao, opened_color, sizeof(opened_color));
-    InitializeCellsVao(closed_vao, closed_color, sizeof(closed_color));
+    path_cache = cache;
 }
 
-void Searcher::SetPathVbo(float *data, std::size_t data_size, unsigned int attrib_index, unsigned int components_count)
+void Searcher::SetTrace(ExpansionTrace *expansion_trace)
 {
-    glBindVertexArray(path_vao);
+    trace = expansion_trace;
+}
 
-    unsigned int VBO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, data_size, data, GL_STATIC_DRAW);
-    glVertexAttribPointer(attrib_index, components_count, GL_FLOAT, GL_FALSE, sizeof(float) * components_count, (void*)0); 
+void Searcher::StoreInCache()
+{
+    if (path_cache != nullptr)
+        path_cache->Store(start, destination, {path_found, path_cost, path});
+}
 
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+int Searcher::Heuristic(int cell, int target) const
+{
+    return OctileHeuristic::Estimate(abs(grid->Column(cell) - grid->Column(target)), abs(grid->Row(cell) - grid->Row(target)));
 }
 
-void Searcher::AppendToOffsetsVbo(unsigned int &VAO, unsigned int **VBO, std::size_t &vbo_size, float *data, std::size_t data_size)
+// returns true if the cell got a new or a better g-cost
+bool Searcher::OpenCell(SearchArena &side, int cell, int parent, int g_cost, int target, std::vector<int> &step_list)
 {
-    unsigned int *new_vbo = new unsigned int;
-    glGenBuffers(1, new_vbo);
+    ASTAR_COUNT(Neighbours_Generated, 1);
+    SearchArena::NodeState state = side.State(cell);
+    if (state == SearchArena::Closed || (state == SearchArena::Opened && g_cost >= side.GCost(cell)))
+        return false;
 
-    glBindBuffer(GL_COPY_WRITE_BUFFER, *new_vbo);
-    glBufferData(GL_COPY_WRITE_BUFFER, vbo_size + data_size, NULL, GL_STATIC_DRAW);    
-    glBufferSubData(GL_COPY_WRITE_BUFFER, vbo_size, data_size, data);
-    if (vbo_size > 0)
-    {
-        glBindBuffer(GL_COPY_READ_BUFFER, **VBO);
-        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, vbo_size);    
-        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    int h_cost = Heuristic(cell, target);
+    side.Open(cell, parent, g_cost);
+    side.opened.put(cell, g_cost + h_cost, h_cost);
 
-        glDeleteBuffers(1, *VBO);
-        delete *VBO;
+    if (state == SearchArena::Unvisited)
+    {
+        ASTAR_COUNT(Open_List_Pushes, 1);
+        step_list.push_back(cell);
     }
-    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
-
-    *VBO = new_vbo;
-    vbo_size += data_size;
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, **VBO);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (void*)0);
-    
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-}
-
-int Searcher::Distance(const Cell &a, const Cell &b) const
-{
-    return abs(a.grid_column - b.grid_column) + abs(a.grid_row - b.grid_row);
+    else
+    {
+        ASTAR_COUNT(Decrease_Keys, 1);
+        step_reparented.push_back(cell);
+    }
+    return true;
 }
 
 void Searcher::Reset()
 {
     is_searching = false;
+    path_found = false;
 
     path.resize(0);
-    path_cells_count = 0;
+    path_cost = 0;
+    expanded_count = 0;
 
-    start = nullptr;
-    destination = nullptr;
-    
-    came_from.clear();
-    cost.clear();
+    start = -1;
+    destination = -1;
     
-    opened.clear();
-    closed.resize(0);
+    arena.Reset();
+    backward_arena.Reset();
+    forward_g_order.clear();
+    backward_g_order.clear();
+    meeting_cell = -1;
+    best_meeting_cost = INT_MAX;
+
+    step_opened.resize(0);
+    step_closed.resize(0);
+    step_backward_opened.resize(0);
+    step_backward_closed.resize(0);
+    step_reparented.resize(0);
+}
 
-    if (opened_vbo_size > 0)
+bool Searcher::StartSearch()
+{
+    return StartSearch(grid->Start(), grid->Destination());
+}
+
+void Searcher::Preallocate()
+{
+    if (arena.Size() != grid->CellsCount())
+        arena.Resize(grid->CellsCount());
+
+    if (algorithm == Bidirectional_A_Star && backward_arena.Size() != grid->CellsCount())
     {
-        glDeleteBuffers(1, opened_vbo);
-        delete opened_vbo;
-        opened_vbo_size = 0;
-        opened_cells_count = 0;
+        backward_arena.Resize(grid->CellsCount());
+        forward_g_order = IndexedHeap(grid->CellsCount());
+        backward_g_order = IndexedHeap(grid->CellsCount());
     }
-    if (closed_vbo_size > 0)
+}
+
+bool Searcher::StartSearch(int start_cell, int destination_cell)
+{
+    bool is_started = BeginSearch(start_cell, destination_cell);
+    if (trace != nullptr && is_started)
     {
-        glDeleteBuffers(1, closed_vbo);
-        delete closed_vbo;
-        closed_vbo_size = 0;
-        closed_cells_count = 0;
+        trace->Begin(*grid, start, destination, running_algorithm);
+        // unreachable, cached and HPA* queries are answered without steps
+        if (!is_searching)
+            trace->Finish(path_found, path_cost, path);
     }
+    return is_started;
 }
 
-void Searcher::StartSearch()
+bool Searcher::BeginSearch(int start_cell, int destination_cell)
 {
     Reset();
 
-    start = grid->Start();
-    destination = grid->Destination();
-    if (start == nullptr || destination == nullptr)
+    start = start_cell;
+    destination = destination_cell;
+    if (start == -1 || destination == -1)
+        return false;
+    destination_column = grid->Column(destination);
+    destination_row = grid->Row(destination);
+
+    running_algorithm = algorithm;
+    if (running_algorithm == Jump_Point_Search && !grid->HasUniformCosts())
+        running_algorithm = A_Star;
+    if (running_algorithm == Hierarchical_A_Star && (hierarchy == nullptr || !hierarchy->IsBuilt()))
+        return false;
+    SearchPolicy::Heuristic running_heuristic = heuristic;
+    if (running_heuristic == SearchPolicy::Landmarks && (landmarks == nullptr || !landmarks->IsBuilt()))
+        running_heuristic = SearchPolicy::Octile;
+    a_star_step = AStarStepFor(running_heuristic, neighbourhood, open_list);
+
+    // blocked ends or cells in different areas have no path, nothing to
+    // expand. D* Lite still starts its plan so a later edit can connect them
+    if (running_algorithm != D_Star_Lite && !grid->AreConnected(start, destination))
+        return true;
+
+    // D* Lite has to keep its own plan to repair it later
+    if (path_cache != nullptr && running_algorithm != D_Star_Lite)
     {
-        std::cout << "START AND/OR DESTINATION NOT SET" << std::endl;
-        return;
+        PathCache::Result result;
+        if (path_cache->Find(start, destination, result))
+        {
+            path_found = result.found;
+            path_cost = result.cost;
+            path = std::move(result.path);
+            return true;
+        }
+    }
+
+    if (running_algorithm == Hierarchical_A_Star)
+    {
+        path_found = hierarchy->FindPath(start, destination, cluster_arena, abstract_arena,
+                                         path, path_cost, expanded_count);
+        StoreInCache();
+        return true;
+    }
+
+    if (running_algorithm == D_Star_Lite)
+    {
+        planner.Start(start, destination);
+        is_searching = true;
+        return true;
+    }
+
+    Preallocate();
+
+    arena.Open(start, -1, 0);
+    arena.opened.put(start, 0, 0);
+
+    if (running_algorithm == Bidirectional_A_Star)
+    {
+        backward_arena.Open(destination, -1, 0);
+        backward_arena.opened.put(destination, 0, 0);
+        forward_g_order.put(start, 0, 0);
+        backward_g_order.put(destination, 0, 0);
+        if (start == destination)
+        {
+            meeting_cell = start;
+            best_meeting_cost = 0;
+        }
     }
 
-    opened.put_unique(*start, 0, 0);
-    came_from[*start] = {*start, 0};
     is_searching = true;
+    return true;
 }
 
 void Searcher::SearchStep()
@@ -247,123 +303,392 @@ void Searcher::SearchStep()
     if (!is_searching)
         return;
 
-    bool destination_met = false;
-    if (!opened.empty())
+    step_opened.resize(0);
+    step_closed.resize(0);
+    step_backward_opened.resize(0);
+    step_backward_closed.resize(0);
+    step_reparented.resize(0);
+    TakeStep();
+
+    // repairs of D* Lite resume the search after the trace was finished
+    if (trace == nullptr || !trace->IsRecording())
+        return;
+    if (!step_closed.empty())
+        trace->AppendStep(step_closed[0], false, step_opened, step_reparented);
+    else if (!step_backward_closed.empty())
+        trace->AppendStep(step_backward_closed[0], true, step_backward_opened, step_reparented);
+    else
+        trace->AppendStep(-1, false, step_opened, step_reparented);
+    if (!is_searching)
+        trace->Finish(path_found, path_cost, path);
+}
+
+void Searcher::TakeStep()
+{
+    if (running_algorithm == Bidirectional_A_Star)
+    {
+        BidirectionalStep();
+        return;
+    }
+
+    if (running_algorithm == D_Star_Lite)
+    {
+        int expanded = planner.Step();
+        expanded_count = planner.ExpandedCount();
+        if (expanded != -1)
+        {
+            step_closed.push_back(expanded);
+            return;
+        }
+
+        path_found = planner.PathFound();
+        path_cost = planner.PathCost();
+        path = planner.Path();
+        is_searching = false;
+        return;
+    }
+
+    if (running_algorithm == A_Star)
     {
-        Cell current = opened.get();
+        (this->*a_star_step)();
+        return;
+    }
 
-        if (current == *destination)
+    if (!arena.opened.empty())
+    {
+        int current = arena.opened.get();
+        if (current == destination)
         {
-            destination_met = true;
+            FinishSearch(true);
+            return;
         }
-        else
+
+        arena.Close(current);
+        expanded_count++;
+        ASTAR_COUNT(Nodes_Expanded, 1);
+        JumpPointStep(current);
+        step_closed.push_back(current);
+    }
+
+    if (arena.opened.empty())
+        FinishSearch(false);
+}
+
+void Searcher::FinishSearch(bool is_found)
+{
+    if (is_found)
+        BuildPath();
+    path_found = is_found;
+    is_searching = false;
+    StoreInCache();
+}
+
+// the same as the JPS step with plain expansion, but the heuristic, the
+// moves and the queue are known at compile time and get inlined
+template <class Estimate, class Moves, class Queue>
+void Searcher::AStarStep()
+{
+    auto &opened = Queue::Of(arena.opened);
+    if (!opened.empty())
+    {
+        int current = opened.get();
+        if (current == destination)
         {
-            closed.push_back(current);
-           
-            std::vector<Cell> all_neighbours = grid->ReachableFreeNeighbourCells(current);
-            std::vector<Cell> added_neighbours;
-            bool sort_needed = false;
+            FinishSearch(true);
+            return;
+        }
+
+        arena.Close(current);
+        expanded_count++;
+        ASTAR_COUNT(Nodes_Expanded, 1);
 
-            for (auto cur_nei : all_neighbours)
+        unsigned char moves = Moves::Moves(grid->NeighbourMask(current));
+        int current_g_cost = arena.GCost(current);
+        int column = grid->Column(current);
+        int row = grid->Row(current);
+        for (int d = 0; d < Grid::Directions_Count; d++)
+        {
+            if (!(moves & (1 << d)))
+                continue;
+
+            ASTAR_COUNT(Neighbours_Generated, 1);
+            int nei = current + grid->NeighbourOffset(d);
+            int g_cost = current_g_cost + Moves::StepCost(d) * grid->Cost(nei);
+            SearchArena::NodeState state = arena.State(nei);
+            if (state != SearchArena::Unvisited &&
+                ((state == SearchArena::Closed && !Estimate::Reopens_Closed) || g_cost >= arena.GCost(nei)))
+                continue;
+
+            int h_cost = Estimate::Bound(landmarks, nei, destination, abs(column + Grid::Direction_Columns[d] - destination_column),
+                                         abs(row + Grid::Direction_Rows[d] - destination_row));
+            arena.Open(nei, current, g_cost);
+            opened.put(nei, g_cost + h_cost, h_cost);
+
+            if (state != SearchArena::Opened)
             {
-                if (std::find(closed.begin(), closed.end(), cur_nei) != closed.end())
-                    continue;
-                
-                int g_cost = Distance(current, cur_nei) + came_from[current].second;
-                int h_cost = Distance(*destination, cur_nei);
-                int f_cost = g_cost + h_cost;
-
-                bool is_opened = cost.find(cur_nei) != cost.end();
-                if (!is_opened || f_cost < cost[cur_nei])
-                {
-                    cost[cur_nei] = f_cost;
-                    came_from[cur_nei] = {current, g_cost};
-                    opened.put_unique(cur_nei, f_cost, h_cost);
-
-                    if (!is_opened)
-                        added_neighbours.push_back(cur_nei);
-
-                    sort_needed = true;
-                }
+                ASTAR_COUNT(Open_List_Pushes, 1);
+                step_opened.push_back(nei);
             }
-            if (sort_needed)
-                opened.sort();
-
-            if (added_neighbours.size() > 0)
+            else
             {
-                std::size_t opened_data_s;
-                float *opened_data = ExtractCoords(added_neighbours, opened_data_s);
-                AppendToOffsetsVbo(opened_vao, &opened_vbo, opened_vbo_size, opened_data, opened_data_s);
-                opened_cells_count += added_neighbours.size();
-
-                delete[] opened_data;
+                ASTAR_COUNT(Decrease_Keys, 1);
+                step_reparented.push_back(nei);
             }
-
-            std::size_t closed_data_s;
-            float *closed_data = ExtractCoords(current, closed_data_s);
-            AppendToOffsetsVbo(closed_vao, &closed_vbo, closed_vbo_size, closed_data, closed_data_s);
-            closed_cells_count++;
-            delete[] closed_data;
         }
+
+        step_closed.push_back(current);
     }
 
-    if (destination_met)
+    if (opened.empty())
+        FinishSearch(false);
+}
+
+template <class Estimate, class Moves>
+Searcher::StepFunction Searcher::AStarStepFor(OpenList::Kind kind)
+{
+    if (kind == OpenList::Bucket_Queue)
+        return &Searcher::AStarStep<Estimate, Moves, BucketsQueue>;
+    return &Searcher::AStarStep<Estimate, Moves, HeapQueue>;
+}
+
+template <class Estimate>
+Searcher::StepFunction Searcher::AStarStepFor(SearchPolicy::Neighbourhood moves, OpenList::Kind kind)
+{
+    switch (moves)
     {
-        BuildPath();
-        is_searching = false;
+    case SearchPolicy::Four_Connected:
+        return AStarStepFor<Estimate, FourNeighbours>(kind);
+    case SearchPolicy::No_Corner_Cutting:
+        return AStarStepFor<Estimate, NoCornerCutting>(kind);
+    default:
+        return AStarStepFor<Estimate, EightNeighbours>(kind);
     }
-    else if (opened.empty())
+}
+
+Searcher::StepFunction Searcher::AStarStepFor(SearchPolicy::Heuristic estimate, SearchPolicy::Neighbourhood moves,
+                                              OpenList::Kind kind)
+{
+    switch (estimate)
+    {
+    case SearchPolicy::Manhattan:
+        return AStarStepFor<ManhattanHeuristic>(moves, kind);
+    case SearchPolicy::Chebyshev:
+        return AStarStepFor<ChebyshevHeuristic>(moves, kind);
+    case SearchPolicy::Zero:
+        return AStarStepFor<ZeroHeuristic>(moves, kind);
+    case SearchPolicy::Landmarks:
+        return AStarStepFor<LandmarkHeuristic>(moves, kind);
+    default:
+        return AStarStepFor<OctileHeuristic>(moves, kind);
+    }
+}
+
+void Searcher::JumpPointStep(int current)
+{
+    int parent = arena.Parent(current);
+    int direction = JumpPointSearch::No_Direction;
+    if (parent != -1)
+        direction = JumpPointSearch::DirectionBetween(grid->Column(parent), grid->Row(parent),
+                                                      grid->Column(current), grid->Row(current));
+
+    unsigned char successors = jump_points.Successors(current, direction);
+    int current_g_cost = arena.GCost(current);
+
+    for (int d = 0; d < Grid::Directions_Count; d++)
+    {
+        if (!(successors & (1 << d)))
+            continue;
+
+        int steps;
+        int jump_point = jump_points.Jump(current, d, destination, steps);
+        if (jump_point != -1)
+            OpenCell(arena, jump_point, current, current_g_cost + steps * JumpPointSearch::StepCost(d),
+                     destination, step_opened);
+    }
+}
+
+void Searcher::BidirectionalStep()
+{
+    // the best meeting found so far is optimal once no unexplored path can
+    // be cheaper: with consistent heuristics such a path costs at least the
+    // smallest f-cost queued on either side, and it also has to go through
+    // a queued cell of both sides, so it costs at least the sum of their
+    // smallest g-costs
+    if (arena.opened.empty() || backward_arena.opened.empty() ||
+        best_meeting_cost <= arena.opened.top_cost() ||
+        best_meeting_cost <= backward_arena.opened.top_cost() ||
+        best_meeting_cost <= (long long)forward_g_order.top_cost() + backward_g_order.top_cost())
     {
-        std::cout << "NO PATH FOUND" << std::endl;
+        if (meeting_cell != -1)
+        {
+            BuildBidirectionalPath();
+            path_found = true;
+        }
         is_searching = false;
+        StoreInCache();
+        return;
+    }
+
+    // expand the side with the smaller frontier
+    bool is_forward = arena.opened.size() <= backward_arena.opened.size();
+    SearchArena &side = is_forward ? arena : backward_arena;
+    SearchArena &other_side = is_forward ? backward_arena : arena;
+    IndexedHeap &g_order = is_forward ? forward_g_order : backward_g_order;
+    int target = is_forward ? destination : start;
+    std::vector<int> &opened_list = is_forward ? step_opened : step_backward_opened;
+
+    int current = side.opened.get();
+    g_order.remove(current);
+    side.Close(current);
+    expanded_count++;
+    ASTAR_COUNT(Nodes_Expanded, 1);
+    (is_forward ? step_closed : step_backward_closed).push_back(current);
+
+    // moves are symmetric between free cells, so both sides use the same masks.
+    // Their costs are not: the backward side steps from nei to current and
+    // pays for entering current
+    unsigned char neighbours = grid->NeighbourMask(current);
+    int current_g_cost = side.GCost(current);
+    for (int d = 0; d < Grid::Directions_Count; d++)
+    {
+        if (!(neighbours & (1 << d)))
+            continue;
+
+        int nei = current + grid->NeighbourOffset(d);
+        int g_cost = current_g_cost + JumpPointSearch::StepCost(d) * grid->Cost(is_forward ? nei : current);
+        if (!OpenCell(side, nei, current, g_cost, target, opened_list))
+            continue;
+        g_order.put(nei, g_cost, 0);
+
+        if (other_side.State(nei) != SearchArena::Unvisited && g_cost + other_side.GCost(nei) < best_meeting_cost)
+        {
+            best_meeting_cost = g_cost + other_side.GCost(nei);
+            meeting_cell = nei;
+        }
     }
 }
 
+void Searcher::Search()
+{
+    while (is_searching)
+        SearchStep();
+}
+
+bool Searcher::IsRepairable() const
+{
+    return running_algorithm == D_Star_Lite && start != -1 && planner.IsStarted();
+}
+
+void Searcher::ResumeIncremental()
+{
+    path.resize(0);
+    path_found = false;
+    path_cost = 0;
+    expanded_count = 0;
+    is_searching = true;
+}
+
+bool Searcher::CellChanged(int cell)
+{
+    if (!IsRepairable())
+        return false;
+
+    // the edit blocked one of the ends
+    if (!grid->IsFree(start) || !grid->IsFree(destination))
+    {
+        Reset();
+        return false;
+    }
+
+    planner.CellChanged(cell);
+    ResumeIncremental();
+    return true;
+}
+
+bool Searcher::MoveStart(int start_cell)
+{
+    if (!IsRepairable() || start_cell == -1)
+        return false;
+
+    start = start_cell;
+    planner.MoveStart(start);
+    ResumeIncremental();
+    return true;
+}
+
 void Searcher::BuildPath()
 {
-    Cell step = came_from[*destination].first;
-    while (came_from[step].second != 0)
+    path_cost = arena.GCost(destination);
+
+    // parents are not always adjacent (JPS links jump points), but every
+    // link is a straight or diagonal line, so the cells between are filled in
+    int step = destination;
+    while (step != start)
     {
-        path.push_back(step);
-        step = came_from[step].first;
+        int parent = arena.Parent(step);
+        int direction = JumpPointSearch::DirectionBetween(grid->Column(step), grid->Row(step),
+                                                          grid->Column(parent), grid->Row(parent));
+        for (int cell = step + grid->NeighbourOffset(direction); cell != parent; cell += grid->NeighbourOffset(direction))
+            path.push_back(cell);
+        if (parent != start)
+            path.push_back(parent);
+        step = parent;
     }
-    path_cells_count = path.size();
 
     // path is in reversed order right now (destination -> start)
     // so reversing it would be nice
     std::reverse(path.begin(), path.end());
+}
 
-    // passing path colors to new vbo
-    std::size_t colors_s;
-    float *colors = CellsGradient(path_cells_count, colors_s, grid->StartColor(), grid->DestinationColor());    
-    SetPathVbo(colors, colors_s, 1, 3);
+void Searcher::BuildBidirectionalPath()
+{
+    path_cost = best_meeting_cost;
+
+    // start -> meeting cell from the forward parents,
+    // meeting cell -> destination from the backward ones
+    std::vector<int> cells;
+    for (int cell = meeting_cell; cell != -1; cell = arena.Parent(cell))
+        cells.push_back(cell);
+    std::reverse(cells.begin(), cells.end());
+    for (int cell = backward_arena.Parent(meeting_cell); cell != -1; cell = backward_arena.Parent(cell))
+        cells.push_back(cell);
+
+    // start and destination are not part of the path
+    if (cells.size() > 2)
+        path.assign(cells.begin() + 1, cells.end() - 1);
+}
 
-    // passing path coords to new vbo
-    std::size_t coords_s;
-    float *coords = ExtractCoords(path, coords_s);
-    SetPathVbo(coords, coords_s, 2, 2);
+const std::vector<int>& Searcher::Path() const
+{
+    return path;
+}
 
-    delete[] colors;
-    delete[] coords;
+int Searcher::PathCost() const
+{
+    return path_cost;
 }
 
-void Searcher::DrawPath() const
+std::size_t Searcher::ExpandedCount() const
 {
-    glBindVertexArray(path_vao);
-    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, path_cells_count);
-    glBindVertexArray(0);
+    return expanded_count;
 }
 
-void Searcher::DrawClosedCells() const
+const std::vector<int>& Searcher::StepOpened() const
 {
-    glBindVertexArray(closed_vao);
-    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, closed_cells_count);
-    glBindVertexArray(0);
+    return step_opened;
 }
 
-void Searcher::DrawOpenedCells() const
+const std::vector<int>& Searcher::StepClosed() const
 {
-    glBindVertexArray(opened_vao);
-    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, opened_cells_count);
-    glBindVertexArray(0);
-}
\ No newline at end of file
+    return step_closed;
+}
+
+const std::vector<int>& Searcher::StepBackwardOpened() const
+{
+    return step_backward_opened;
+}
+
+const std::vector<int>& Searcher::StepBackwardClosed() const
+{
+    return step_backward_closed;
+}
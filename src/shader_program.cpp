@@ -79,4 +79,29 @@ unsigned int ShaderProgram::CompileShader(GLuint type, const char *source)
 unsigned int ShaderProgram::ID() const
 {
     return program;
-}
\ No newline at end of file
+}
+
+void ShaderProgram::SetInt(const char *name, int value) const
+{
+    glUniform1i(glGetUniformLocation(program, name), value);
+}
+
+void ShaderProgram::SetFloat(const char *name, float value) const
+{
+    glUniform1f(glGetUniformLocation(program, name), value);
+}
+
+void ShaderProgram::SetVec2(const char *name, float x, float y) const
+{
+    glUniform2f(glGetUniformLocation(program, name), x, y);
+}
+
+void ShaderProgram::SetVec4(const char *name, const float *value) const
+{
+    glUniform4fv(glGetUniformLocation(program, name), 1, value);
+}
+
+void ShaderProgram::SetVec3Array(const char *name, const float *values, int count) const
+{
+    glUniform3fv(glGetUniformLocation(program, name), count, values);
+}
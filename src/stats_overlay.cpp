@@ -0,0 +1,204 @@
+#include "stats_overlay.h"
+#include <sstream>
+#include <iomanip>
+#include <cctype>
+#include <algorithm>
+
+#include "glad/glad.h"
+#include "constants.h"
+
+// rows of 3 bits from the top, the leftmost pixel in the highest bit
+const unsigned short Digit_Glyphs[10] =
+{
+    0x7b6f, 0x2c97, 0x73e7, 0x73cf, 0x5bc9, 0x79cf, 0x79ef, 0x7249, 0x7bef, 0x7bcf
+};
+const unsigned short Letter_Glyphs[26] =
+{
+    0x2bed, 0x6bae, 0x3923, 0x6b6e, 0x79a7, 0x79a4, 0x396b, 0x5bed, 0x7497, 0x126a, 0x5bad, 0x4927, 0x5fed,
+    0x6b6d, 0x2b6a, 0x6ba4, 0x2b73, 0x6bad, 0x388e, 0x7492, 0x5b6f, 0x5b6a, 0x5bfd, 0x5aad, 0x5a92, 0x72a7
+};
+
+unsigned short Glyph(char c)
+{
+    if (c >= '0' && c <= '9')
+        return Digit_Glyphs[c - '0'];
+    if (c >= 'A' && c <= 'Z')
+        return Letter_Glyphs[c - 'A'];
+
+    switch (c)
+    {
+    case '.':
+        return 0x0002;
+    case ':':
+        return 0x0410;
+    case '/':
+        return 0x12a4;
+    case '-':
+        return 0x01c0;
+    case '+':
+        return 0x05d0;
+    case '%':
+        return 0x52a5;
+    default:
+        return 0;
+    }
+}
+
+void AppendQuad(std::vector<float> &vertices, float x, float y, float width, float height)
+{
+    vertices.insert(vertices.end(),
+    {
+        x, y,  x + width, y,  x + width, y + height,
+        x, y,  x + width, y + height,  x, y + height
+    });
+}
+
+void StatsOverlay::Initialize()
+{
+    glGenVertexArrays(1, &text_vao);
+    glBindVertexArray(text_vao);
+
+    glGenBuffers(1, &text_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, text_vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (void*)0);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glGenQueries(2, gpu_queries);
+    Instrumentation::ReadCounters(last_counters);
+    last_update_us = Instrumentation::NowMicroseconds();
+    BuildText({"MEASURING"});
+}
+
+void StatsOverlay::ReadGpuQuery(int index)
+{
+    if (!is_query_pending[index])
+        return;
+
+    int is_available = 0;
+    glGetQueryObjectiv(gpu_queries[index], GL_QUERY_RESULT_AVAILABLE, &is_available);
+    if (!is_available)
+        return;
+
+    GLuint64 nanoseconds;
+    glGetQueryObjectui64v(gpu_queries[index], GL_QUERY_RESULT, &nanoseconds);
+    gpu_us_sum += nanoseconds / 1000.0;
+    gpu_frames++;
+    is_query_pending[index] = false;
+}
+
+void StatsOverlay::BeginFrame()
+{
+    frame_begin_us = Instrumentation::NowMicroseconds();
+
+    // the query is only reused once its result is in
+    ReadGpuQuery(query_index);
+    if (!is_query_pending[query_index])
+        glBeginQuery(GL_TIME_ELAPSED, gpu_queries[query_index]);
+}
+
+void StatsOverlay::EndFrame()
+{
+    if (!is_query_pending[query_index])
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        is_query_pending[query_index] = true;
+    }
+    query_index = 1 - query_index;
+
+    std::uint64_t now_us = Instrumentation::NowMicroseconds();
+    cpu_us_sum += double(now_us - frame_begin_us);
+    cpu_frames++;
+
+    if (now_us - last_update_us >= update_interval_us)
+        UpdateText(now_us);
+}
+
+void StatsOverlay::UpdateText(std::uint64_t now_us)
+{
+    std::uint64_t counters[Instrumentation::Counters_Count];
+    Instrumentation::ReadCounters(counters);
+
+    std::vector<std::string> lines;
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(2) << "CPU " << (cpu_frames > 0 ? cpu_us_sum / cpu_frames / 1000.0 : 0.0)
+         << " MS  GPU " << (gpu_frames > 0 ? gpu_us_sum / gpu_frames / 1000.0 : 0.0) << " MS";
+    lines.push_back(line.str());
+
+#ifdef ASTAR_INSTRUMENTATION
+    double seconds = (now_us - last_update_us) / 1e6;
+    for (int i = 0; i < Instrumentation::Counters_Count; i++)
+    {
+        std::string name = Instrumentation::CounterName(Instrumentation::Counter(i));
+        std::transform(name.begin(), name.end(), name.begin(), [](char c) { return c == '_' ? ' ' : char(std::toupper(c)); });
+
+        line.str("");
+        line << std::setprecision(0) << name << " " << counters[i]
+             << "  +" << (counters[i] - last_counters[i]) / seconds << "/S";
+        lines.push_back(line.str());
+    }
+#else
+    lines.push_back("COUNTERS COMPILED OUT");
+#endif
+
+    BuildText(lines);
+
+    std::copy(counters, counters + Instrumentation::Counters_Count, last_counters);
+    last_update_us = now_us;
+    cpu_us_sum = gpu_us_sum = 0.0;
+    cpu_frames = gpu_frames = 0;
+}
+
+void StatsOverlay::BuildText(const std::vector<std::string> &lines)
+{
+    // window pixels from the top left corner, one quad per lit font pixel
+    const float pixel = Font_Scale;
+    const float advance = (Glyph_Width + 1) * pixel;
+    const float line_height = (Glyph_Height + 2) * pixel;
+
+    std::size_t longest = 0;
+    for (const std::string &text : lines)
+        longest = std::max(longest, text.size());
+
+    std::vector<float> vertices;
+    AppendQuad(vertices, Margin / 2.0f, Margin / 2.0f, longest * advance + Margin, lines.size() * line_height + Margin);
+    panel_vertices_count = vertices.size() / 2;
+
+    for (std::size_t l = 0; l < lines.size(); l++)
+    {
+        for (std::size_t i = 0; i < lines[l].size(); i++)
+        {
+            unsigned short glyph = Glyph(lines[l][i]);
+            for (int bit = 0; bit < Glyph_Width * Glyph_Height; bit++)
+            {
+                if (!(glyph & (1 << (Glyph_Width * Glyph_Height - 1 - bit))))
+                    continue;
+                float x = Margin + i * advance + (bit % Glyph_Width) * pixel;
+                float y = Margin + l * line_height + (bit / Glyph_Width) * pixel;
+                AppendQuad(vertices, x, y, pixel, pixel);
+            }
+        }
+    }
+    text_vertices_count = vertices.size() / 2 - panel_vertices_count;
+
+    glBindBuffer(GL_ARRAY_BUFFER, text_vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    ASTAR_COUNT(Gl_Bytes_Uploaded, vertices.size() * sizeof(float));
+}
+
+void StatsOverlay::Draw(const ShaderProgram &shader) const
+{
+    // window pixels with y going down to clip space
+    float view[4] = {2.0f / W_Side, -2.0f / W_Side, -1.0f, 1.0f};
+    shader.SetVec4("view", view);
+
+    glBindVertexArray(text_vao);
+    shader.SetVec4("line_color", panel_color);
+    glDrawArrays(GL_TRIANGLES, 0, panel_vertices_count);
+    shader.SetVec4("line_color", text_color);
+    glDrawArrays(GL_TRIANGLES, panel_vertices_count, text_vertices_count);
+    glBindVertexArray(0);
+}
@@ -0,0 +1,92 @@
+#include "trace_replay.h"
+#include "instrumentation.h"
+
+TraceReplay::TraceReplay(const ExpansionTrace *replayed_trace)
+{
+    trace = replayed_trace;
+}
+
+void TraceReplay::SetState(int cell, unsigned char state)
+{
+    if (states[cell] >= state)
+        return;
+    states[cell] = state;
+    if (!was_rebuilt)
+        changed_cells.push_back(cell);
+}
+
+void TraceReplay::Rewind()
+{
+    std::size_t cells_count = std::size_t(trace->Width()) * trace->Height();
+    states.assign(cells_count, Unvisited);
+    parents.assign(cells_count, -1);
+    changed_cells.clear();
+    was_rebuilt = true;
+
+    step = 0;
+    offset = 0;
+    previous_expanded = trace->Start();
+    last_expanded = -1;
+}
+
+void TraceReplay::Seek(std::size_t step_index)
+{
+    ASTAR_SCOPED_TIMER("trace_seek");
+    changed_cells.clear();
+    was_rebuilt = false;
+    if (step_index < step || states.size() != std::size_t(trace->Width()) * trace->Height())
+        Rewind();
+
+    while (step < step_index && trace->DecodeStep(offset, previous_expanded, decoded))
+    {
+        step++;
+        last_expanded = decoded.expanded;
+        if (decoded.expanded == -1)
+            continue;
+
+        unsigned char opened_state = decoded.is_backward ? Backward_Opened : Opened;
+        for (int cell : decoded.opened)
+        {
+            parents[cell] = decoded.expanded;
+            SetState(cell, opened_state);
+        }
+        for (int cell : decoded.reparented)
+            parents[cell] = decoded.expanded;
+        SetState(decoded.expanded, decoded.is_backward ? Backward_Closed : Closed);
+    }
+}
+
+std::size_t TraceReplay::Step() const
+{
+    return step;
+}
+
+bool TraceReplay::IsAtEnd() const
+{
+    return step >= trace->StepsCount();
+}
+
+const std::vector<unsigned char>& TraceReplay::States() const
+{
+    return states;
+}
+
+int TraceReplay::Parent(int cell) const
+{
+    return parents[cell];
+}
+
+int TraceReplay::LastExpanded() const
+{
+    return last_expanded;
+}
+
+bool TraceReplay::WasRebuilt() const
+{
+    return was_rebuilt;
+}
+
+const std::vector<int>& TraceReplay::ChangedCells() const
+{
+    return changed_cells;
+}
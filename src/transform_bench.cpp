@@ -0,0 +1,155 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+#include "grid.h"
+#include "distance_transform.h"
+
+// checks every clearance transform kernel against Dijkstra's algorithm on
+// small random grids, then times them and Dijkstra on side x side grids
+// (1024 and 4096 by default) with a quarter of the cells blocked
+
+// Dial's algorithm from all sources at once, stepping through any cell
+std::vector<int> DijkstraDistances(const Grid &grid, const std::vector<int> &sources)
+{
+    std::vector<int> distances(grid.CellsCount(), DistanceTransform::Infinity);
+    std::vector<std::vector<int>> buckets(Grid::Diagonal_Cost + 1);
+    std::size_t queued = 0;
+    for (int source : sources)
+    {
+        distances[source] = 0;
+        buckets[0].push_back(source);
+        queued++;
+    }
+
+    for (int distance = 0; queued > 0; distance++)
+    {
+        std::vector<int> &bucket = buckets[distance % buckets.size()];
+        for (std::size_t b = 0; b < bucket.size(); b++)
+        {
+            int current = bucket[b];
+            if (distances[current] != distance)
+                continue;
+
+            for (int d = 0; d < Grid::Directions_Count; d++)
+            {
+                int column = grid.Column(current) + Grid::Direction_Columns[d];
+                int row = grid.Row(current) + Grid::Direction_Rows[d];
+                if (!grid.Contains(column, row))
+                    continue;
+
+                int next = grid.Index(column, row);
+                int next_distance = distance + (Grid::Direction_Columns[d] && Grid::Direction_Rows[d] ? Grid::Diagonal_Cost : Grid::Straight_Cost);
+                if (next_distance < distances[next])
+                {
+                    distances[next] = next_distance;
+                    buckets[next_distance % buckets.size()].push_back(next);
+                    queued++;
+                }
+            }
+        }
+        queued -= bucket.size();
+        bucket.clear();
+    }
+    return distances;
+}
+
+std::vector<int> BlockedCells(const Grid &grid)
+{
+    std::vector<int> cells;
+    for (std::size_t cell = 0; cell < grid.CellsCount(); cell++)
+        if (!grid.IsFree(cell))
+            cells.push_back(cell);
+    return cells;
+}
+
+void FillRandomly(Grid &grid, double blocked_share, std::mt19937 &generator)
+{
+    std::bernoulli_distribution is_blocked(blocked_share);
+    std::vector<unsigned char> occupancy(grid.CellsCount());
+    for (unsigned char &cell : occupancy)
+        cell = is_blocked(generator);
+    grid.SetOccupancy(occupancy);
+}
+
+double Milliseconds(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void Benchmark(int side, std::mt19937 &generator)
+{
+    Grid grid(side, side);
+    FillRandomly(grid, 0.25, generator);
+    std::cout << std::endl << side << "x" << side << ", 25% blocked" << std::endl;
+    std::cout << std::setw(10) << "method" << std::setw(16) << "clearance_ms" << std::endl;
+
+    auto begin = std::chrono::steady_clock::now();
+    DijkstraDistances(grid, BlockedCells(grid));
+    std::cout << std::setw(10) << "dijkstra" << std::fixed << std::setprecision(1) << std::setw(16)
+              << Milliseconds(begin) << std::endl;
+
+    for (int k = 0; k < DistanceTransform::Kernels_Count; k++)
+    {
+        DistanceTransform::Kernel kernel = DistanceTransform::Kernel(k);
+        if (!DistanceTransform::IsSupported(kernel))
+            continue;
+
+        DistanceTransform transform(&grid);
+        transform.SetKernel(kernel);
+        begin = std::chrono::steady_clock::now();
+        transform.Clearance();
+        std::cout << std::setw(10) << DistanceTransform::KernelKey(kernel) << std::setw(16) << Milliseconds(begin) << std::endl;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<int> sides = {1024, 4096};
+    if (argc > 1)
+        sides = {std::atoi(argv[1])};
+
+    // odd sizes leave tails behind the vector blocks, the shares go from open to mostly blocked
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<int> sizes(1, 97);
+    const double shares[] = {0.0, 0.05, 0.25, 0.45, 0.7};
+    const int grids_count = 200;
+
+    std::vector<Grid> grids;
+    for (int i = 0; i < grids_count; i++)
+    {
+        grids.emplace_back(sizes(generator), sizes(generator));
+        FillRandomly(grids.back(), shares[i % 5], generator);
+    }
+
+    std::cout << std::setw(8) << "kernel" << std::setw(8) << "grids" << std::setw(12) << "mismatches" << std::endl;
+    for (int k = 0; k < DistanceTransform::Kernels_Count; k++)
+    {
+        DistanceTransform::Kernel kernel = DistanceTransform::Kernel(k);
+        if (!DistanceTransform::IsSupported(kernel))
+        {
+            std::cout << std::setw(8) << DistanceTransform::KernelKey(kernel) << "  not supported by this cpu" << std::endl;
+            continue;
+        }
+
+        std::size_t mismatches = 0;
+        for (int i = 0; i < grids_count; i++)
+        {
+            DistanceTransform transform(&grids[i]);
+            transform.SetKernel(kernel);
+            transform.Clearance();
+            if (transform.Distances() != DijkstraDistances(grids[i], BlockedCells(grids[i])))
+                mismatches++;
+        }
+        std::cout << std::setw(8) << DistanceTransform::KernelKey(kernel) << std::setw(8) << grids_count
+                  << std::setw(12) << mismatches << std::endl;
+    }
+
+    for (int side : sides)
+        Benchmark(side, generator);
+
+    return 0;
+}